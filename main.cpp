@@ -3,6 +3,50 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <string_view>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <climits>
+#include <bitset>
+#include <functional>
+#include <cctype>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <csignal>
+#include <charconv>
+#include <random>
+#include <memory_resource>
+#include <deque>
+#include <array>
+#include <queue>
+#include <set>
+#include <unordered_map>
+#include <cmath>
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+#if defined(__LINUX__) || defined(__APPLE__) || defined(__gnu_linux__) || defined(__linux__)
+    #define UNIX_LIKE
+    #include <sys/ioctl.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <cerrno>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <sys/wait.h>
+#endif
 
 using namespace std;
 
@@ -10,14 +54,552 @@ namespace seatrs {
     struct Seat { 
         string name, description;
         bool isReserved = false;
+        bool isHeld = false;            // reserved only until the hold is confirmed or released
+    };
+
+    /**
+     * A named group of whole rows, such as the orchestra or the balcony, with its
+     * seats rolled up. The occupied count includes the held seats.
+     */
+    struct Section {
+        string name;
+        int firstRow = 0, lastRow = 0;
+        int seats = 0, occupied = 0, held = 0;
     };
 
     namespace data {
         int totalOccupiedSeats = 0;
+        int totalSeats = 100;           // the seats that exist, leaving out the gaps of the venue
         Seat** seats;
+        Seat* seatBlock = nullptr;      // every seat, in one allocation that seats points into
 
         int totalRows = 10;
         int totalColumns = 10;
+
+        // Reserved seats, 1 bit per seat, with each row padded to whole words
+        vector<uint64_t> occupancy;
+        int wordsPerRow = 1;
+
+        // Seats that exist, laid out like occupancy. Aisles, pillars and other gaps in
+        // the venue are 0, so only the seats of non-rectangular venues are booked.
+        vector<uint64_t> validity;
+
+        // Seat attributes, stored as columns parallel to the grid (irow * totalColumns + icol)
+        vector<uint8_t> tiers;      // 0 for no tier, 1 for tier A, 2 for tier B, ...
+        vector<int32_t> prices;
+        vector<uint8_t> features;   // SeatFeature flags
+
+        // Occupied seats per row and column, and the first and last free seat of each (-1 if full)
+        vector<int> rowOccupied, columnOccupied;
+        vector<int> rowSeats, rowHeld;      // seats that exist and held seats, per row
+        int totalHeld = 0;
+        vector<int> rowFirstFree, rowLastFree;
+        vector<int> columnFirstFree, columnLastFree;
+
+        // A 2D Fenwick tree of free seats, (totalRows + 1) x (totalColumns + 1) and
+        // counted from 1, so any rectangle can be counted in O(log rows * log columns)
+        vector<int32_t> freeIndex;
+
+        // The seats taken or freed since freeIndex was last brought up to date, as the
+        // seat's index plus one, negated for a seat taken. When there are too many to
+        // be worth adding one by one, they are dropped and freeIndex is rebuilt instead.
+        vector<int64_t> freeIndexPending;
+        bool freeIndexStale = false;
+
+        // The sections, in row order and not overlapping, and the section of each row (-1 for none)
+        vector<Section> sections;
+        vector<int> rowSection;
+    }
+
+    enum SeatFeature {
+        AISLE = 1,
+        ACCESSIBLE = 2
+    };
+
+    enum ChangeKind {
+        RESERVE = 1,
+        UPDATE,
+        CANCEL,
+        RESIZE,
+        ATTRIBUTES,
+        SHAPE,
+        HOLD,
+        SECTIONS
+    };
+
+    /**
+     * A committed change to the seat layout. RESIZE uses row and column for the new
+     * size, ATTRIBUTES uses row, column, lastRow and lastColumn for the rectangle,
+     * SHAPE has the venue map in name, as written by describeShape(), and SECTIONS
+     * has the sections in name, as written by describeSections().
+     */
+    struct Change {
+        ChangeKind kind;
+        int row = 0, column = 0;
+        int lastRow = 0, lastColumn = 0;
+        int tier = 0, price = 0, features = 0;
+        string name, description;
+    };
+
+    // Called after every committed change, in the order the changes were made
+    vector<function<void(const Change&)>> changeListeners;
+
+    // Called before a free seat is reserved, to claim it in a store shared with other
+    // processes. reserveSeat() fails with ALREADY_RESERVED if the claim is refused.
+    function<bool(int, int)> claimSeat;
+
+    // Called to give back a seat taken by claimSeat() when a batch of reservations is
+    // abandoned before any of it was made
+    function<void(int, int)> unclaimSeat;
+
+    // Called before a reserved seat is updated or cancelled, to write the change to a
+    // store shared with other processes. updateSeat() and cancelSeat() fail with
+    // CONFLICT if the write is refused because the seat changed there.
+    function<bool(const Change&)> commitSeat;
+
+    /**
+     * Passes a committed change to every change listener. Changes made by a listener
+     * are queued and passed on once every listener has seen the current change, so
+     * all listeners see the changes in the same order.
+     */
+    void notifyChange(const Change& change) {
+        static vector<Change> pending;
+        static bool notifying = false;
+
+        pending.push_back(change);
+        if (notifying) return;
+
+        notifying = true;
+        for (size_t i = 0; i < pending.size(); i++) {
+            Change current = pending[i];
+            for (const function<void(const Change&)>& listener : changeListeners) {
+                listener(current);
+            }
+        }
+        pending.clear();
+        notifying = false;
+    }
+
+    /**
+     * Copies a column of seat attributes into a grid of a new size, keeping the
+     * values of the seats present in both.
+     */
+    template <typename T>
+    vector<T> resizeColumn(const vector<T>& old, int rows, int columns) {
+        vector<T> resized((size_t) rows * columns, T());
+
+        if (!old.empty()) {
+            for (int iRow = 0; iRow < min(rows, data::totalRows); iRow++) {
+                for (int iColumn = 0; iColumn < min(columns, data::totalColumns); iColumn++) {
+                    resized[(size_t) iRow * columns + iColumn] = old[(size_t) iRow * data::totalColumns + iColumn];
+                }
+            }
+        }
+
+        return resized;
+    }
+
+    /**
+     * Gets the position of the lowest set bit of a word, which must not be 0.
+     */
+    int lowestBit(uint64_t word) {
+        #if defined(__GNUC__)
+            return __builtin_ctzll(word);
+        #else
+            int position = 0;
+            while (!(word & 1)) { word >>= 1; position++; }
+            return position;
+        #endif
+    }
+
+    /**
+     * Gets the position of the highest set bit of a word, which must not be 0.
+     */
+    int highestBit(uint64_t word) {
+        #if defined(__GNUC__)
+            return 63 - __builtin_clzll(word);
+        #else
+            int position = 63;
+            while (!(word >> 63)) { word <<= 1; position--; }
+            return position;
+        #endif
+    }
+
+    /**
+     * Gets the bits of the columns inside the layout in one word of a row, ignoring
+     * the gaps of the venue.
+     * 
+     * @param word The index of the word in the row
+     */
+    uint64_t columnMask(int word) {
+        int remaining = data::totalColumns - word * 64;
+        return (remaining >= 64) ? ~0ULL : ((1ULL << remaining) - 1);
+    }
+
+    /**
+     * Gets the bits of the seats that exist in one word of a row of data::occupancy.
+     * 
+     * @param irow The row of the word
+     * @param word The index of the word in the row
+     */
+    uint64_t seatMask(int irow, int word) {
+        return data::validity[(size_t) irow * data::wordsPerRow + word];
+    }
+
+    /**
+     * Checks if a seat is reserved, using the occupancy bits.
+     */
+    bool isOccupied(int irow, int icol) {
+        return (data::occupancy[(size_t) irow * data::wordsPerRow + icol / 64] >> (icol % 64)) & 1;
+    }
+
+    /**
+     * Finds the first free seat of a row at or after a given column, a word at a time.
+     * 
+     * @returns The column of the free seat, or -1 if there is none.
+     */
+    int nextFreeInRow(int irow, int from) {
+        if (from < 0) from = 0;
+        if (from >= data::totalColumns) return -1;
+
+        const uint64_t* words = data::occupancy.data() + (size_t) irow * data::wordsPerRow;
+        for (int word = from / 64; word < data::wordsPerRow; word++) {
+            uint64_t free = ~words[word] & seatMask(irow, word);
+            if (word == from / 64) free &= (~0ULL << (from % 64));
+            if (free) return word * 64 + lowestBit(free);
+        }
+        return -1;
+    }
+
+    /**
+     * Finds the last free seat of a row at or before a given column, a word at a time.
+     * 
+     * @returns The column of the free seat, or -1 if there is none.
+     */
+    int previousFreeInRow(int irow, int from) {
+        if (from >= data::totalColumns) from = data::totalColumns - 1;
+        if (from < 0) return -1;
+
+        const uint64_t* words = data::occupancy.data() + (size_t) irow * data::wordsPerRow;
+        for (int word = from / 64; word >= 0; word--) {
+            uint64_t free = ~words[word] & seatMask(irow, word);
+            if (word == from / 64 && from % 64 != 63) free &= ((1ULL << (from % 64 + 1)) - 1);
+            if (free) return word * 64 + highestBit(free);
+        }
+        return -1;
+    }
+
+    /**
+     * Finds the first column of a row at or after a given column that cannot be booked,
+     * either a reserved seat or a gap, a word at a time.
+     * 
+     * @returns The column, or data::totalColumns if there is none.
+     */
+    int nextUnavailableInRow(int irow, int from) {
+        if (from < 0) from = 0;
+        if (from >= data::totalColumns) return data::totalColumns;
+
+        const uint64_t* words = data::occupancy.data() + (size_t) irow * data::wordsPerRow;
+        for (int word = from / 64; word < data::wordsPerRow; word++) {
+            uint64_t unavailable = ~(~words[word] & seatMask(irow, word)) & columnMask(word);
+            if (word == from / 64) unavailable &= (~0ULL << (from % 64));
+            if (unavailable) return word * 64 + lowestBit(unavailable);
+        }
+        return data::totalColumns;
+    }
+
+    /**
+     * Finds the last column of a row at or before a given column that cannot be booked,
+     * either a reserved seat or a gap, a word at a time.
+     * 
+     * @returns The column, or -1 if there is none.
+     */
+    int previousUnavailableInRow(int irow, int from) {
+        if (from >= data::totalColumns) from = data::totalColumns - 1;
+        if (from < 0) return -1;
+
+        const uint64_t* words = data::occupancy.data() + (size_t) irow * data::wordsPerRow;
+        for (int word = from / 64; word >= 0; word--) {
+            uint64_t unavailable = ~(~words[word] & seatMask(irow, word)) & columnMask(word);
+            if (word == from / 64 && from % 64 != 63) unavailable &= ((1ULL << (from % 64 + 1)) - 1);
+            if (unavailable) return word * 64 + highestBit(unavailable);
+        }
+        return -1;
+    }
+
+    /**
+     * Finds the first free seat of a column at or after a given row.
+     * 
+     * @returns The row of the free seat, or -1 if there is none.
+     */
+    int nextFreeInColumn(int icol, int from) {
+        for (int irow = max(from, 0); irow < data::totalRows; irow++) {
+            if (!isOccupied(irow, icol) && ((seatMask(irow, icol / 64) >> (icol % 64)) & 1)) return irow;
+        }
+        return -1;
+    }
+
+    /**
+     * Finds the last free seat of a column at or before a given row.
+     * 
+     * @returns The row of the free seat, or -1 if there is none.
+     */
+    int previousFreeInColumn(int icol, int from) {
+        for (int irow = min(from, data::totalRows - 1); irow >= 0; irow--) {
+            if (!isOccupied(irow, icol) && ((seatMask(irow, icol / 64) >> (icol % 64)) & 1)) return irow;
+        }
+        return -1;
+    }
+
+    /**
+     * Builds the Fenwick tree of free seats from the occupancy and validity bits in
+     * O(rows * columns), by pushing every node into its parent along the columns
+     * and then along the rows.
+     */
+    void rebuildFreeIndex() {
+        int rows = data::totalRows, columns = data::totalColumns;
+        size_t stride = (size_t) columns + 1;
+        data::freeIndex.assign((size_t) (rows + 1) * stride, 0);
+        data::freeIndexPending.clear();
+        data::freeIndexStale = false;
+
+        for (int irow = 0; irow < rows; irow++) {
+            int32_t* line = data::freeIndex.data() + (size_t) (irow + 1) * stride;
+            for (int word = 0; word < data::wordsPerRow; word++) {
+                uint64_t free = ~data::occupancy[(size_t) irow * data::wordsPerRow + word] & seatMask(irow, word);
+                for (; free; free &= free - 1) {
+                    line[word * 64 + lowestBit(free) + 1] = 1;
+                }
+            }
+            for (int j = 1; j <= columns; j++) {
+                int parent = j + (j & -j);
+                if (parent <= columns) line[parent] += line[j];
+            }
+        }
+        for (int i = 1; i <= rows; i++) {
+            int parent = i + (i & -i);
+            if (parent > rows) continue;
+            for (int j = 1; j <= columns; j++) {
+                data::freeIndex[(size_t) parent * stride + j] += data::freeIndex[(size_t) i * stride + j];
+            }
+        }
+    }
+
+    /**
+     * Adds to the free seat count of one seat in the Fenwick tree.
+     */
+    void updateFreeIndex(int irow, int icol, int change) {
+        size_t stride = (size_t) data::totalColumns + 1;
+        for (int i = irow + 1; i <= data::totalRows; i += i & -i) {
+            int32_t* line = data::freeIndex.data() + (size_t) i * stride;
+            for (int j = icol + 1; j <= data::totalColumns; j += j & -j) {
+                line[j] += change;
+            }
+        }
+    }
+
+    /**
+     * Notes a seat taken or freed, to be added to the Fenwick tree on the next count.
+     * Booking stays O(1) this way, and a layout that is never counted never pays for
+     * the tree. Past about one change per 64 seats, a rebuild (O(rows * columns)) is
+     * cheaper than adding them one by one (O(log rows * log columns) each).
+     */
+    void noteFreeChange(int irow, int icol, bool freed) {
+        if (data::freeIndexStale) return;
+
+        if (data::freeIndexPending.size() >= (size_t) data::totalRows * data::totalColumns / 64 + 16) {
+            data::freeIndexPending.clear();
+            data::freeIndexStale = true;
+            return;
+        }
+        int64_t seat = (int64_t) irow * data::totalColumns + icol + 1;
+        data::freeIndexPending.push_back(freed ? seat : -seat);
+    }
+
+    /**
+     * Brings the Fenwick tree of free seats up to date with the seats taken or freed
+     * since it was last counted.
+     */
+    void foldFreeIndex() {
+        if (data::freeIndexStale) {
+            rebuildFreeIndex();
+            return;
+        }
+        for (int64_t seat : data::freeIndexPending) {
+            int64_t index = (seat > 0 ? seat : -seat) - 1;
+            updateFreeIndex((int) (index / data::totalColumns), (int) (index % data::totalColumns), seat > 0 ? 1 : -1);
+        }
+        data::freeIndexPending.clear();
+    }
+
+    /**
+     * Counts the free seats in the rows and columns before a given row and column.
+     */
+    int countFreeBefore(int rows, int columns) {
+        size_t stride = (size_t) data::totalColumns + 1;
+        int count = 0;
+        for (int i = rows; i > 0; i -= i & -i) {
+            const int32_t* line = data::freeIndex.data() + (size_t) i * stride;
+            for (int j = columns; j > 0; j -= j & -j) {
+                count += line[j];
+            }
+        }
+        return count;
+    }
+
+    /**
+     * Counts the free seats in a rectangle of the seat layout, in O(log rows * log columns)
+     * once the seats changed since the last count are added to the tree. The rectangle
+     * is clipped to the layout.
+     * 
+     * @param firstRow The first row of the rectangle
+     * @param lastRow The last row of the rectangle
+     * @param firstColumn The first column of the rectangle
+     * @param lastColumn The last column of the rectangle
+     * 
+     * @returns The number of free seats in the rectangle, 0 if it is empty.
+     */
+    int countFreeSeats(int firstRow, int lastRow, int firstColumn, int lastColumn) {
+        firstRow = max(firstRow, 0);
+        firstColumn = max(firstColumn, 0);
+        lastRow = min(lastRow, data::totalRows - 1);
+        lastColumn = min(lastColumn, data::totalColumns - 1);
+        if (firstRow > lastRow || firstColumn > lastColumn) return 0;
+
+        foldFreeIndex();
+        return countFreeBefore(lastRow + 1, lastColumn + 1) 
+            - countFreeBefore(firstRow, lastColumn + 1) 
+            - countFreeBefore(lastRow + 1, firstColumn) 
+            + countFreeBefore(firstRow, firstColumn);
+    }
+
+    /**
+     * Maps the rows to their sections and sums the row counts of every section. The
+     * sections past the last row are dropped and the ones it cuts are shortened.
+     */
+    void rebuildSections() {
+        int rows = data::totalRows;
+
+        vector<Section> kept;
+        for (Section section : data::sections) {
+            if (section.firstRow >= rows) continue;
+            section.lastRow = min(section.lastRow, rows - 1);
+            kept.push_back(section);
+        }
+        data::sections = move(kept);
+
+        data::rowSection.assign(rows, -1);
+        for (size_t isection = 0; isection < data::sections.size(); isection++) {
+            Section& section = data::sections[isection];
+            section.seats = section.occupied = section.held = 0;
+            for (int irow = section.firstRow; irow <= section.lastRow; irow++) {
+                data::rowSection[irow] = (int) isection;
+                section.seats += data::rowSeats[irow];
+                section.occupied += data::rowOccupied[irow];
+                section.held += data::rowHeld[irow];
+            }
+        }
+    }
+
+    /**
+     * Recomputes the occupied seat counts and the first and last free seats of every
+     * row and column from the occupancy bits, working a word at a time, along with
+     * the Fenwick tree of free seats and the counts of the sections.
+     */
+    void rebuildAggregates() {
+        int rows = data::totalRows, columns = data::totalColumns;
+
+        data::rowOccupied.assign(rows, 0);
+        data::rowSeats.assign(rows, 0);
+        data::rowHeld.assign(rows, 0);
+        data::rowFirstFree.assign(rows, -1);
+        data::rowLastFree.assign(rows, -1);
+        data::columnOccupied.assign(columns, 0);
+        data::columnFirstFree.assign(columns, -1);
+        data::columnLastFree.assign(columns, -1);
+
+        int total = 0;
+        for (int irow = 0; irow < rows; irow++) {
+            for (int word = 0; word < data::wordsPerRow; word++) {
+                uint64_t occupied = data::occupancy[(size_t) irow * data::wordsPerRow + word] & seatMask(irow, word);
+                data::rowOccupied[irow] += (int) bitset<64>(occupied).count();
+                data::rowSeats[irow] += (int) bitset<64>(seatMask(irow, word)).count();
+                for (; occupied; occupied &= occupied - 1) {
+                    int icol = word * 64 + lowestBit(occupied);
+                    data::columnOccupied[icol]++;
+                    if (data::seats[irow][icol].isHeld) data::rowHeld[irow]++;
+                }
+            }
+            data::rowFirstFree[irow] = nextFreeInRow(irow, 0);
+            data::rowLastFree[irow] = previousFreeInRow(irow, columns - 1);
+            total += data::rowOccupied[irow];
+        }
+        data::totalOccupiedSeats = total;
+        data::totalHeld = 0;
+        for (int held : data::rowHeld) data::totalHeld += held;
+
+        // The first (and last) free seat of each column, found by sweeping the rows
+        // down (and up) while keeping the columns that have not found one yet
+        for (int pass = 0; pass < 2; pass++) {
+            vector<int>& found = (pass == 0) ? data::columnFirstFree : data::columnLastFree;
+            vector<uint64_t> pending(data::wordsPerRow, ~0ULL);
+
+            for (int step = 0; step < rows; step++) {
+                int irow = (pass == 0) ? step : rows - 1 - step;
+                for (int word = 0; word < data::wordsPerRow; word++) {
+                    uint64_t free = ~data::occupancy[(size_t) irow * data::wordsPerRow + word] & seatMask(irow, word) & pending[word];
+                    pending[word] &= ~free;
+                    for (; free; free &= free - 1) {
+                        found[word * 64 + lowestBit(free)] = irow;
+                    }
+                }
+            }
+        }
+
+        rebuildFreeIndex();
+        rebuildSections();
+    }
+
+    /**
+     * Updates the aggregates of the row and column of a seat, and notes the change for
+     * the Fenwick tree of free seats, after it was reserved or cancelled, and the
+     * occupancy bits already reflect the change.
+     * 
+     * @param irow The row of the seat
+     * @param icol The column of the seat
+     * @param reserved Whether the seat was reserved (true) or cancelled (false)
+     */
+    void updateAggregates(int irow, int icol, bool reserved) {
+        int change = reserved ? 1 : -1;
+        data::rowOccupied[irow] += change;
+        data::columnOccupied[icol] += change;
+        data::totalOccupiedSeats += change;
+        noteFreeChange(irow, icol, !reserved);
+        if (data::rowSection[irow] >= 0) data::sections[data::rowSection[irow]].occupied += change;
+
+        if (reserved) {
+            if (data::rowFirstFree[irow] == icol) data::rowFirstFree[irow] = nextFreeInRow(irow, icol + 1);
+            if (data::rowLastFree[irow] == icol) data::rowLastFree[irow] = previousFreeInRow(irow, icol - 1);
+            if (data::columnFirstFree[icol] == irow) data::columnFirstFree[icol] = nextFreeInColumn(icol, irow + 1);
+            if (data::columnLastFree[icol] == irow) data::columnLastFree[icol] = previousFreeInColumn(icol, irow - 1);
+        } else {
+            if (data::rowFirstFree[irow] < 0 || icol < data::rowFirstFree[irow]) data::rowFirstFree[irow] = icol;
+            if (icol > data::rowLastFree[irow]) data::rowLastFree[irow] = icol;
+            if (data::columnFirstFree[icol] < 0 || irow < data::columnFirstFree[icol]) data::columnFirstFree[icol] = irow;
+            if (irow > data::columnLastFree[icol]) data::columnLastFree[icol] = irow;
+        }
+    }
+
+    /**
+     * Updates the held seat counts of a row, its section and the layout.
+     * 
+     * @param irow The row of the seat
+     * @param change 1 for a new hold, -1 for a hold confirmed or released
+     */
+    void updateHeld(int irow, int change) {
+        data::rowHeld[irow] += change;
+        data::totalHeld += change;
+        if (data::rowSection[irow] >= 0) data::sections[data::rowSection[irow]].held += change;
     }
 
     /**
@@ -30,16 +612,20 @@ namespace seatrs {
      * @param columns The number of columns in the new seat layout.
      */
     void setSize(int rows = 10, int columns = 10) {
+        int oldRows = data::seats ? data::totalRows : 0;
+        int oldColumns = data::seats ? data::totalColumns : 0;
+        int oldWordsPerRow = data::wordsPerRow;
 
-        // Create a 2d array with the specified size
+        // Create a 2d array with the specified size, as a table of rows into a single block
+        Seat* newBlock = new Seat[(size_t) rows * columns];
         Seat** newSeats = new Seat*[rows];
         for (int iRow = 0; iRow < rows; iRow++) {
-            newSeats[iRow] = new Seat[columns];
+            newSeats[iRow] = newBlock + (size_t) iRow * columns;
         }
 
         if (data::seats != nullptr) {
 
-            // Copy as much of the old array into the new array
+            // Move as much of the old array into the new array
             for (
                 int iRow = 0; 
                 (
@@ -50,25 +636,88 @@ namespace seatrs {
                 iRow++
             ) {
                 for (int iColumn = 0; (data::totalColumns < columns ? iColumn < data::totalColumns : iColumn < columns); iColumn++) {
-                    newSeats[iRow][iColumn] = data::seats[iRow][iColumn]; 
+                    newSeats[iRow][iColumn] = move(data::seats[iRow][iColumn]); 
                 }
             }
 
             // Delete the old 2d array to free up memory
-            for (int iRow = 0; iRow < data::totalRows; iRow++) {
-                delete[] data::seats[iRow];
-            }
+            delete[] data::seatBlock;
             delete[] data::seats;
         }
 
+        data::tiers = resizeColumn(data::tiers, rows, columns);
+        data::prices = resizeColumn(data::prices, rows, columns);
+        data::features = resizeColumn(data::features, rows, columns);
+
         // Update the seats pointer and dimensions
         data::seats = newSeats;
+        data::seatBlock = newBlock;
         data::totalRows = rows;
         data::totalColumns = columns;
+
+        // Keep the gaps of the rows and columns that were kept, and add every new seat
+        data::wordsPerRow = (columns + 63) / 64;
+        vector<uint64_t> validity((size_t) rows * data::wordsPerRow, 0);
+        data::totalSeats = 0;
+        for (int iRow = 0; iRow < rows; iRow++) {
+            uint64_t* words = validity.data() + (size_t) iRow * data::wordsPerRow;
+            for (int word = 0; word < data::wordsPerRow; word++) {
+                words[word] = columnMask(word);
+            }
+            for (int iColumn = 0; iRow < oldRows && iColumn < min(columns, oldColumns); iColumn++) {
+                if (!((data::validity[(size_t) iRow * oldWordsPerRow + iColumn / 64] >> (iColumn % 64)) & 1)) {
+                    words[iColumn / 64] &= ~(1ULL << (iColumn % 64));
+                }
+            }
+            for (int word = 0; word < data::wordsPerRow; word++) {
+                data::totalSeats += (int) bitset<64>(words[word]).count();
+            }
+        }
+        data::validity = move(validity);
+
+        // Rebuild the occupancy bits from the seats that were kept
+        data::occupancy.assign((size_t) rows * data::wordsPerRow, 0);
+        for (int iRow = 0; iRow < rows; iRow++) {
+            for (int iColumn = 0; iColumn < columns; iColumn++) {
+                if (newSeats[iRow][iColumn].isReserved) {
+                    data::occupancy[(size_t) iRow * data::wordsPerRow + iColumn / 64] |= (1ULL << (iColumn % 64));
+                }
+            }
+        }
+
+        rebuildAggregates();
+
+        if (!changeListeners.empty()) {
+            Change change;
+            change.kind = RESIZE;
+            change.row = rows;
+            change.column = columns;
+            notifyChange(change);
+        }
+    }
+
+    /**
+     * Replaces the seat layout with an empty one of the given size: no reservations,
+     * gaps, attributes or sections are kept from the old layout.
+     * 
+     * @param rows The number of rows in the new seat layout.
+     * @param columns The number of columns in the new seat layout.
+     */
+    void resetLayout(int rows, int columns) {
+        delete[] data::seatBlock;
+        delete[] data::seats;
+        data::seatBlock = nullptr;
+        data::seats = nullptr;
+
+        data::tiers.clear();
+        data::prices.clear();
+        data::features.clear();
+        data::sections.clear();
+        setSize(rows, columns);
     }
 
     /**
-     * Checks if a given seat position is valid.
+     * Checks if a given seat position is valid: inside the layout and not a gap.
      * 
      * @param irow The row of the seat
      * @param icol The column of the seat
@@ -77,1217 +726,9594 @@ namespace seatrs {
      */
     bool isValidSeat(int irow, int icol) {
         return (irow >= 0) && (irow < data::totalRows) && 
-        (icol >= 0) && (icol < data::totalColumns);
+        (icol >= 0) && (icol < data::totalColumns) &&
+        ((data::validity[(size_t) irow * data::wordsPerRow + icol / 64] >> (icol % 64)) & 1);
     }
-}
 
-namespace program {
-    namespace config {
-        int lengthHUD = 80;
+    enum Result {
+        OK = 0,
+        INVALID_SEAT,
+        ALREADY_RESERVED,
+        NOT_RESERVED,
+        CONFLICT            // changed by another process since this one last saw it
+    };
+
+    // How many client request IDs are remembered at most, and for how long
+    const size_t requestCapacity = 1 << 16;
+    const int64_t requestLifetimeMicros = 10LL * 60 * 1000000;
+
+    /**
+     * A generation of request IDs: an open-addressed table with twice the slots of the
+     * IDs it may hold, so probes stay short. A slot is 8 bytes, the hash of an ID with
+     * the result of its request in the low 4 bits, or 0 when empty, so finding an ID
+     * never leaves the table.
+     */
+    struct RequestTable {
+        vector<uint64_t> slots = vector<uint64_t>(requestCapacity);
+        size_t used = 0;
+        int64_t startedAt = 0;
+    };
+
+    namespace data {
+        // The IDs of the current generation and of the one before it. Once the current
+        // one is half the capacity or half the lifetime old, it replaces the older one,
+        // so an ID is remembered for between half and all of the lifetime.
+        RequestTable requests[2];
+        int currentRequests = 0;
+        uint64_t repeatedRequests = 0;
     }
 
-    namespace control {
-        const int minLengthHUD = 60;
-        const int maxLengthHUD = 100;
-        const int maxPossibleRows = maxLengthHUD;
-        const int maxPossibleColumns = maxLengthHUD;
+    /**
+     * Gets a monotonic time in microseconds, only as precise as the kernel's clock tick
+     * but much cheaper to read than steady_clock.
+     */
+    int64_t coarseMicros() {
+        #ifdef UNIX_LIKE
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+            return (int64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+        #else
+            return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+        #endif
     }
-}
 
-namespace utils {
+    /**
+     * Finds the slot of a hash in a table of request IDs, or the empty slot it would go in.
+     */
+    uint64_t& findRequest(RequestTable& table, uint64_t key) {
+        size_t mask = table.slots.size() - 1;
+        for (size_t index = (key >> 5) & mask;; index = (index + 1) & mask) {
+            uint64_t& slot = table.slots[index];
+            if ((slot & ~0xFULL) == key || slot == 0) return slot;
+        }
+    }
 
-    namespace format {
+    /**
+     * Starts a new generation of request IDs, forgetting the IDs of the oldest one.
+     */
+    void rotateRequests() {
+        RequestTable& previous = data::requests[1 - data::currentRequests];
+        fill(previous.slots.begin(), previous.slots.end(), 0);
+        previous.used = 0;
+        data::currentRequests = 1 - data::currentRequests;
+    }
 
-        /**
-         * Repeat a given string a given number of times.
-         *
-         * @param num The number of times to repeat the string.
-         * @param text The string to repeat.
-         *
-         * @returns A string consisting of the given string repeated the
-         *          given number of times.
-         */
-        string repeatText(int num, string text) {
-            string result;
-            for (int i = 0; i < num; i++) {
-                result += text;
-            }
-            return result;
+    /**
+     * Carries out a mutating operation once per client request ID. An ID seen within
+     * the last 5 to 10 minutes gets the result of its first attempt back without the
+     * operation being carried out again, so a retried or double-sent command is
+     * harmless. IDs are told apart by their hash alone.
+     *
+     * @param requestId The ID the client gave the operation, or empty for none.
+     * @param operation The operation, returning its Result.
+     *
+     * @returns The result of the operation, now or when it was first carried out.
+     */
+    template <typename Operation>
+    Result once(const string& requestId, Operation operation) {
+        if (requestId.empty()) return operation();
+
+        uint64_t key = (hash<string>()(requestId) & ~0xFULL) | 0x10;
+        int64_t now = coarseMicros();
+
+        // The current generation never gets older than half the lifetime, so only the
+        // previous one can hold IDs that expired
+        if (data::requests[data::currentRequests].used > 0 && now - data::requests[data::currentRequests].startedAt >= requestLifetimeMicros / 2) {
+            rotateRequests();
         }
-        
-        /**
-         * Repeat a given char a given number of times.
-         *
-         * @param num The number of times to repeat the character.
-         * @param text The character to repeat.
-         *
-         * @returns A string consisting of the given character repeated the
-         *          given number of times.
-         */
-        string repeatText(int num, char text) {
-            return string(num, text);
+        RequestTable& current = data::requests[data::currentRequests];
+        RequestTable& previous = data::requests[1 - data::currentRequests];
+
+        uint64_t* slot = &findRequest(current, key);
+        uint64_t found = *slot;
+        if (found == 0 && previous.used > 0 && now - previous.startedAt < requestLifetimeMicros) {
+            found = findRequest(previous, key);
+        }
+        if (found != 0) {
+            data::repeatedRequests++;
+            return (Result) (found & 0xF);
         }
 
-        /**
-         * Split a given string into words, ensuring that no word exceeds the
-         * given limit.
-         *
-         * @param input The string to split into words.
-         * @param limit The maximum number of characters allowed in each word.
-         *
-         * @returns A vector of strings, each containing a line from the
-         *          original input string. No line exceeds the given limit.
-         */
-        vector<string> splitWords(const string& input, size_t limit) {
-            stringstream stream(input); // Stream to process the input line by line
-            string line, word, result;
-            vector<string> results;
-            char space = ' ';
+        size_t used = current.used;
+        Result result = operation();
 
-            while (getline(stream, line)) {
-                result.clear();
+        // the slot found above is still the one to fill, unless the operation recorded an ID itself
+        if (current.used != used) slot = &findRequest(current, key);
+        if (current.used == 0) current.startedAt = now;
+        *slot = key | (uint64_t) result;
+        current.used++;
 
-                int currentLength = 0;
-                int i = 0;
+        if (current.used >= requestCapacity / 2) rotateRequests();
+        return result;
+    }
 
-                // Preserve leading spaces (indent) for each line
-                while (i < line.length() && line[i] == space) i++;
-                
-                result += string(i, space);
-                currentLength = result.length();
+    /**
+     * Marks a seat as taken, either as a reservation or as a hold, once it has been
+     * checked and claimed.
+     */
+    void markSeat(int irow, int icol, const string& name, const string& description, ChangeKind kind) {
+        Seat &seat = data::seats[irow][icol];
+        bool confirming = seat.isHeld && kind == RESERVE;
+
+        seat.name = name;
+        seat.description = description;
+        seat.isHeld = (kind == HOLD);
+        if (confirming || seat.isHeld) updateHeld(irow, seat.isHeld ? 1 : -1);
+        if (!confirming) {
+            seat.isReserved = true;
+            data::occupancy[(size_t) irow * data::wordsPerRow + icol / 64] |= (1ULL << (icol % 64));
+            updateAggregates(irow, icol, true);
+        }
+    }
 
-                while (i < line.length()) {
-                    int spaceStart = i;
-                    while (i < line.length() && line[i] == space) i++;
-                    int wordStart = i;
-                    while (i < line.length() && line[i] != space) i++;
-                    int wholeLength = i - spaceStart;
-                    int wordLength = i - wordStart;
+    /**
+     * Takes a free seat, either as a reservation or as a hold.
+     */
+    Result occupySeat(int irow, int icol, const string& name, const string& description, ChangeKind kind) {
+        if (!isValidSeat(irow, icol)) {
+            return INVALID_SEAT;
+        }
 
-                    if ((currentLength + (currentLength > 0 ? wholeLength : wordLength) > limit) && !(wordLength > limit)) {
-                        results.push_back(result);
-                        result.clear();
-                        currentLength = 0;
-                    }
+        Seat &seat = data::seats[irow][icol];
+        bool confirming = seat.isHeld && kind == RESERVE;
+        if (seat.isReserved && !confirming) {
+            return ALREADY_RESERVED;
+        }
 
-                    int length = (currentLength > 0 ? wholeLength : wordLength);
+        if (!confirming && claimSeat && !claimSeat(irow, icol)) {
+            return ALREADY_RESERVED;
+        }
 
-                    result += line.substr((currentLength > 0 ? spaceStart : wordStart), length);
-                    currentLength += length;
-                }
+        // another window may have released or confirmed the hold in the meantime
+        if (confirming && commitSeat) {
+            Change change;
+            change.kind = kind;
+            change.row = irow;
+            change.column = icol;
+            change.name = name;
+            change.description = description;
+            if (!commitSeat(change)) return CONFLICT;
+        }
 
-                // Add the last part of the processed line
-                results.push_back(result);
-                
-            }
+        markSeat(irow, icol, name, description, kind);
 
-            return results;
+        if (!changeListeners.empty()) {
+            Change change;
+            change.kind = kind;
+            change.row = irow;
+            change.column = icol;
+            change.name = name;
+            change.description = description;
+            notifyChange(change);
         }
+        return OK;
+    }
 
-        enum FormatAlign { 
-            LEFT, 
-            CENTER, 
-            RIGHT 
-        };
+    /**
+     * Reserves a free seat under the given name and description. A held seat is
+     * reserved too, which confirms the hold.
+     * 
+     * @param irow The row of the seat
+     * @param icol The column of the seat
+     * @param name The name the seat is reserved under
+     * @param description The description of the reservation
+     * @param requestId The client's ID for the request, or empty for none
+     * 
+     * @returns OK if the seat was reserved, INVALID_SEAT or ALREADY_RESERVED otherwise, 
+     * or CONFLICT if another window changed the hold being confirmed
+     */
+    Result reserveSeat(int irow, int icol, const string& name, const string& description, const string& requestId = "") {
+        return once(requestId, [&] { return occupySeat(irow, icol, name, description, RESERVE); });
+    }
 
-        struct FormatParams {
-            FormatAlign align = LEFT;
-            int limitLength = -1;       // negative means use program::config::lengthHUD
-            int padding = 0;
-            string space = " ";
-            int explicitTextLength = 0; // to handle text where length != no. characters
-                                        //   like \t which is 1 character but 4 spaces,
-                                        //   specifically for the nameArt to work.
-        } optionsFormat = {LEFT, -1, 8};
+    /**
+     * Sets the size of the seat layout once per client request ID, like setSize().
+     * 
+     * @param rows The number of rows in the new seat layout.
+     * @param columns The number of columns in the new seat layout.
+     * @param requestId The client's ID for the request, or empty for none
+     * 
+     * @returns OK, now or when the layout was first resized for the request.
+     */
+    Result setSize(int rows, int columns, const string& requestId) {
+        return once(requestId, [&] {
+            setSize(rows, columns);
+            return OK;
+        });
+    }
 
-        /**
-         * Format a given string into a block of text with a specified length, 
-         * with optional padding and centering. The text is split into words and 
-         * each word is placed on a new line if it exceeds the specified length. 
-         * The words are then formatted and padded with a given space character.
-         * 
-         * @param text The text to format.
-         * @param params The parameters for formatting the text.
-         * 
-         * @returns A string consisting of the formatted text.
-         */
-        string formatText(const string& text, FormatParams params) {
-            int spaceLeft, spaceRight;
-            int lineLength;
-            string spaceLeftText, spaceRightText;
-            string result;
+    struct SeatReservation {
+        int row = 0, column = 0;
+        string name, description;
+    };
 
-            vector<string> lines = 
-                (params.explicitTextLength > 0)
-                    ? vector<string> {text} // the text length is explicitly defined,
-                                            //   expected to only be in one line.  
-                    : splitWords(text, params.limitLength - (params.padding * 2));  // get the lines after splitting the words 
-                                                                                    //   based on the limit length for each line.
+    /**
+     * Reserves a batch of free seats as a whole: every seat is checked and claimed
+     * before any is reserved, so either all of them are reserved or none is. The
+     * change listeners hear of the seats only once all of them are reserved.
+     * 
+     * @param reservations The seats to reserve, each once, with their names and descriptions
+     * @param requestId The client's ID for the request, or empty for none
+     * 
+     * @returns OK if every seat was reserved, INVALID_SEAT or ALREADY_RESERVED otherwise
+     */
+    Result reserveSeats(const vector<SeatReservation>& reservations, const string& requestId = "") {
+        return once(requestId, [&] {
+            for (const SeatReservation& reservation : reservations) {
+                if (!isValidSeat(reservation.row, reservation.column)) return INVALID_SEAT;
+                if (data::seats[reservation.row][reservation.column].isReserved) return ALREADY_RESERVED;
+            }
 
-            for (int i = 0; i < lines.size(); i++) {
-                string line = lines[i];
+            if (claimSeat) {
+                for (size_t i = 0; i < reservations.size(); i++) {
+                    if (claimSeat(reservations[i].row, reservations[i].column)) continue;
+                    for (size_t claimed = 0; claimed < i && unclaimSeat; claimed++) {
+                        unclaimSeat(reservations[claimed].row, reservations[claimed].column);
+                    }
+                    return ALREADY_RESERVED;
+                }
+            }
 
-                lineLength = 
-                    (params.explicitTextLength > 0) 
-                        ? (params.explicitTextLength)
-                        : (line.length());
+            for (const SeatReservation& reservation : reservations) {
+                markSeat(reservation.row, reservation.column, reservation.name, reservation.description, RESERVE);
+            }
 
-                if (params.limitLength < 0) {
-                    params.limitLength = program::config::lengthHUD;
+            if (!changeListeners.empty()) {
+                for (const SeatReservation& reservation : reservations) {
+                    Change change;
+                    change.kind = RESERVE;
+                    change.row = reservation.row;
+                    change.column = reservation.column;
+                    change.name = reservation.name;
+                    change.description = reservation.description;
+                    notifyChange(change);
                 }
-                
-                // Determine how much space each line should have, excluding padding and line length
-                int spaceTotalLength = params.limitLength - lineLength - (params.padding * 2);
+            }
+            return OK;
+        });
+    }
 
-                // Determine in what alignment each line should be formatted in
-                switch (params.align) {
-                    case LEFT:
-                        spaceLeft = 0;
-                        spaceRight = spaceTotalLength;
-                        break;
-                    case CENTER:
-                        spaceLeft = ((params.limitLength - lineLength) / 2) - params.padding;
-                        if ((params.limitLength - lineLength) % 2 == 0) {
-                            spaceRight = spaceLeft;
-                        }
-                        else {
-                            spaceRight = spaceLeft + 1;
-                        }
-                        break;
-                    case RIGHT:
-                        spaceLeft = spaceTotalLength;
-                        spaceRight = 0;
-                        break;
-                }
+    /**
+     * Holds a free seat under the given name and description, such as while a party
+     * pays. A held seat is taken like a reserved one until the hold is confirmed with
+     * reserveSeat() or released with cancelSeat().
+     * 
+     * @param irow The row of the seat
+     * @param icol The column of the seat
+     * @param name The name the seat is held under
+     * @param description The description of the hold
+     * @param requestId The client's ID for the request, or empty for none
+     * 
+     * @returns OK if the seat was held, INVALID_SEAT or ALREADY_RESERVED otherwise
+     */
+    Result holdSeat(int irow, int icol, const string& name, const string& description, const string& requestId = "") {
+        return once(requestId, [&] { return occupySeat(irow, icol, name, description, HOLD); });
+    }
 
-                spaceLeftText = repeatText(spaceLeft, params.space);
-                spaceRightText = repeatText(spaceRight, params.space);
+    /**
+     * Replaces the name and description of a reserved seat.
+     * 
+     * @param irow The row of the seat
+     * @param icol The column of the seat
+     * @param name The new name of the reservation
+     * @param description The new description of the reservation
+     * @param requestId The client's ID for the request, or empty for none
+     * 
+     * @returns OK if the reservation was updated, INVALID_SEAT or NOT_RESERVED otherwise
+     */
+    Result updateSeat(int irow, int icol, const string& name, const string& description, const string& requestId = "") {
+        return once(requestId, [&] {
+            if (!isValidSeat(irow, icol)) {
+                return INVALID_SEAT;
+            }
 
-                result += (repeatText(params.padding, params.space) + spaceLeftText + line + spaceRightText + repeatText(params.padding, params.space) + (i < lines.size() - 1 ? "\n" : ""));
+            Seat &seat = data::seats[irow][icol];
+            if (!seat.isReserved) {
+                return NOT_RESERVED;
             }
 
-            return result;
-        }
+            Change change;
+            change.kind = UPDATE;
+            change.row = irow;
+            change.column = icol;
+            change.name = name;
+            change.description = description;
+            if (commitSeat && !commitSeat(change)) {
+                return CONFLICT;
+            }
 
+            seat.name = name;
+            seat.description = description;
 
-        /**
-         * Format a given vector of strings into a block of text with a specified length, 
-         * with optional padding and centering. The words are then formatted and padded
-         * with a given space character.
-         * 
-         * @param text The text to format, given as a vector of strings.
-         * @param params The parameters for formatting the text.
-         * 
-         * @returns A string consisting of the formatted text.
-         */
-        string formatText(const vector<string> text, FormatParams params) {
-            string result;
-            for (auto line : text) {
-                result += (formatText(line, params) + "\n");
+            if (!changeListeners.empty()) notifyChange(change);
+            return OK;
+        });
+    }
+
+    /**
+     * Cancels the reservation of a seat, marking it as available.
+     * 
+     * @param irow The row of the seat
+     * @param icol The column of the seat
+     * @param requestId The client's ID for the request, or empty for none
+     * 
+     * @returns OK if the reservation was cancelled, INVALID_SEAT or NOT_RESERVED otherwise
+     */
+    Result cancelSeat(int irow, int icol, const string& requestId = "") {
+        return once(requestId, [&] {
+            if (!isValidSeat(irow, icol)) {
+                return INVALID_SEAT;
             }
-            return result;
-        }
 
-        /**
-         * Format a given input prompt and value as a string. Used to
-         * save a user's input for continuous prompts.
-         * 
-         * @param prompt The input prompt to format.
-         * @param value The value entered by the user, if any.
-         * @param indentString The optional indent string to prepend to the formatted string.
-         * 
-         * @returns A string consisting of the formatted input prompt and value.
-         */
-        string formatAsInput(const string& prompt, const string& value = "", const string& indentString = " >> ") {
-            return (indentString + prompt + value + '\n');
-        }
+            Seat &seat = data::seats[irow][icol];
+            if (!seat.isReserved) {
+                return NOT_RESERVED;
+            }
+
+            Change change;
+            change.kind = CANCEL;
+            change.row = irow;
+            change.column = icol;
+            if (commitSeat && !commitSeat(change)) {
+                return CONFLICT;
+            }
+
+            if (seat.isHeld) updateHeld(irow, -1);
+            seat.description.clear();
+            seat.name.clear();
+            seat.isReserved = false;
+            seat.isHeld = false;
+            data::occupancy[(size_t) irow * data::wordsPerRow + icol / 64] &= ~(1ULL << (icol % 64));
+            updateAggregates(irow, icol, false);
+
+            if (!changeListeners.empty()) notifyChange(change);
+            return OK;
+        });
     }
 
-    namespace input {
-        /**
-         * Handles the failure state of standard input stream (cin).
-         * 
-         * This function checks if the cin stream is in a failure state and
-         * resets it if necessary. It also clears the input buffer to prevent
-         * any incorrect data from remaining in the stream.
-         * 
-         * @param fail A reference to a boolean variable that is set to true
-         *             if cin is in a failure state, false otherwise.
-         */
-        void cinHandleFail(bool& fail) {
-            // Learned from: https://stackoverflow.com/a/60890250
+    /**
+     * Sets the attributes of every seat in a rectangle of the seat layout.
+     * 
+     * @param firstRow The first row of the rectangle
+     * @param lastRow The last row of the rectangle
+     * @param firstColumn The first column of the rectangle
+     * @param lastColumn The last column of the rectangle
+     * @param tier The tier of the seats, 0 for no tier
+     * @param price The price of the seats
+     * @param features The SeatFeature flags of the seats
+     * @param requestId The client's ID for the request, or empty for none
+     * 
+     * @returns OK if the attributes were set, INVALID_SEAT if the rectangle is not in the layout
+     */
+    Result setAttributes(int firstRow, int lastRow, int firstColumn, int lastColumn, int tier, int price, int features, const string& requestId = "") {
+        return once(requestId, [&] {
+            if (!isValidSeat(firstRow, firstColumn) || !isValidSeat(lastRow, lastColumn) || firstRow > lastRow || firstColumn > lastColumn) {
+                return INVALID_SEAT;
+            }
 
-            // Check if cin is in a failure state
-            fail = cin.fail();
+            for (int irow = firstRow; irow <= lastRow; irow++) {
+                size_t start = (size_t) irow * data::totalColumns;
+                fill(data::tiers.begin() + start + firstColumn, data::tiers.begin() + start + lastColumn + 1, (uint8_t) tier);
+                fill(data::prices.begin() + start + firstColumn, data::prices.begin() + start + lastColumn + 1, (int32_t) price);
+                fill(data::features.begin() + start + firstColumn, data::features.begin() + start + lastColumn + 1, (uint8_t) features);
+            }
 
-            if (fail) {
-                cin.clear();
+            if (!changeListeners.empty()) {
+                Change change;
+                change.kind = ATTRIBUTES;
+                change.row = firstRow;
+                change.column = firstColumn;
+                change.lastRow = lastRow;
+                change.lastColumn = lastColumn;
+                change.tier = tier;
+                change.price = price;
+                change.features = features;
+                notifyChange(change);
             }
 
-            // Clearing the input buffer regardless of fail allows to clean excess input
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            return OK;
+        });
+    }
+
+    /**
+     * Writes the shape of the venue as one line per row, with O for a seat and . for
+     * a gap, in the format of the venue map files.
+     */
+    string describeShape() {
+        string text;
+        text.reserve((size_t) data::totalRows * (data::totalColumns + 1));
+        for (int irow = 0; irow < data::totalRows; irow++) {
+            for (int icol = 0; icol < data::totalColumns; icol++) {
+                text += ((seatMask(irow, icol / 64) >> (icol % 64)) & 1) ? 'O' : '.';
+            }
+            text += '\n';
         }
+        return text;
+    }
 
-        /**
-         * Prompts the user for input and reads an integer into the provided variable.
-         * 
-         * @param prompt The message displayed to the user before input.
-         * @param var A reference to an int variable where the input will be stored.
-         * 
-         * @returns A boolean indicating whether the input is invalid.
-         */
-        bool getInput(const string prompt, int& var) {
-            bool fail;
+    /**
+     * Replaces the shape of the venue. Seats outside the shape become gaps, which
+     * cannot be reserved and are not counted as seats.
+     * 
+     * @param validity The seats that exist, laid out like data::occupancy for the
+     *                 current size of the layout.
+     * @param requestId The client's ID for the request, or empty for none
+     * 
+     * @returns OK if the shape was set, INVALID_SEAT if the mask does not match the
+     *          size of the layout, or ALREADY_RESERVED if a reserved seat would become a gap.
+     */
+    Result setShape(const vector<uint64_t>& validity, const string& requestId = "") {
+        return once(requestId, [&] {
+            if (validity.size() != data::occupancy.size()) {
+                return INVALID_SEAT;
+            }
 
-            cout << " >> " << prompt;
-            cin >> var;
+            int totalSeats = 0;
+            for (int irow = 0; irow < data::totalRows; irow++) {
+                for (int word = 0; word < data::wordsPerRow; word++) {
+                    size_t index = (size_t) irow * data::wordsPerRow + word;
+                    if (data::occupancy[index] & ~validity[index]) {
+                        return ALREADY_RESERVED;
+                    }
+                    totalSeats += (int) bitset<64>(validity[index] & columnMask(word)).count();
+                }
+            }
 
-            cinHandleFail(fail);
-            return fail;
-        }
+            for (int irow = 0; irow < data::totalRows; irow++) {
+                for (int word = 0; word < data::wordsPerRow; word++) {
+                    size_t index = (size_t) irow * data::wordsPerRow + word;
+                    data::validity[index] = validity[index] & columnMask(word);
+                }
+            }
+            data::totalSeats = totalSeats;
+            rebuildAggregates();
+
+            if (!changeListeners.empty()) {
+                Change change;
+                change.kind = SHAPE;
+                change.row = data::totalRows;
+                change.column = data::totalColumns;
+                change.name = describeShape();
+                notifyChange(change);
+            }
+            return OK;
+        });
+    }
 
-        /**
-         * Prompts the user for input and reads a line of text into the provided variable.
-         * 
-         * @param prompt The message displayed to the user before input.
-         * @param var A reference to a string variable where the input will be stored.
-         * 
-         * @returns A boolean indicating whether the input was invalid (empty).
-         */
-        bool getInput(const string prompt, string& var) {
-            cout << " >> " << prompt;
-            getline(cin, var);
-            return var.empty();
+    /**
+     * Writes the sections as one line each, with the first and last row followed by
+     * the name, such as "0 9 Orchestra".
+     */
+    string describeSections() {
+        string text;
+        for (const Section& section : data::sections) {
+            text += to_string(section.firstRow) + " " + to_string(section.lastRow) + " " + section.name + "\n";
         }
+        return text;
     }
-    
-}
 
-namespace display {
-
-    namespace screen {
-        
-        /**
-         * Clears the console screen and moves the cursor to the top left position.
-         * 
-         * This function will work on both Windows and Unix-like systems.
-         */
-        void clear() {
-            #if defined(__LINUX__) || defined(__APPLE__) || defined(__gnu_linux__) || defined(__linux__)
-                cout << "\x1b[2J\x1b[H";
-                // credit: https://stackoverflow.com/a/6487534
-            #else
-                cout << string(100, '\n');
-                // Windows is not a Unix-like system, thus we use a different, less preferable method
-            #endif
-            return;
+    /**
+     * Reads sections in the format written by describeSections().
+     */
+    vector<Section> parseSections(const string& text) {
+        vector<Section> sections;
+        istringstream lines(text);
+        string line;
+        while (getline(lines, line)) {
+            istringstream fields(line);
+            Section section;
+            if (fields >> section.firstRow >> section.lastRow) {
+                getline(fields >> ws, section.name);
+                sections.push_back(section);
+            }
         }
-
-        enum Status {
-            SUCCESS = 1,
-            RETURN = -1,
-            FINISH = 0
-        };
+        return sections;
     }
 
-    namespace components {
-        using namespace utils;
-
-        /**
-         * Builds a header string consisting of a repeated character.
-         *
+    /**
+     * Replaces the sections of the venue.
+     * 
+     * @param sections The sections, each with a name and the first and last rows.
+     * @param requestId The client's ID for the request, or empty for none
+     * 
+     * @returns OK if the sections were set, INVALID_SEAT if a section is not in the
+     *          layout, has no name, or shares a row or its name with another
+     */
+    Result setSections(vector<Section> sections, const string& requestId = "") {
+        return once(requestId, [&] {
+            sort(sections.begin(), sections.end(), [](const Section& a, const Section& b) { return a.firstRow < b.firstRow; });
+            for (size_t isection = 0; isection < sections.size(); isection++) {
+                const Section& section = sections[isection];
+                if (section.name.empty() || section.firstRow < 0 || section.firstRow > section.lastRow || section.lastRow >= data::totalRows) {
+                    return INVALID_SEAT;
+                }
+                if (isection > 0 && sections[isection - 1].lastRow >= section.firstRow) {
+                    return INVALID_SEAT;
+                }
+                for (size_t iother = 0; iother < isection; iother++) {
+                    if (sections[iother].name == section.name) return INVALID_SEAT;
+                }
+            }
+
+            data::sections = move(sections);
+            rebuildSections();
+
+            if (!changeListeners.empty()) {
+                Change change;
+                change.kind = SECTIONS;
+                change.name = describeSections();
+                notifyChange(change);
+            }
+            return OK;
+        });
+    }
+
+    /**
+     * Finds a section by its name.
+     * 
+     * @returns The index of the section in data::sections, or -1 if there is none.
+     */
+    int findSection(const string& name) {
+        for (size_t isection = 0; isection < data::sections.size(); isection++) {
+            if (data::sections[isection].name == name) return (int) isection;
+        }
+        return -1;
+    }
+
+    /**
+     * Gets the number of free seats of a section, in O(1).
+     */
+    int freeSeats(const Section& section) {
+        return section.seats - section.occupied;
+    }
+
+    /**
+     * Gets whether every seat of a section is reserved or held, in O(1).
+     */
+    bool isSoldOut(const Section& section) {
+        return section.occupied == section.seats;
+    }
+
+    struct SeatQuery {
+        bool onlyFree = true;
+        int tier = 0;               // 0 matches any tier
+        int maxPrice = -1;          // negative matches any price
+        int features = 0;           // every SeatFeature flag here must be present
+    };
+
+    /**
+     * Finds the seats that match every predicate of a query. The attribute columns
+     * are compared without branching, 16 seats at a time with SSE2 when available,
+     * and the resulting bits are combined with the validity and occupancy bits by word.
+     * 
+     * @param query The predicates the seats must match.
+     * 
+     * @returns A bitmask of the matching seats, laid out like data::occupancy.
+     */
+    vector<uint64_t> querySeats(const SeatQuery& query) {
+        vector<uint64_t> matches((size_t) data::totalRows * data::wordsPerRow, 0);
+
+        uint8_t anyTier = (query.tier == 0) ? 0xFF : 0;
+        uint8_t tier = (uint8_t) query.tier;
+        int32_t maxPrice = (query.maxPrice < 0) ? INT32_MAX : query.maxPrice;
+        uint8_t required = (uint8_t) query.features;
+
+        #ifdef __SSE2__
+            __m128i anyTierVector = _mm_set1_epi8((char) anyTier);
+            __m128i tierVector = _mm_set1_epi8((char) tier);
+            __m128i maxPriceVector = _mm_set1_epi32(maxPrice);
+            __m128i requiredVector = _mm_set1_epi8((char) required);
+        #endif
+
+        for (int irow = 0; irow < data::totalRows; irow++) {
+            const uint8_t* tiers = data::tiers.data() + (size_t) irow * data::totalColumns;
+            const int32_t* prices = data::prices.data() + (size_t) irow * data::totalColumns;
+            const uint8_t* features = data::features.data() + (size_t) irow * data::totalColumns;
+            uint64_t* words = matches.data() + (size_t) irow * data::wordsPerRow;
+
+            int icol = 0;
+
+            #ifdef __SSE2__
+                for (; icol + 16 <= data::totalColumns; icol += 16) {
+                    __m128i tierMatch = _mm_or_si128(anyTierVector, 
+                        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tiers + icol)), tierVector));
+
+                    __m128i featureMatch = _mm_cmpeq_epi8(
+                        _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(features + icol)), requiredVector), 
+                        requiredVector);
+
+                    // 16 price comparisons, narrowed from 32-bit lanes down to bytes
+                    __m128i priceAbove = _mm_packs_epi16(
+                        _mm_packs_epi32(
+                            _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prices + icol)), maxPriceVector),
+                            _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prices + icol + 4)), maxPriceVector)),
+                        _mm_packs_epi32(
+                            _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prices + icol + 8)), maxPriceVector),
+                            _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prices + icol + 12)), maxPriceVector)));
+
+                    __m128i match = _mm_andnot_si128(priceAbove, _mm_and_si128(tierMatch, featureMatch));
+                    words[icol / 64] |= (uint64_t) (uint16_t) _mm_movemask_epi8(match) << (icol % 64);
+                }
+            #endif
+
+            for (; icol < data::totalColumns; icol++) {
+                uint64_t match = 
+                    (uint64_t) ((anyTier | (tiers[icol] == tier)) & 1)
+                    & (uint64_t) (prices[icol] <= maxPrice)
+                    & (uint64_t) ((features[icol] & required) == required);
+                words[icol / 64] |= match << (icol % 64);
+            }
+
+            for (int word = 0; word < data::wordsPerRow; word++) {
+                words[word] &= seatMask(irow, word);
+            }
+
+            if (query.onlyFree) {
+                const uint64_t* occupied = data::occupancy.data() + (size_t) irow * data::wordsPerRow;
+                for (int word = 0; word < data::wordsPerRow; word++) {
+                    words[word] &= ~occupied[word];
+                }
+            }
+        }
+
+        return matches;
+    }
+
+    /**
+     * Counts the set bits of a bitmask.
+     */
+    size_t countBits(const vector<uint64_t>& bits) {
+        size_t count = 0;
+        for (uint64_t word : bits) {
+            count += bitset<64>(word).count();
+        }
+        return count;
+    }
+
+    enum Metric {
+        STRAIGHT_LINE = 1,      // weighted Euclidean distance
+        WALKING                 // weighted rows plus weighted columns
+    };
+
+    struct NearestParams {
+        int row = 0, column = 0;        // the preferred seat
+        int count = 5;
+        double rowWeight = 1, columnWeight = 1;
+        Metric metric = STRAIGHT_LINE;
+    };
+
+    struct NearSeat {
+        int row, column;
+        double distance;
+    };
+
+    /**
+     * Gets the distance from the preferred seat to a seat that is a number of rows and
+     * columns away under the metric and weights of a search.
+     */
+    double seatDistance(const NearestParams& params, int rows, int columns) {
+        double rowDistance = params.rowWeight * abs(rows);
+        double columnDistance = params.columnWeight * abs(columns);
+        return (params.metric == WALKING) 
+            ? rowDistance + columnDistance 
+            : sqrt(rowDistance * rowDistance + columnDistance * columnDistance);
+    }
+
+    /**
+     * Finds the free seats closest to a preferred seat. The occupancy bits of each row
+     * act as an ordered set of its free seats, so each row gives up its free seats in
+     * order of distance from the preferred column through nextFreeInRow() and
+     * previousFreeInRow(). Rows are opened outwards from the preferred row only while
+     * they could hold a closer seat than the closest one not taken yet.
+     * 
+     * @param params The preferred seat, the number of seats, and the distance metric.
+     * 
+     * @returns Up to params.count free seats, closest first, with ties going to the
+     *          earlier row and then the earlier column.
+     */
+    vector<NearSeat> nearestFreeSeats(const NearestParams& params) {
+        vector<NearSeat> found;
+        if (params.count <= 0 || data::totalRows == 0 || data::totalColumns == 0) return found;
+
+        // A free seat of a row, and the direction the row continues in after it
+        struct Candidate {
+            double distance;
+            int row, column, step;
+            bool operator>(const Candidate& other) const {
+                if (distance != other.distance) return distance > other.distance;
+                if (row != other.row) return row > other.row;
+                return column > other.column;
+            }
+        };
+        priority_queue<Candidate, vector<Candidate>, greater<Candidate>> candidates;
+
+        int column = min(max(params.column, 0), data::totalColumns - 1);
+        int above = min(max(params.row, 0), data::totalRows - 1);
+        int below = above + 1;
+
+        auto push = [&](int irow, int icol, int step) {
+            if (icol >= 0) candidates.push({seatDistance(params, irow - params.row, icol - params.column), irow, icol, step});
+        };
+        auto openRow = [&](int irow) {
+            if (data::rowFirstFree[irow] < 0) return;
+            push(irow, previousFreeInRow(irow, column), -1);
+            push(irow, nextFreeInRow(irow, column + 1), 1);
+        };
+        auto rowBound = [&](int irow) {
+            return seatDistance(params, irow - params.row, 0);
+        };
+
+        while ((int) found.size() < params.count) {
+            bool rowsLeft = above >= 0 || below < data::totalRows;
+            if (!rowsLeft && candidates.empty()) break;
+
+            // Open the nearer of the next rows above and below until no unopened row can beat the best candidate
+            if (rowsLeft) {
+                bool openAbove = above >= 0 && (below >= data::totalRows || rowBound(above) <= rowBound(below));
+                int irow = openAbove ? above : below;
+                if (candidates.empty() || rowBound(irow) <= candidates.top().distance) {
+                    openRow(irow);
+                    if (openAbove) above--; else below++;
+                    continue;
+                }
+            }
+
+            Candidate best = candidates.top();
+            candidates.pop();
+            found.push_back({best.row, best.column, best.distance});
+
+            push(best.row, (best.step < 0) ? previousFreeInRow(best.row, best.column - 1) : nextFreeInRow(best.row, best.column + 1), best.step);
+        }
+
+        return found;
+    }
+}
+
+namespace versions {
+
+    const int tileWidth = 16;       // seats per tile
+    const int blockSize = 64;       // tiles per block
+
+    /**
+     * A copy of up to 16 consecutive seats of one row. A commit copies only the tile
+     * it changed; every other tile is shared with the versions before it.
+     */
+    struct Tile {
+        uint32_t occupancy = 0;
+        seatrs::Seat seats[tileWidth];
+    };
+
+    /**
+     * A fixed group of tiles, so publishing a version copies one block of pointers
+     * and the list of blocks instead of a pointer per tile.
+     */
+    struct TileBlock {
+        const Tile* tiles[blockSize] = {};
+    };
+
+    /**
+     * A consistent view of the whole seat layout as of one commit. Tiles are numbered
+     * row by row, with tilesPerRow tiles in each row.
+     */
+    struct Version {
+        uint64_t number = 0;
+        int totalRows = 0, totalColumns = 0, tilesPerRow = 0;
+        int occupiedSeats = 0;
+        vector<const TileBlock*> blocks;
+
+        const Tile* tile(int irow, int itile) const {
+            size_t index = (size_t) irow * tilesPerRow + itile;
+            return blocks[index / blockSize]->tiles[index % blockSize];
+        }
+
+        bool isReserved(int irow, int icol) const {
+            return (tile(irow, icol / tileWidth)->occupancy >> (icol % tileWidth)) & 1;
+        }
+
+        const seatrs::Seat& seat(int irow, int icol) const {
+            return tile(irow, icol / tileWidth)->seats[icol % tileWidth];
+        }
+
+        /**
+         * Gets the occupancy bits of 64 seats of a row, laid out like seatrs::data::occupancy.
+         */
+        uint64_t occupancyWord(int irow, int word) const {
+            uint64_t bits = 0;
+            int firstTile = word * (64 / tileWidth);
+            for (int itile = firstTile; itile < firstTile + 64 / tileWidth && itile < tilesPerRow; itile++) {
+                bits |= (uint64_t) tile(irow, itile)->occupancy << ((itile - firstTile) * tileWidth);
+            }
+            return bits;
+        }
+    };
+
+    /**
+     * A version replaced by a newer one, with the blocks and tiles only it referenced.
+     * It is freed once no reader pinned before it was replaced is still reading.
+     */
+    struct Retired {
+        uint64_t epoch;
+        const Version* version;
+        vector<const TileBlock*> blocks;
+        vector<const Tile*> tiles;
+    };
+
+    const int maxReaders = 64;
+
+    namespace data {
+        atomic<const Version*> current{nullptr};
+        atomic<uint64_t> globalEpoch{1};
+        atomic<uint64_t> readerEpochs[maxReaders];     // the epoch each reader pinned at, 0 if unused
+        deque<Retired> retired;                         // oldest first, only touched by the writer
+        bool enabled = false;
+        bool listening = false;
+
+        uint64_t published = 0, reclaimed = 0;
+        size_t mostRetained = 0;
+    }
+
+    /**
+     * Copies a tile of the live seat layout into a new tile.
+     */
+    const Tile* copyTile(int irow, int itile) {
+        Tile* tile = new Tile();
+        int first = itile * tileWidth;
+        int last = min(first + tileWidth, seatrs::data::totalColumns);
+        for (int icol = first; icol < last; icol++) {
+            tile->seats[icol - first] = seatrs::data::seats[irow][icol];
+            if (seatrs::isOccupied(irow, icol)) tile->occupancy |= 1u << (icol - first);
+        }
+        return tile;
+    }
+
+    /**
+     * Builds a version of the whole live seat layout, with every tile copied.
+     */
+    Version* copyLayout() {
+        Version* version = new Version();
+        version->totalRows = seatrs::data::totalRows;
+        version->totalColumns = seatrs::data::totalColumns;
+        version->tilesPerRow = (seatrs::data::totalColumns + tileWidth - 1) / tileWidth;
+        version->occupiedSeats = seatrs::data::totalOccupiedSeats;
+
+        size_t tiles = (size_t) version->totalRows * version->tilesPerRow;
+        for (size_t index = 0; index < tiles; index += blockSize) {
+            TileBlock* block = new TileBlock();
+            for (size_t i = index; i < tiles && i < index + blockSize; i++) {
+                block->tiles[i - index] = copyTile((int) (i / version->tilesPerRow), (int) (i % version->tilesPerRow));
+            }
+            version->blocks.push_back(block);
+        }
+        return version;
+    }
+
+    /**
+     * Frees a version along with all of its blocks and tiles.
+     */
+    void freeLayout(const Version* version) {
+        for (const TileBlock* block : version->blocks) {
+            for (const Tile* tile : block->tiles) delete tile;
+            delete block;
+        }
+        delete version;
+    }
+
+    /**
+     * Frees the retired versions that no pinned reader can still be reading: those
+     * retired before the oldest epoch any reader pinned at.
+     */
+    void reclaim() {
+        uint64_t oldestPinned = UINT64_MAX;
+        for (int slot = 0; slot < maxReaders; slot++) {
+            uint64_t epoch = data::readerEpochs[slot].load();
+            if (epoch != 0) oldestPinned = min(oldestPinned, epoch);
+        }
+
+        while (!data::retired.empty() && data::retired.front().epoch < oldestPinned) {
+            Retired& oldest = data::retired.front();
+            for (const Tile* tile : oldest.tiles) delete tile;
+            for (const TileBlock* block : oldest.blocks) delete block;
+            delete oldest.version;
+            data::retired.pop_front();
+            data::reclaimed++;
+        }
+    }
+
+    /**
+     * Publishes a new version after a committed change, copying only the tile and the
+     * block of tile pointers it changed, and retires the version it replaces. Versions
+     * hold only the reservations, so attribute, shape and section changes publish none;
+     * readers get those from the live layout.
+     */
+    void commit(const seatrs::Change& change) {
+        if (!data::enabled || change.kind == seatrs::ATTRIBUTES || change.kind == seatrs::SHAPE || change.kind == seatrs::SECTIONS) return;
+
+        const Version* previous = data::current.load();
+        Version* next;
+        Retired retired = {0, previous, {}, {}};
+
+        if (change.kind == seatrs::RESIZE) {
+            next = copyLayout();
+            for (const TileBlock* block : previous->blocks) {
+                retired.blocks.push_back(block);
+                for (const Tile* tile : block->tiles) {
+                    if (tile) retired.tiles.push_back(tile);
+                }
+            }
+        } else {
+            next = new Version(*previous);
+            next->occupiedSeats = seatrs::data::totalOccupiedSeats;
+
+            int itile = change.column / tileWidth;
+            size_t index = (size_t) change.row * next->tilesPerRow + itile;
+            const TileBlock* oldBlock = previous->blocks[index / blockSize];
+            TileBlock* block = new TileBlock(*oldBlock);
+            retired.tiles.push_back(block->tiles[index % blockSize]);
+            retired.blocks.push_back(oldBlock);
+
+            block->tiles[index % blockSize] = copyTile(change.row, itile);
+            next->blocks[index / blockSize] = block;
+        }
+        next->number = previous->number + 1;
+
+        // Readers that pin after the epoch moves on can only see the new version
+        data::current.store(next);
+        retired.epoch = data::globalEpoch.fetch_add(1);
+        data::retired.push_back(move(retired));
+        data::published++;
+        data::mostRetained = max(data::mostRetained, data::retired.size());
+
+        reclaim();
+    }
+
+    /**
+     * Starts publishing a version of the seat layout after every committed change.
+     * Versions must only be published from the thread that changes the seats. Only
+     * needed when other threads read the seats, which the program itself never does.
+     */
+    void enable() {
+        if (data::enabled) return;
+
+        if (!data::listening) {
+            seatrs::changeListeners.push_back(commit);
+            data::listening = true;
+        }
+
+        Version* first = copyLayout();
+        first->number = 1;
+        data::current.store(first);
+        data::enabled = true;
+    }
+
+    /**
+     * Stops publishing versions and frees every version. No reader may be pinned.
+     */
+    void disable() {
+        if (!data::enabled) return;
+        data::enabled = false;
+
+        reclaim();
+        freeLayout(data::current.exchange(nullptr));
+    }
+
+    /**
+     * Checks if versions of the seat layout are being published.
+     */
+    bool enabled() {
+        return data::current.load() != nullptr;
+    }
+
+    /**
+     * A version pinned by a reader, which stays valid until it is unpinned.
+     */
+    struct Pin {
+        int slot = -1;
+        const Version* version = nullptr;
+    };
+
+    /**
+     * Pins the latest version for reading, from any thread. Writers keep committing
+     * while it is pinned, and it is not freed until unpinned.
+     *
+     * @returns The pinned version, or a Pin without a version if versions are not published.
+     */
+    Pin pin() {
+        Pin pinned;
+        if (!enabled()) return pinned;
+
+        while (true) {
+            for (int slot = 0; slot < maxReaders; slot++) {
+                uint64_t unused = 0;
+                if (data::readerEpochs[slot].compare_exchange_strong(unused, data::globalEpoch.load())) {
+                    pinned.slot = slot;
+                    pinned.version = data::current.load();
+                    return pinned;
+                }
+            }
+            // every slot is taken, so wait for a reader to finish
+            this_thread::yield();
+        }
+    }
+
+    /**
+     * Releases a pinned version.
+     */
+    void unpin(Pin& pinned) {
+        if (pinned.slot >= 0) data::readerEpochs[pinned.slot].store(0);
+        pinned.slot = -1;
+        pinned.version = nullptr;
+    }
+}
+
+namespace waitlists {
+
+    const int maxPartySize = 8;
+
+    /**
+     * A party waiting for a number of adjacent seats.
+     */
+    struct Party {
+        uint64_t id;
+        string name, description;
+        int size;
+        int priority;           // higher priorities are seated first
+        uint64_t arrival;       // earlier arrivals are seated first within a priority
+    };
+
+    /**
+     * Orders parties for a max-heap, putting the party to seat next on top.
+     */
+    struct PartyOrder {
+        bool operator()(const Party& a, const Party& b) const {
+            if (a.priority != b.priority) return a.priority < b.priority;
+            return a.arrival > b.arrival;
+        }
+    };
+
+    /**
+     * The parties waiting for seats in a range of rows, in one queue per party size
+     * so a freed run of seats only has to look at the heads of the sizes that fit.
+     */
+    struct Waitlist {
+        int firstRow, lastRow;
+        priority_queue<Party, vector<Party>, PartyOrder> bySize[maxPartySize + 1];
+        size_t waiting = 0;
+    };
+
+    /**
+     * Where a party was seated.
+     */
+    struct Seating {
+        bool seated = false;
+        int row = -1, firstColumn = -1, lastColumn = -1;
+    };
+
+    namespace data {
+        vector<Waitlist> waitlists;
+        uint64_t arrivals = 0;
+        bool listening = false;
+
+        // The parties seated by the most recent cancellation, resize or reshape
+        vector<pair<Party, Seating>> lastPromotions;
+        size_t promoted = 0;
+    }
+
+    /**
+     * Reserves a run of adjacent seats for a party as a whole, so a party is never
+     * left with only some of its seats.
+     *
+     * @returns OK if every seat was reserved, as seatrs::reserveSeats().
+     */
+    seatrs::Result seatParty(const Party& party, int irow, int firstColumn) {
+        vector<seatrs::SeatReservation> reservations;
+        for (int icol = firstColumn; icol < firstColumn + party.size; icol++) {
+            reservations.push_back({irow, icol, party.name, party.description});
+        }
+        return seatrs::reserveSeats(reservations);
+    }
+
+    /**
+     * Finds the first run of adjacent free seats in a range of rows that fits a party.
+     */
+    Seating findRun(int firstRow, int lastRow, int size) {
+        Seating found;
+        for (int irow = firstRow; irow <= lastRow; irow++) {
+            if (seatrs::data::rowFirstFree[irow] < 0) continue;
+
+            int icol = seatrs::data::rowFirstFree[irow];
+            while (icol >= 0) {
+                int end = seatrs::nextUnavailableInRow(irow, icol);
+                if (end - icol >= size) {
+                    found.seated = true;
+                    found.row = irow;
+                    found.firstColumn = icol;
+                    found.lastColumn = icol + size - 1;
+                    return found;
+                }
+                icol = seatrs::nextFreeInRow(irow, end);
+            }
+        }
+        return found;
+    }
+
+    /**
+     * Seats the first eligible waiting party in the run of free seats around a seat
+     * that was just cancelled. The rest of the run was free before and did not fit
+     * anyone, as new free runs from a resize or reshape are offered by promoteAll(),
+     * so only a party that uses the freed seat can fit. The party stays queued if
+     * its seats cannot be reserved.
+     *
+     * Takes O(waitlists) to find the waitlists of the row, and O(log parties) to take
+     * the party from its queue.
+     */
+    void promote(int irow, int icol) {
+        int runStart = seatrs::previousUnavailableInRow(irow, icol) + 1;
+        int runEnd = seatrs::nextUnavailableInRow(irow, icol) - 1;
+        int fits = min(runEnd - runStart + 1, maxPartySize);
+
+        Waitlist* from = nullptr;
+        int size = 0;
+        PartyOrder order;
+        for (Waitlist& waitlist : data::waitlists) {
+            if (irow < waitlist.firstRow || irow > waitlist.lastRow || waitlist.waiting == 0) continue;
+            for (int isize = 1; isize <= fits; isize++) {
+                if (waitlist.bySize[isize].empty()) continue;
+                if (from == nullptr || order(from->bySize[size].top(), waitlist.bySize[isize].top())) {
+                    from = &waitlist;
+                    size = isize;
+                }
+            }
+        }
+        if (from == nullptr) return;
+
+        // Keep the party on the freed seat, as close to the start of the run as possible
+        Party party = from->bySize[size].top();
+        Seating seating;
+        seating.seated = true;
+        seating.row = irow;
+        seating.firstColumn = max(runStart, icol - size + 1);
+        seating.lastColumn = seating.firstColumn + size - 1;
+
+        if (seatParty(party, irow, seating.firstColumn) != seatrs::OK) return;
+
+        from->bySize[size].pop();
+        from->waiting--;
+        data::lastPromotions.push_back({party, seating});
+        data::promoted++;
+    }
+
+    /**
+     * Seats waiting parties anywhere in their rows, best party first, until no head
+     * of a queue fits. Used after a resize or reshape, which can open free runs away
+     * from any cancelled seat.
+     *
+     * Each party seated takes O(waitlists * maxPartySize) searches with findRun().
+     */
+    void promoteAll() {
+        PartyOrder order;
+        while (true) {
+            Waitlist* from = nullptr;
+            int size = 0;
+            Seating seating;
+            for (Waitlist& waitlist : data::waitlists) {
+                if (waitlist.waiting == 0) continue;
+                for (int isize = 1; isize <= maxPartySize; isize++) {
+                    if (waitlist.bySize[isize].empty()) continue;
+                    if (from != nullptr && !order(from->bySize[size].top(), waitlist.bySize[isize].top())) continue;
+
+                    Seating found = findRun(waitlist.firstRow, waitlist.lastRow, isize);
+                    if (!found.seated) break;     // larger parties do not fit either
+                    from = &waitlist;
+                    size = isize;
+                    seating = found;
+                }
+            }
+            if (from == nullptr) return;
+
+            Party party = from->bySize[size].top();
+            if (seatParty(party, seating.row, seating.firstColumn) != seatrs::OK) return;
+
+            from->bySize[size].pop();
+            from->waiting--;
+            data::lastPromotions.push_back({party, seating});
+            data::promoted++;
+        }
+    }
+
+
+    /**
+     * Drops the waitlists of rows that no longer exist after the layout was resized.
+     */
+    void clampToLayout() {
+        vector<Waitlist> kept;
+        for (Waitlist& waitlist : data::waitlists) {
+            if (waitlist.firstRow >= seatrs::data::totalRows) continue;
+            waitlist.lastRow = min(waitlist.lastRow, seatrs::data::totalRows - 1);
+            kept.push_back(move(waitlist));
+        }
+        data::waitlists = move(kept);
+    }
+
+    /**
+     * Promotes a waiting party after every cancellation, keeps the waitlists inside
+     * the layout after it is resized, and seats the parties that fit in the layout
+     * after it is resized or reshaped.
+     */
+    void onChange(const seatrs::Change& change) {
+        if (change.kind == seatrs::CANCEL) promote(change.row, change.column);
+        if (change.kind == seatrs::RESIZE) clampToLayout();
+        if (change.kind == seatrs::RESIZE || change.kind == seatrs::SHAPE) promoteAll();
+    }
+
+    /**
+     * Adds a party to the waitlist of a range of rows, or seats it right away if the
+     * range has enough adjacent free seats.
+     *
+     * @param firstRow The first row of the range
+     * @param lastRow The last row of the range
+     * @param size The number of adjacent seats the party needs, up to maxPartySize
+     * @param priority The priority of the party, higher is seated first
+     * @param name The name the seats are reserved under
+     * @param description The description of the reservations
+     *
+     * @returns Where the party was seated, or a Seating that is not seated if it is waiting.
+     */
+    Seating join(int firstRow, int lastRow, int size, int priority, const string& name, const string& description) {
+        Seating seating = findRun(firstRow, lastRow, size);
+        if (seating.seated) {
+            Party party = {0, name, description, size, priority, 0};
+            if (seatParty(party, seating.row, seating.firstColumn) == seatrs::OK) {
+                return seating;
+            }
+            seating = Seating();
+        }
+
+        if (!data::listening) {
+            seatrs::changeListeners.push_back(onChange);
+            data::listening = true;
+        }
+
+        Waitlist* waitlist = nullptr;
+        for (Waitlist& existing : data::waitlists) {
+            if (existing.firstRow == firstRow && existing.lastRow == lastRow) waitlist = &existing;
+        }
+        if (waitlist == nullptr) {
+            data::waitlists.emplace_back();
+            waitlist = &data::waitlists.back();
+            waitlist->firstRow = firstRow;
+            waitlist->lastRow = lastRow;
+        }
+
+        data::arrivals++;
+        waitlist->bySize[size].push({data::arrivals, name, description, size, priority, data::arrivals});
+        waitlist->waiting++;
+        return seating;
+    }
+
+    /**
+     * Counts the parties waiting in every waitlist.
+     */
+    size_t totalWaiting() {
+        size_t total = 0;
+        for (const Waitlist& waitlist : data::waitlists) total += waitlist.waiting;
+        return total;
+    }
+}
+
+namespace showtimes {
+
+    /**
+     * A reservation of one seat for a span of time, in minutes from midnight, from
+     * start up to but not including end.
+     */
+    struct Booking {
+        int start, end;
+        string name, description;
+    };
+
+    /**
+     * A showing in the hall, with the seats booked at any time during it.
+     */
+    struct Show {
+        int start, end;
+        string title;
+        vector<uint64_t> occupancy;     // laid out like seatrs::data::occupancy
+        int occupied = 0;
+    };
+
+    namespace data {
+        // The bookings of every seat that has any, sorted by start and never overlapping
+        unordered_map<uint64_t, vector<Booking>> bookings;
+
+        // Sorted by start
+        vector<Show> shows;
+        bool listening = false;
+    }
+
+    uint64_t seatKey(int irow, int icol) {
+        return ((uint64_t) irow << 32) | (uint32_t) icol;
+    }
+
+    /**
+     * Reads a time of day written as HH:MM, from 00:00 to 24:00.
+     *
+     * @returns The minutes from midnight, or -1 if the text is not a time.
+     */
+    int parseTime(const string& text) {
+        int hours = 0, minutes = 0;
+        size_t colon = text.find(':');
+        if (colon == string::npos) return -1;
+
+        const char* end = text.data() + text.size();
+        if (from_chars(text.data(), text.data() + colon, hours).ptr != text.data() + colon) return -1;
+        if (colon + 3 != text.size() || from_chars(text.data() + colon + 1, end, minutes).ptr != end) return -1;
+        if (hours < 0 || minutes < 0 || minutes > 59 || hours * 60 + minutes > 24 * 60) return -1;
+        return hours * 60 + minutes;
+    }
+
+    /**
+     * Writes minutes from midnight as HH:MM.
+     */
+    string formatTime(int minutes) {
+        char text[6] = {
+            (char) ('0' + minutes / 600), (char) ('0' + minutes / 60 % 10), ':',
+            (char) ('0' + minutes % 60 / 10), (char) ('0' + minutes % 10), '\0'
+        };
+        return text;
+    }
+
+    /**
+     * Finds the first booking of a seat that ends after a given time, the only one
+     * that can overlap a span starting then, by binary search.
+     */
+    vector<Booking>::const_iterator firstEndingAfter(const vector<Booking>& bookings, int time) {
+        return upper_bound(bookings.begin(), bookings.end(), time, [](int value, const Booking& booking) {
+            return value < booking.end;
+        });
+    }
+
+    /**
+     * Checks if a seat is free for the whole of a span of time, in O(log bookings).
+     *
+     * @param irow The row of the seat
+     * @param icol The column of the seat
+     * @param start The start of the span, in minutes from midnight
+     * @param end The end of the span, not included
+     */
+    bool isFree(int irow, int icol, int start, int end) {
+        auto found = data::bookings.find(seatKey(irow, icol));
+        if (found == data::bookings.end()) return true;
+
+        auto next = firstEndingAfter(found->second, start);
+        return next == found->second.end() || next->start >= end;
+    }
+
+    /**
+     * Finds the seats free for the whole of a span of time. Only the seats with
+     * bookings are looked at.
+     *
+     * @returns A bitmask of the free seats, laid out like seatrs::data::occupancy.
+     */
+    vector<uint64_t> freeSeats(int start, int end) {
+        vector<uint64_t> free = seatrs::data::validity;
+        for (const pair<const uint64_t, vector<Booking>>& seat : data::bookings) {
+            int irow = (int) (seat.first >> 32), icol = (int) (uint32_t) seat.first;
+            if (seatrs::isValidSeat(irow, icol) && !isFree(irow, icol, start, end)) {
+                free[(size_t) irow * seatrs::data::wordsPerRow + icol / 64] &= ~(1ULL << (icol % 64));
+            }
+        }
+        return free;
+    }
+
+    /**
+     * Recomputes the bit of one seat in the occupancy of every show that overlaps a
+     * span of time.
+     */
+    void refreshShows(int irow, int icol, int start, int end) {
+        if (!seatrs::isValidSeat(irow, icol)) return;
+
+        size_t index = (size_t) irow * seatrs::data::wordsPerRow + icol / 64;
+        uint64_t bit = 1ULL << (icol % 64);
+
+        for (Show& show : data::shows) {
+            if (show.start >= end || show.end <= start) continue;
+
+            bool booked = !isFree(irow, icol, show.start, show.end);
+            if (booked != (bool) (show.occupancy[index] & bit)) {
+                show.occupancy[index] ^= bit;
+                show.occupied += booked ? 1 : -1;
+            }
+        }
+    }
+
+    /**
+     * Recomputes the occupancy of a show from the bookings.
+     */
+    void rebuildShow(Show& show) {
+        show.occupancy = freeSeats(show.start, show.end);
+        show.occupied = 0;
+        for (size_t word = 0; word < show.occupancy.size(); word++) {
+            show.occupancy[word] = ~show.occupancy[word] & seatrs::data::validity[word];
+            show.occupied += (int) bitset<64>(show.occupancy[word]).count();
+        }
+    }
+
+    /**
+     * Drops the bookings of seats that no longer exist after the layout was resized or
+     * reshaped, and recomputes the occupancy of every show.
+     */
+    void onChange(const seatrs::Change& change) {
+        if (change.kind != seatrs::RESIZE && change.kind != seatrs::SHAPE) return;
+
+        for (auto seat = data::bookings.begin(); seat != data::bookings.end();) {
+            if (!seatrs::isValidSeat((int) (seat->first >> 32), (int) (uint32_t) seat->first)) {
+                seat = data::bookings.erase(seat);
+            } else {
+                ++seat;
+            }
+        }
+        for (Show& show : data::shows) rebuildShow(show);
+    }
+
+    /**
+     * Registers onChange() the first time a show or a booking is added, so bookings
+     * made before any show still follow the layout.
+     */
+    void listen() {
+        if (!data::listening) {
+            seatrs::changeListeners.push_back(onChange);
+            data::listening = true;
+        }
+    }
+
+    /**
+     * Adds a showing, keeping the shows sorted by start.
+     *
+     * @returns The index of the show, or -1 if the times are not a span.
+     */
+    int addShow(int start, int end, const string& title) {
+        if (start < 0 || end <= start || end > 24 * 60) return -1;
+
+        listen();
+
+        Show show;
+        show.start = start;
+        show.end = end;
+        show.title = title;
+        rebuildShow(show);
+
+        auto position = upper_bound(data::shows.begin(), data::shows.end(), start, [](int value, const Show& other) {
+            return value < other.start;
+        });
+        return (int) (data::shows.insert(position, move(show)) - data::shows.begin());
+    }
+
+    /**
+     * Books a seat for a span of time.
+     *
+     * @param irow The row of the seat
+     * @param icol The column of the seat
+     * @param start The start of the span, in minutes from midnight
+     * @param end The end of the span, not included
+     * @param name The name the seat is booked under
+     * @param description The description of the booking
+     * @param requestId The client's ID for the request, or empty for none
+     *
+     * @returns OK if the seat was booked, INVALID_SEAT if the seat or the span is not
+     *          valid, or ALREADY_RESERVED if the seat is booked during the span.
+     */
+    seatrs::Result book(int irow, int icol, int start, int end, const string& name, const string& description, const string& requestId = "") {
+        return seatrs::once(requestId, [&] {
+            if (!seatrs::isValidSeat(irow, icol) || start < 0 || end <= start || end > 24 * 60) {
+                return seatrs::INVALID_SEAT;
+            }
+            if (!isFree(irow, icol, start, end)) {
+                return seatrs::ALREADY_RESERVED;
+            }
+
+            listen();
+            vector<Booking>& bookings = data::bookings[seatKey(irow, icol)];
+            bookings.insert(firstEndingAfter(bookings, start), {start, end, name, description});
+            refreshShows(irow, icol, start, end);
+            return seatrs::OK;
+        });
+    }
+
+    /**
+     * Cancels the booking of a seat that covers a given time.
+     *
+     * @returns OK if a booking was cancelled, INVALID_SEAT or NOT_RESERVED otherwise.
+     */
+    seatrs::Result cancelBooking(int irow, int icol, int time, const string& requestId = "") {
+        return seatrs::once(requestId, [&] {
+            if (!seatrs::isValidSeat(irow, icol)) {
+                return seatrs::INVALID_SEAT;
+            }
+
+            auto found = data::bookings.find(seatKey(irow, icol));
+            if (found == data::bookings.end()) return seatrs::NOT_RESERVED;
+
+            vector<Booking>& bookings = found->second;
+            auto booking = firstEndingAfter(bookings, time);
+            if (booking == bookings.end() || booking->start > time) return seatrs::NOT_RESERVED;
+
+            int start = booking->start, end = booking->end;
+            bookings.erase(booking);
+            if (bookings.empty()) data::bookings.erase(found);
+
+            refreshShows(irow, icol, start, end);
+            return seatrs::OK;
+        });
+    }
+}
+
+namespace shared {
+
+    const uint64_t magic = 0x5345415452534D32ULL;     // "SEATRSM2"
+    const int stripeCount = 64;
+    const int nameCapacity = 60;
+    const int descriptionCapacity = 128;
+
+    /**
+     * One seat in the shared segment. The stamp changes on every write, so other
+     * processes can find the seats that changed since they last looked.
+     */
+    struct SharedSeat {
+        atomic<uint32_t> stamp;
+        bool held;                          // taken by a hold rather than a reservation
+        char name[nameCapacity];
+        char description[descriptionCapacity];
+    };
+
+    /**
+     * The start of the shared segment. Everything else is found by offsets from the
+     * start, never by pointers, so every process may map the segment at a different
+     * address.
+     */
+    struct Header {
+        atomic<uint64_t> magic;             // set last by the process that creates the segment
+        int32_t rows, columns, wordsPerRow;
+        uint64_t occupancyOffset, seatsOffset, size;
+        atomic<uint64_t> generation;        // moves on with every change
+        atomic<int32_t> occupiedSeats;
+        #ifdef UNIX_LIKE
+            pthread_mutex_t stripes[stripeCount];     // robust and process-shared, one per group of rows
+        #endif
+    };
+
+    static_assert(atomic<uint64_t>::is_always_lock_free, "the occupancy words must be lock-free to be shared between processes");
+
+    namespace data {
+        Header* header = nullptr;
+        string name;
+
+        // The stamp of each seat when this process last copied it into seatrs
+        vector<uint32_t> stamps;
+        uint64_t pulledGeneration = 0;
+
+        // The change being copied from the segment into seatrs, which must not be written back
+        seatrs::ChangeKind pullingKind = seatrs::RESERVE;
+        long long pullingSeat = -1;
+
+        // The confirmed hold already written by commitSeat(), which must not be written again
+        long long committedSeat = -1;
+
+        bool listening = false;
+        atomic<uint64_t> conflicts{0};      // claims lost to another process
+    }
+
+    atomic<uint64_t>* occupancyWords(Header* header) {
+        return reinterpret_cast<atomic<uint64_t>*>(reinterpret_cast<char*>(header) + header->occupancyOffset);
+    }
+
+    SharedSeat* sharedSeats(Header* header) {
+        return reinterpret_cast<SharedSeat*>(reinterpret_cast<char*>(header) + header->seatsOffset);
+    }
+
+    bool attached() {
+        return data::header != nullptr;
+    }
+
+    #ifdef UNIX_LIKE
+        /**
+         * Locks the stripe of a row. If the process holding it died, the lock is taken
+         * over and marked consistent, since a seat is at worst left with torn text.
+         */
+        void lockStripe(Header* header, int irow) {
+            pthread_mutex_t* stripe = &header->stripes[irow % stripeCount];
+            if (pthread_mutex_lock(stripe) == EOWNERDEAD) {
+                pthread_mutex_consistent(stripe);
+            }
+        }
+
+        void unlockStripe(Header* header, int irow) {
+            pthread_mutex_unlock(&header->stripes[irow % stripeCount]);
+        }
+    #endif
+
+    /**
+     * Claims a free seat of the segment with one atomic operation, without a lock.
+     *
+     * @returns true if this process took the seat, false if it was already taken.
+     */
+    bool claim(Header* header, int irow, int icol) {
+        uint64_t bit = 1ULL << (icol % 64);
+        uint64_t before = occupancyWords(header)[(size_t) irow * header->wordsPerRow + icol / 64].fetch_or(bit);
+        if (before & bit) return false;
+
+        header->occupiedSeats.fetch_add(1);
+        return true;
+    }
+
+    /**
+     * Writes the text of a seat of the segment and whether it is held, or frees it if
+     * cancelling. The lock of the stripe of the seat must be held.
+     *
+     * @returns The new stamp of the seat.
+     */
+    uint32_t writeSeat(Header* header, int irow, int icol, bool cancel, bool held, const string& name, const string& description) {
+        SharedSeat& seat = sharedSeats(header)[(size_t) irow * header->columns + icol];
+        seat.held = held && !cancel;
+        if (cancel) {
+            uint64_t bit = 1ULL << (icol % 64);
+            uint64_t before = occupancyWords(header)[(size_t) irow * header->wordsPerRow + icol / 64].fetch_and(~bit);
+            if (before & bit) header->occupiedSeats.fetch_sub(1);
+        }
+        strncpy(seat.name, cancel ? "" : name.c_str(), nameCapacity - 1);
+        seat.name[nameCapacity - 1] = '\0';
+        strncpy(seat.description, cancel ? "" : description.c_str(), descriptionCapacity - 1);
+        seat.description[descriptionCapacity - 1] = '\0';
+        return seat.stamp.fetch_add(1) + 1;
+    }
+
+    /**
+     * Writes the text of a seat of the segment, and whether it is held, under the lock
+     * of its stripe.
+     *
+     * @returns The new stamp of the seat.
+     */
+    uint32_t storeSeat(Header* header, int irow, int icol, bool held, const string& name, const string& description) {
+        uint32_t stamp = 0;
+        #ifdef UNIX_LIKE
+            lockStripe(header, irow);
+            stamp = writeSeat(header, irow, icol, false, held, name, description);
+            unlockStripe(header, irow);
+            header->generation.fetch_add(1);
+        #endif
+        return stamp;
+    }
+
+    /**
+     * Frees a seat of the segment and clears its text.
+     *
+     * @returns The new stamp of the seat.
+     */
+    uint32_t release(Header* header, int irow, int icol) {
+        uint32_t stamp = 0;
+        #ifdef UNIX_LIKE
+            lockStripe(header, irow);
+            stamp = writeSeat(header, irow, icol, true, false, "", "");
+            unlockStripe(header, irow);
+            header->generation.fetch_add(1);
+        #endif
+        return stamp;
+    }
+
+    /**
+     * Updates, frees or confirms the hold of a seat of the segment, but only if nobody
+     * changed it since this process last saw it, so a booking made by another process
+     * is never overwritten. An update keeps a hold a hold.
+     *
+     * @param seen The stamp of the seat when this process last saw it.
+     * @param stamp Set to the new stamp of the seat.
+     *
+     * @returns true if the change was written, false if the seat had changed.
+     */
+    bool commitChange(Header* header, const seatrs::Change& change, uint32_t seen, uint32_t& stamp) {
+        bool unchanged = true;
+        #ifdef UNIX_LIKE
+            SharedSeat& seat = sharedSeats(header)[(size_t) change.row * header->columns + change.column];
+            lockStripe(header, change.row);
+            unchanged = seat.stamp.load() == seen;
+            bool held = (change.kind == seatrs::UPDATE) && seat.held;
+            if (unchanged) stamp = writeSeat(header, change.row, change.column, change.kind == seatrs::CANCEL, held, change.name, change.description);
+            unlockStripe(header, change.row);
+            if (unchanged) header->generation.fetch_add(1);
+        #endif
+        return unchanged;
+    }
+
+    /**
+     * Maps a shared segment, creating it with the given size if it does not exist.
+     *
+     * @param name The name of the segment, such as /venue.
+     * @param rows The number of rows of a new segment.
+     * @param columns The number of columns of a new segment.
+     * @param created Set to whether this process created the segment.
+     * @param errorMessage Set if the segment could not be mapped.
+     *
+     * @returns The mapped segment, or nullptr.
+     */
+    Header* mapSegment(const string& name, int rows, int columns, bool& created, string& errorMessage) {
+        #ifdef UNIX_LIKE
+            int wordsPerRow = (columns + 63) / 64;
+            size_t occupancyOffset = (sizeof(Header) + 63) / 64 * 64;
+            size_t seatsOffset = occupancyOffset + (size_t) rows * wordsPerRow * sizeof(uint64_t);
+            size_t size = seatsOffset + (size_t) rows * columns * sizeof(SharedSeat);
+
+            int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            created = fd >= 0;
+            if (!created) fd = shm_open(name.c_str(), O_RDWR, 0600);
+            if (fd < 0) {
+                errorMessage = "Unable to open the shared segment \"" + name + "\".";
+                return nullptr;
+            }
+
+            if (created) {
+                if (ftruncate(fd, (off_t) size) != 0) {
+                    close(fd);
+                    shm_unlink(name.c_str());
+                    errorMessage = "Unable to size the shared segment \"" + name + "\".";
+                    return nullptr;
+                }
+            } else {
+                // wait for the creator to size it, then map all of it
+                struct stat status;
+                for (int tries = 0; fstat(fd, &status) == 0 && (size_t) status.st_size < sizeof(Header) && tries < 1000; tries++) {
+                    this_thread::sleep_for(chrono::milliseconds(1));
+                }
+                size = (fstat(fd, &status) == 0) ? (size_t) status.st_size : 0;
+            }
+
+            void* mapped = (size >= sizeof(Header)) ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+            close(fd);
+            if (mapped == MAP_FAILED) {
+                errorMessage = "Unable to map the shared segment \"" + name + "\".";
+                return nullptr;
+            }
+            Header* header = static_cast<Header*>(mapped);
+
+            if (created) {
+                header->rows = rows;
+                header->columns = columns;
+                header->wordsPerRow = wordsPerRow;
+                header->occupancyOffset = occupancyOffset;
+                header->seatsOffset = seatsOffset;
+                header->size = size;
+
+                pthread_mutexattr_t attributes;
+                pthread_mutexattr_init(&attributes);
+                pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+                pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+                for (pthread_mutex_t& stripe : header->stripes) pthread_mutex_init(&stripe, &attributes);
+                pthread_mutexattr_destroy(&attributes);
+
+                header->magic.store(magic);
+            } else {
+                for (int tries = 0; header->magic.load() != magic && tries < 1000; tries++) {
+                    this_thread::sleep_for(chrono::milliseconds(1));
+                }
+                if (header->magic.load() != magic || header->size != size) {
+                    munmap(mapped, size);
+                    errorMessage = "The shared segment \"" + name + "\" is not a seat map.";
+                    return nullptr;
+                }
+            }
+            return header;
+        #else
+            errorMessage = "Shared seat maps need a Unix-like system.";
+            return nullptr;
+        #endif
+    }
+
+    /**
+     * Unmaps a shared segment, and removes its name if asked to.
+     */
+    void unmapSegment(Header* header, const string& name, bool unlink) {
+        #ifdef UNIX_LIKE
+            munmap(header, header->size);
+            if (unlink) shm_unlink(name.c_str());
+        #endif
+    }
+
+    /**
+     * Copies the seats that other processes changed into seatrs. Costs one atomic load
+     * when nothing changed, and a pass over the seat stamps otherwise.
+     */
+    void pull() {
+        Header* header = data::header;
+        if (header == nullptr) return;
+
+        uint64_t generation = header->generation.load();
+        if (generation == data::pulledGeneration) return;
+        data::pulledGeneration = generation;
+
+        #ifdef UNIX_LIKE
+            SharedSeat* seats = sharedSeats(header);
+            atomic<uint64_t>* words = occupancyWords(header);
+
+            for (int irow = 0; irow < header->rows; irow++) {
+                for (int icol = 0; icol < header->columns; icol++) {
+                    size_t index = (size_t) irow * header->columns + icol;
+                    if (seats[index].stamp.load(memory_order_relaxed) == data::stamps[index]) continue;
+
+                    lockStripe(header, irow);
+                    bool reserved = (words[(size_t) irow * header->wordsPerRow + icol / 64].load() >> (icol % 64)) & 1;
+                    bool held = seats[index].held;
+                    string name = seats[index].name, description = seats[index].description;
+                    data::stamps[index] = seats[index].stamp.load();
+                    unlockStripe(header, irow);
+
+                    const seatrs::Seat& local = seatrs::data::seats[irow][icol];
+                    data::pullingSeat = (long long) index;
+                    if (reserved && local.isReserved && held && !local.isHeld) {
+                        // cancelled and held again since the last pull
+                        data::pullingKind = seatrs::CANCEL;
+                        seatrs::cancelSeat(irow, icol);
+                    }
+                    if (reserved && !local.isReserved) {
+                        data::pullingKind = held ? seatrs::HOLD : seatrs::RESERVE;
+                        if (held) {
+                            seatrs::holdSeat(irow, icol, name, description);
+                        } else {
+                            seatrs::reserveSeat(irow, icol, name, description);
+                        }
+                    } else if (reserved && local.isHeld && !held) {
+                        data::pullingKind = seatrs::RESERVE;
+                        seatrs::reserveSeat(irow, icol, name, description);
+                    } else if (reserved && (local.name != name || local.description != description)) {
+                        data::pullingKind = seatrs::UPDATE;
+                        seatrs::updateSeat(irow, icol, name, description);
+                    } else if (!reserved && local.isReserved) {
+                        data::pullingKind = seatrs::CANCEL;
+                        seatrs::cancelSeat(irow, icol);
+                    }
+                    data::pullingSeat = -1;
+                }
+            }
+        #endif
+    }
+
+    /**
+     * Writes an update, a cancel or the confirmation of a hold made in this process to
+     * the segment before it is made locally, refusing it if another process changed the seat since the last
+     * pull(). Changes copied from the segment by pull() are let through.
+     */
+    bool commitSeat(const seatrs::Change& change) {
+        Header* header = data::header;
+        size_t index = (size_t) change.row * header->columns + change.column;
+        if ((long long) index == data::pullingSeat) return true;
+
+        uint32_t stamp = 0;
+        if (!commitChange(header, change, data::stamps[index], stamp)) {
+            data::conflicts++;
+            return false;
+        }
+        data::stamps[index] = stamp;
+        if (change.kind == seatrs::RESERVE) data::committedSeat = (long long) index;
+        return true;
+    }
+
+    /**
+     * Writes the reservations and holds made in this process to the segment. Updates,
+     * cancels and confirmed holds are written by commitSeat(). The size of a shared layout is fixed, so a
+     * resize is undone.
+     */
+    void onChange(const seatrs::Change& change) {
+        Header* header = data::header;
+        if (header == nullptr) return;
+
+        if (change.kind == seatrs::RESIZE) {
+            if (change.row != header->rows || change.column != header->columns) {
+                seatrs::setSize(header->rows, header->columns);
+            }
+            // copy every seat again, as the kept seats may be out of date
+            data::stamps.assign((size_t) header->rows * header->columns, 0);
+            data::pulledGeneration = 0;
+            return;
+        }
+        if (change.kind != seatrs::RESERVE && change.kind != seatrs::HOLD) return;
+
+        size_t index = (size_t) change.row * header->columns + change.column;
+        if ((long long) index == data::pullingSeat && change.kind == data::pullingKind) return;
+        if ((long long) index == data::committedSeat) {
+            data::committedSeat = -1;
+            return;
+        }
+
+        data::stamps[index] = storeSeat(header, change.row, change.column, change.kind == seatrs::HOLD, change.name, change.description);
+    }
+
+    /**
+     * Shares the seat layout with the other processes attached to the same segment.
+     * A new segment takes the size and the reservations of the current layout; an
+     * existing one replaces them.
+     *
+     * @param name The name of the segment, such as /venue.
+     *
+     * @returns An error message, or an empty string if the layout is now shared.
+     */
+    string attach(const string& name) {
+        bool created = false;
+        string errorMessage;
+        Header* header = mapSegment(name, seatrs::data::totalRows, seatrs::data::totalColumns, created, errorMessage);
+        if (header == nullptr) return errorMessage;
+
+        data::header = header;
+        data::name = name;
+        data::stamps.assign((size_t) header->rows * header->columns, 0);
+        data::pulledGeneration = 0;
+
+        seatrs::claimSeat = [](int irow, int icol) {
+            bool pulled = (data::pullingKind == seatrs::RESERVE || data::pullingKind == seatrs::HOLD) && data::pullingSeat == (long long) irow * data::header->columns + icol;
+            if (pulled || claim(data::header, irow, icol)) return true;
+            data::conflicts++;
+            return false;
+        };
+        seatrs::unclaimSeat = [](int irow, int icol) {
+            data::stamps[(size_t) irow * data::header->columns + icol] = release(data::header, irow, icol);
+        };
+        seatrs::commitSeat = commitSeat;
+
+        if (created) {
+            for (int irow = 0; irow < header->rows; irow++) {
+                for (int icol = 0; icol < header->columns; icol++) {
+                    const seatrs::Seat& seat = seatrs::data::seats[irow][icol];
+                    if (seat.isReserved && claim(header, irow, icol)) {
+                        data::stamps[(size_t) irow * header->columns + icol] = storeSeat(header, irow, icol, seat.isHeld, seat.name, seat.description);
+                    }
+                }
+            }
+        } else if (header->rows != seatrs::data::totalRows || header->columns != seatrs::data::totalColumns) {
+            seatrs::setSize(header->rows, header->columns);
+        }
+
+        if (!data::listening) {
+            seatrs::changeListeners.push_back(onChange);
+            data::listening = true;
+        }
+        pull();
+        return "";
+    }
+
+    /**
+     * Stops sharing the seat layout, keeping the local copy.
+     *
+     * @param unlink Whether to remove the segment, which ends it for every process.
+     */
+    void detach(bool unlink = false) {
+        if (data::header == nullptr) return;
+        unmapSegment(data::header, data::name, unlink);
+        data::header = nullptr;
+        seatrs::claimSeat = nullptr;
+        seatrs::unclaimSeat = nullptr;
+        seatrs::commitSeat = nullptr;
+    }
+
+    /**
+     * Builds the status line of a shared layout, for the HUD.
+     */
+    string status() {
+        if (data::header == nullptr) return "";
+        return "Shared as " + data::name + ", " + to_string(data::conflicts.load()) + " seats lost to or changed by other windows";
+    }
+}
+
+namespace program {
+    namespace config {
+        int lengthHUD = 80;
+    }
+
+    namespace control {
+        const int minLengthHUD = 60;
+        const int maxLengthHUD = 100;
+        const int maxPossibleRows = maxLengthHUD;
+        const int maxPossibleColumns = maxLengthHUD;
+    }
+}
+
+namespace transfer {
+
+    /**
+     * A read-only view of a whole file, memory-mapped when possible.
+     */
+    struct MappedFile {
+        const char* data = nullptr;
+        size_t size = 0;
+        bool mapped = false;
+        string contents;            // holds the file when it could not be mapped
+    };
+
+    /**
+     * Opens a file for reading as a single block of memory.
+     *
+     * @param path The path of the file.
+     * @param file A reference to the MappedFile to fill in.
+     *
+     * @returns A boolean indicating whether the file could not be opened.
+     */
+    bool mapFile(const string& path, MappedFile& file) {
+        #ifdef UNIX_LIKE
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return true;
+            }
+
+            struct stat info;
+            if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (address != MAP_FAILED) {
+                    close(fd);
+                    file.data = static_cast<const char*>(address);
+                    file.size = info.st_size;
+                    file.mapped = true;
+                    return false;
+                }
+            }
+            close(fd);
+        #endif
+
+        ifstream stream(path, ios::binary);
+        if (!stream) {
+            return true;
+        }
+
+        file.contents.assign(istreambuf_iterator<char>(stream), istreambuf_iterator<char>());
+        file.data = file.contents.data();
+        file.size = file.contents.size();
+        return false;
+    }
+
+    /**
+     * Releases a file opened with mapFile().
+     */
+    void unmapFile(MappedFile& file) {
+        #ifdef UNIX_LIKE
+            if (file.mapped) {
+                munmap(const_cast<char*>(file.data), file.size);
+            }
+        #endif
+        file = MappedFile();
+    }
+
+    /**
+     * Splits one CSV record into fields. Fields may be wrapped in double quotes to
+     * hold commas and newlines, with "" standing for a quote inside them.
+     *
+     * @param line The start of the record.
+     * @param length The number of bytes of the record, without its last newline.
+     *
+     * @returns The fields of the record.
+     */
+    vector<string> splitCSVLine(const char* line, size_t length) {
+        vector<string> fields(1);
+        bool quoted = false;
+
+        for (size_t i = 0; i < length; i++) {
+            char c = line[i];
+
+            if (quoted) {
+                if (c == '"' && i + 1 < length && line[i + 1] == '"') {
+                    fields.back() += '"';
+                    i++;
+                } else if (c == '"') {
+                    quoted = false;
+                } else {
+                    fields.back() += c;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.emplace_back();
+            } else if (c != '\r') {
+                fields.back() += c;
+            }
+        }
+
+        return fields;
+    }
+
+    struct ImportRecord {
+        size_t line = 0;            // line number in the file where the record starts, counted from 1
+        int row = 0, column = 0;    // seat position, counted from 1
+        string name, description;
+        bool malformed = false;
+    };
+
+    struct ImportReport {
+        size_t records = 0;         // data records read
+        size_t imported = 0;
+        size_t conflicts = 0;       // the seat was already reserved, or reserved earlier in the file
+        size_t invalid = 0;         // malformed lines and seats that do not exist
+        vector<string> problems;    // the first few conflicts and invalid lines
+        double seconds = 0;
+        bool error = false;
+        string errorMessage;
+    };
+
+    const size_t maxReportedProblems = 5;
+
+    /**
+     * Reads a whole CSV field as an int, allowing spaces around it and a leading +.
+     *
+     * @returns Whether the field held only a number that fits in an int.
+     */
+    bool parseIntField(const string& field, int& value) {
+        const char* first = field.data();
+        const char* last = field.data() + field.size();
+        while (first < last && (*first == ' ' || *first == '\t')) first++;
+        while (last > first && (last[-1] == ' ' || last[-1] == '\t')) last--;
+        if (last - first > 1 && *first == '+' && isdigit((unsigned char) first[1])) first++;
+
+        auto parsed = from_chars(first, last, value);
+        return parsed.ec == errc() && parsed.ptr == last;
+    }
+
+    /**
+     * Parses the CSV records in a block of memory into import records. A record
+     * ends at the first newline outside double quotes, so quoted fields may span
+     * several lines.
+     *
+     * @param data The start of the block, at the start of a record.
+     * @param size The number of bytes of the block, ending at the end of a record.
+     * @param records A reference to the vector where the records are appended.
+     */
+    void parseCSVChunk(const char* data, size_t size, vector<ImportRecord>& records) {
+        size_t start = 0;
+        size_t line = 0;
+
+        while (start < size) {
+            // Extend the record line by line while an odd number of quotes is open
+            size_t stop = start;
+            size_t lines = 1;
+            bool quoted = false;
+            while (true) {
+                const char* end = static_cast<const char*>(memchr(data + stop, '\n', size - stop));
+                size_t lineEnd = (end ? end - data : size);
+                if (memchr(data + stop, '"', lineEnd - stop)) {
+                    quoted ^= (count(data + stop, data + lineEnd, '"') & 1);
+                }
+                if (!quoted || !end) {
+                    stop = lineEnd;
+                    break;
+                }
+                stop = lineEnd + 1;
+                lines++;
+            }
+            size_t length = stop - start;
+            line++;
+
+            if (length > 0 && !(length == 1 && data[start] == '\r')) {
+                vector<string> fields = splitCSVLine(data + start, length);
+                ImportRecord record;
+                record.line = line;
+
+                bool rowValid = parseIntField(fields[0], record.row);
+                bool columnValid = fields.size() > 1 && parseIntField(fields[1], record.column);
+
+                record.malformed = 
+                    fields.size() < 3 || fields.size() > 4
+                    || !rowValid || !columnValid
+                    || fields[2].empty();
+
+                if (!record.malformed) {
+                    record.name = move(fields[2]);
+                    if (fields.size() > 3) record.description = move(fields[3]);
+                }
+
+                records.push_back(move(record));
+            }
+
+            line += lines - 1;
+            start += length + 1;
+        }
+    }
+
+    /**
+     * Imports reservations from a CSV file of row, column, name and (optional)
+     * description, with rows and columns counted from 1 and an optional header line.
+     * 
+     * The file is memory-mapped and split at line boundaries into one chunk per
+     * thread, which are parsed in parallel. Every record is then validated against 
+     * the seat layout and the seats already reserved, and the valid records are 
+     * applied together. When two records claim the same seat, the first one wins.
+     *
+     * @param path The path of the CSV file.
+     * @param threads The number of threads to parse with, or 0 to use one per core.
+     *
+     * @returns An ImportReport with the number of imported records and the problems found.
+     */
+    ImportReport importCSV(const string& path, int threads = 0) {
+        ImportReport report;
+        auto started = chrono::steady_clock::now();
+
+        MappedFile file;
+        if (mapFile(path, file)) {
+            report.error = true;
+            report.errorMessage = "Unable to open the file \"" + path + "\".";
+            return report;
+        }
+
+        // Skip a byte order mark, and the header, recognized by its first field not
+        // reading as a row number the way the data lines are read
+        size_t begin = (file.size >= 3 && memcmp(file.data, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+        size_t headerLines = 0;
+        if (begin < file.size) {
+            const char* end = static_cast<const char*>(memchr(file.data + begin, '\n', file.size - begin));
+            size_t length = (end ? end - (file.data + begin) : file.size - begin);
+            int row = 0;
+            if (!parseIntField(splitCSVLine(file.data + begin, length)[0], row)) {
+                begin += length + (end ? 1 : 0);
+                headerLines = 1;
+            }
+        }
+
+        if (threads <= 0) {
+            threads = max(1u, thread::hardware_concurrency());
+        }
+
+        // Count the quotes before every split point in parallel, so a split point
+        // that falls inside a quoted field is known to be there
+        vector<size_t> targets(threads + 1);
+        for (int i = 0; i <= threads; i++) {
+            targets[i] = begin + (file.size - begin) * i / threads;
+        }
+        vector<size_t> quotes(threads, 0);
+        vector<thread> counters;
+        for (int i = 0; i < threads; i++) {
+            counters.emplace_back([&, i]() {
+                quotes[i] = count(file.data + targets[i], file.data + targets[i + 1], '"');
+            });
+        }
+        for (auto &counter : counters) {
+            counter.join();
+        }
+
+        // Split the file into chunks that start and end at record boundaries
+        vector<size_t> bounds = {begin};
+        bool quoted = false;
+        for (int i = 1; i < threads; i++) {
+            quoted ^= (quotes[i - 1] & 1);
+            size_t target = targets[i];
+            if (target <= bounds.back()) continue;
+
+            bool open = quoted;
+            size_t bound = target;
+            while (bound < file.size && (open || file.data[bound] != '\n')) {
+                if (file.data[bound] == '"') open = !open;
+                bound++;
+            }
+            bound = min(bound + 1, file.size);
+            if (bound > bounds.back() && bound < file.size) bounds.push_back(bound);
+        }
+        bounds.push_back(file.size);
+
+        size_t chunks = bounds.size() - 1;
+        vector<vector<ImportRecord>> parsed(chunks);
+        vector<size_t> chunkLines(chunks, 0);
+        vector<thread> workers;
+
+        for (size_t i = 0; i < chunks; i++) {
+            workers.emplace_back([&, i]() {
+                const char* data = file.data + bounds[i];
+                size_t size = bounds[i + 1] - bounds[i];
+                parseCSVChunk(data, size, parsed[i]);
+
+                size_t lines = 0;
+                for (size_t j = 0; j < size; j++) {
+                    if (data[j] == '\n') lines++;
+                }
+                chunkLines[i] = lines;
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+
+        unmapFile(file);
+
+        // Validate every record in file order, claiming seats as they are accepted
+        vector<bool> claimed((size_t) seatrs::data::totalRows * seatrs::data::totalColumns, false);
+        vector<ImportRecord*> accepted;
+        vector<size_t> acceptedLines;
+        size_t lineOffset = headerLines;
+
+        for (size_t i = 0; i < chunks; i++) {
+            for (auto &record : parsed[i]) {
+                report.records++;
+                size_t line = lineOffset + record.line;
+                string problem;
+
+                if (record.malformed) {
+                    report.invalid++;
+                    problem = "Line " + to_string(line) + ": expected row, column, name and description.";
+                } else if (record.row < 1 || record.column < 1 || !seatrs::isValidSeat(record.row - 1, record.column - 1)) {
+                    report.invalid++;
+                    problem = "Line " + to_string(line) + ": the seat [" + to_string(record.row) + ", " + to_string(record.column) + "] does not exist.";
+                } else {
+                    size_t index = (size_t) (record.row - 1) * seatrs::data::totalColumns + (record.column - 1);
+                    if (claimed[index] || seatrs::data::seats[record.row - 1][record.column - 1].isReserved) {
+                        report.conflicts++;
+                        problem = "Line " + to_string(line) + ": the seat [" + to_string(record.row) + ", " + to_string(record.column) + "] is already reserved.";
+                    } else {
+                        claimed[index] = true;
+                        accepted.push_back(&record);
+                        acceptedLines.push_back(line);
+                    }
+                }
+
+                if (!problem.empty() && report.problems.size() < maxReportedProblems) {
+                    report.problems.push_back(problem);
+                }
+            }
+            lineOffset += chunkLines[i];
+        }
+
+        // Apply the accepted records in one batch. The batch is refused as a whole if
+        // another window took one of its seats since they were checked, and then the
+        // records are reserved one by one so the rest are still imported.
+        vector<seatrs::SeatReservation> reservations;
+        reservations.reserve(accepted.size());
+        for (ImportRecord* record : accepted) {
+            reservations.push_back({record->row - 1, record->column - 1, move(record->name), move(record->description)});
+        }
+
+        if (seatrs::reserveSeats(reservations) == seatrs::OK) {
+            report.imported = reservations.size();
+        } else {
+            for (size_t i = 0; i < reservations.size(); i++) {
+                const seatrs::SeatReservation& reservation = reservations[i];
+                if (seatrs::reserveSeat(reservation.row, reservation.column, reservation.name, reservation.description) == seatrs::OK) {
+                    report.imported++;
+                    continue;
+                }
+
+                report.conflicts++;
+                if (report.problems.size() < maxReportedProblems) {
+                    report.problems.push_back("Line " + to_string(acceptedLines[i]) + ": the seat [" + to_string(reservation.row + 1) + ", " + to_string(reservation.column + 1) + "] is already reserved.");
+                }
+            }
+        }
+
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return report;
+    }
+
+    /**
+     * Writes to a file through a fixed-size buffer, so the memory used stays the
+     * same no matter how much is written.
+     */
+    struct BufferedWriter {
+        static const size_t capacity = 64 * 1024;
+
+        ofstream stream;
+        char buffer[capacity];
+        size_t used = 0;
+        size_t bytesWritten = 0;
+
+        void flush() {
+            stream.write(buffer, used);
+            bytesWritten += used;
+            used = 0;
+        }
+
+        void write(const char* text, size_t length) {
+            if (used + length > capacity) {
+                flush();
+            }
+            if (length > capacity) {
+                stream.write(text, length);
+                bytesWritten += length;
+                return;
+            }
+            memcpy(buffer + used, text, length);
+            used += length;
+        }
+
+        void write(const string& text) {
+            write(text.data(), text.length());
+        }
+
+        void write(char c) {
+            if (used == capacity) {
+                flush();
+            }
+            buffer[used++] = c;
+        }
+    };
+
+    /**
+     * Writes a field as CSV, quoting it only if it holds a comma, quote or newline.
+     */
+    void writeCSVField(BufferedWriter& writer, const string& field) {
+        if (field.find_first_of(",\"\r\n") == string::npos) {
+            writer.write(field);
+            return;
+        }
+
+        writer.write('"');
+        for (char c : field) {
+            if (c == '"') writer.write('"');
+            writer.write(c);
+        }
+        writer.write('"');
+    }
+
+    /**
+     * Writes a string as a quoted JSON string.
+     */
+    void writeJSONString(BufferedWriter& writer, const string& text) {
+        const char* hex = "0123456789abcdef";
+
+        writer.write('"');
+        for (char c : text) {
+            switch (c) {
+                case '"': writer.write("\\\"", 2); break;
+                case '\\': writer.write("\\\\", 2); break;
+                case '\n': writer.write("\\n", 2); break;
+                case '\r': writer.write("\\r", 2); break;
+                case '\t': writer.write("\\t", 2); break;
+                default:
+                    if ((unsigned char) c < 0x20) {
+                        char escaped[] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF]};
+                        writer.write(escaped, sizeof(escaped));
+                    } else {
+                        writer.write(c);
+                    }
+            }
+        }
+        writer.write('"');
+    }
+
+    enum ExportFormat {
+        CSV = 1,
+        JSON_LINES = 2
+    };
+
+    struct ExportReport {
+        size_t records = 0;
+        size_t bytes = 0;
+        double seconds = 0;
+        bool error = false;
+        string errorMessage;
+    };
+
+    /**
+     * Streams every reservation in a range of rows to a file, as CSV (with the same
+     * columns importCSV() reads) or as JSON Lines. Records are written through a
+     * BufferedWriter as the seats are walked, so memory use does not grow with the
+     * size of the venue. When versions are published, it reads a pinned version and
+     * can run on another thread while bookings continue.
+     *
+     * @param path The path of the file to write.
+     * @param format The format to write the reservations in.
+     * @param firstRow The first row to export, counted from 1.
+     * @param lastRow The last row to export, counted from 1.
+     *
+     * @returns An ExportReport with the number of records and bytes written.
+     */
+    ExportReport exportReservations(const string& path, ExportFormat format, int firstRow, int lastRow) {
+        ExportReport report;
+        auto started = chrono::steady_clock::now();
+
+        // Allocated on the heap, as the buffer is too large for the stack
+        unique_ptr<BufferedWriter> writer(new BufferedWriter());
+        writer->stream.open(path, ios::binary | ios::trunc);
+
+        if (!writer->stream) {
+            report.error = true;
+            report.errorMessage = "Unable to write to the file \"" + path + "\".";
+            return report;
+        }
+
+        if (format == CSV) {
+            writer->write("row,column,name,description\n");
+        }
+
+        // When versions are published, the export reads a pinned version, so it sees
+        // one consistent layout even while other threads keep committing
+        versions::Pin pinned = versions::pin();
+        const versions::Version* version = pinned.version;
+        int totalRows = version ? version->totalRows : seatrs::data::totalRows;
+        int wordsPerRow = version ? (version->totalColumns + 63) / 64 : seatrs::data::wordsPerRow;
+
+        firstRow = max(firstRow, 1);
+        lastRow = min(lastRow, totalRows);
+
+        for (int irow = firstRow - 1; irow < lastRow; irow++) {
+            // Empty rows are skipped by their aggregate, and reserved seats are
+            // found from the set bits of the occupancy words
+            if (!version && seatrs::data::rowOccupied[irow] == 0) continue;
+
+            for (int word = 0; word < wordsPerRow; word++)
+            for (
+                uint64_t occupied = version 
+                    ? version->occupancyWord(irow, word) 
+                    : seatrs::data::occupancy[(size_t) irow * wordsPerRow + word]; 
+                occupied; 
+                occupied &= occupied - 1
+            ) {
+                int icol = word * 64 + seatrs::lowestBit(occupied);
+                const seatrs::Seat& seat = version ? version->seat(irow, icol) : seatrs::data::seats[irow][icol];
+
+                if (format == CSV) {
+                    writer->write(to_string(irow + 1));
+                    writer->write(',');
+                    writer->write(to_string(icol + 1));
+                    writer->write(',');
+                    writeCSVField(*writer, seat.name);
+                    writer->write(',');
+                    writeCSVField(*writer, seat.description);
+                    writer->write('\n');
+                } else {
+                    writer->write("{\"row\":");
+                    writer->write(to_string(irow + 1));
+                    writer->write(",\"column\":");
+                    writer->write(to_string(icol + 1));
+                    writer->write(",\"name\":");
+                    writeJSONString(*writer, seat.name);
+                    writer->write(",\"description\":");
+                    writeJSONString(*writer, seat.description);
+                    writer->write("}\n");
+                }
+                report.records++;
+            }
+        }
+
+        versions::unpin(pinned);
+
+        writer->flush();
+        writer->stream.close();
+
+        if (writer->stream.fail()) {
+            report.error = true;
+            report.errorMessage = "Unable to finish writing the file \"" + path + "\".";
+        }
+
+        report.bytes = writer->bytesWritten;
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return report;
+    }
+
+    struct VenueMap {
+        int rows = 0, columns = 0;
+        vector<uint64_t> validity;      // laid out like seatrs::data::occupancy for the map's size
+        int seats = 0;
+        bool error = false;
+        string errorMessage;
+    };
+
+    /**
+     * Reads the shape of a venue: one line per row, with O for a seat and a space,
+     * . or _ for a gap. Rows shorter than the longest row end in gaps.
+     *
+     * @param input The venue map to read.
+     *
+     * @returns A VenueMap with the size and the seats of the venue.
+     */
+    VenueMap parseVenueMap(istream& input) {
+        VenueMap map;
+        vector<string> lines;
+        string line;
+
+        while (getline(input, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            size_t end = line.find_last_not_of(' ');
+            line.resize(end == string::npos ? 0 : end + 1);
+            lines.push_back(line);
+        }
+        while (!lines.empty() && lines.back().empty()) {
+            lines.pop_back();
+        }
+
+        map.rows = (int) lines.size();
+        for (const string& row : lines) {
+            map.columns = max(map.columns, (int) row.size());
+        }
+
+        if (map.rows < 1 || map.rows > program::control::maxPossibleRows || map.columns < 1 || map.columns > program::control::maxPossibleColumns) {
+            map.error = true;
+            map.errorMessage = "A venue map must have 1 to " + to_string(program::control::maxPossibleRows) + " rows and 1 to " 
+                + to_string(program::control::maxPossibleColumns) + " columns.";
+            return map;
+        }
+
+        int wordsPerRow = (map.columns + 63) / 64;
+        map.validity.assign((size_t) map.rows * wordsPerRow, 0);
+        for (int irow = 0; irow < map.rows; irow++) {
+            for (int icol = 0; icol < (int) lines[irow].size(); icol++) {
+                switch (lines[irow][icol]) {
+                    case 'O': case 'o':
+                        map.validity[(size_t) irow * wordsPerRow + icol / 64] |= (1ULL << (icol % 64));
+                        map.seats++;
+                        break;
+                    case ' ': case '.': case '_':
+                        break;
+                    default:
+                        map.error = true;
+                        map.errorMessage = "Unknown character '" + string(1, lines[irow][icol]) + "' in row " + to_string(irow + 1) + " of the venue map.";
+                        return map;
+                }
+            }
+        }
+
+        return map;
+    }
+
+    /**
+     * Resizes the seat layout to a venue map and gives it the map's shape. The map is
+     * rejected if a reserved seat would become a gap or fall outside the map, or if
+     * the layout is shared and the map is not of its fixed size.
+     *
+     * @param path The path of the venue map file.
+     *
+     * @returns The VenueMap that was loaded, with "error" set if it was not applied.
+     */
+    VenueMap loadVenueMap(const string& path) {
+        ifstream file(path);
+        if (!file) {
+            VenueMap map;
+            map.error = true;
+            map.errorMessage = "Unable to read the file \"" + path + "\".";
+            return map;
+        }
+
+        VenueMap map = parseVenueMap(file);
+        if (map.error) return map;
+
+        const shared::Header* header = shared::data::header;
+        if (header != nullptr && (map.rows != header->rows || map.columns != header->columns)) {
+            map.error = true;
+            map.errorMessage = "The layout is shared with a fixed size of " + to_string(header->rows) + " rows and " + to_string(header->columns) 
+                + " columns, but the venue map has " + to_string(map.rows) + " rows and " + to_string(map.columns) + " columns.";
+            return map;
+        }
+
+        // Every occupied seat must stay a seat, including those the map would cut off
+        int wordsPerRow = (map.columns + 63) / 64;
+        for (int irow = 0; irow < seatrs::data::totalRows; irow++) {
+            for (int icol = 0; icol < seatrs::data::totalColumns; icol++) {
+                if (!seatrs::isOccupied(irow, icol)) continue;
+
+                bool inside = irow < map.rows && icol < map.columns;
+                if (!inside || !((map.validity[(size_t) irow * wordsPerRow + icol / 64] >> (icol % 64)) & 1)) {
+                    map.error = true;
+                    map.errorMessage = "The seat [" + to_string(irow + 1) + ", " + to_string(icol + 1) + "] is reserved but is " 
+                        + (inside ? "a gap in" : "outside") + " the venue map.";
+                    return map;
+                }
+            }
+        }
+
+        if (map.rows != seatrs::data::totalRows || map.columns != seatrs::data::totalColumns) {
+            seatrs::setSize(map.rows, map.columns);
+        }
+        if (map.rows != seatrs::data::totalRows || map.columns != seatrs::data::totalColumns || seatrs::setShape(map.validity) != seatrs::OK) {
+            map.error = true;
+            map.errorMessage = "The seat layout could not be given the shape of the venue map.";
+        }
+        return map;
+    }
+}
+
+namespace allocation {
+
+    /**
+     * A party to seat together in one row, optionally only in a range of rows.
+     */
+    struct PartyRequest {
+        string name, description;
+        int size = 1;
+        int firstRow = -1, lastRow = -1;        // -1 for any row
+    };
+
+    struct Placement {
+        int row = -1, firstColumn = -1;         // row -1 if the party was not placed
+    };
+
+    struct AllocationParams {
+        vector<PartyRequest> parties;
+        double timeBudget = 0.1;                // seconds spent looking for better plans
+        bool requireAll = true;                 // commit nothing unless every party is placed
+        uint32_t seed = 1;
+        string requestId;                       // the client's ID for the batch, or empty for none
+    };
+
+    struct AllocationReport {
+        vector<Placement> placements;           // one per party, in the order given
+        size_t placed = 0, unplaced = 0;
+        size_t singleGapsBefore = 0, singleGapsAfter = 0;
+        size_t attempts = 0;
+        double seconds = 0;
+        bool committed = false;
+        bool repeated = false;                  // the request ID was seen, so nothing was planned
+        string errorMessage;
+    };
+
+    /**
+     * The free runs of adjacent seats of the whole layout, both by row (for parties
+     * that want certain rows) and by length (for best fit over the whole layout).
+     */
+    struct Runs {
+        vector<set<pair<int, int>>> byRow;          // per row: start, length
+        set<tuple<int, int, int>> byLength;         // length, row, start
+
+        void add(int row, int start, int length) {
+            if (length <= 0) return;
+            byRow[row].insert({start, length});
+            byLength.insert(make_tuple(length, row, start));
+        }
+
+        void remove(int row, int start, int length) {
+            byRow[row].erase({start, length});
+            byLength.erase(make_tuple(length, row, start));
+        }
+
+        size_t singleGaps() const {
+            return distance(byLength.lower_bound(make_tuple(1, -1, -1)), byLength.lower_bound(make_tuple(2, -1, -1)));
+        }
+    };
+
+    /**
+     * Collects the free runs of the current layout, a word at a time.
+     */
+    Runs collectRuns() {
+        Runs runs;
+        runs.byRow.resize(seatrs::data::totalRows);
+        for (int irow = 0; irow < seatrs::data::totalRows; irow++) {
+            int icol = seatrs::data::rowFirstFree[irow];
+            while (icol >= 0) {
+                int end = seatrs::nextUnavailableInRow(irow, icol);
+                runs.add(irow, icol, end - icol);
+                icol = seatrs::nextFreeInRow(irow, end);
+            }
+        }
+        return runs;
+    }
+
+    /**
+     * Ranks how well a party fits a run: an exact fit is best, then the smallest
+     * leftover, and a leftover of one seat, which no party is likely to take, last.
+     */
+    int fitCost(int length, int size) {
+        int leftover = length - size;
+        return (leftover == 1) ? INT_MAX / 2 : leftover;
+    }
+
+    /**
+     * Places the parties in the given order, each into the best-fitting run it may
+     * use, taking seats from the start of the run.
+     *
+     * @returns The number of single-seat gaps left, with placements filled in.
+     */
+    size_t planOnce(const vector<PartyRequest>& parties, const vector<int>& order, Runs runs, vector<Placement>& placements, size_t& unplaced) {
+        placements.assign(parties.size(), Placement());
+        unplaced = 0;
+
+        for (int iparty : order) {
+            const PartyRequest& party = parties[iparty];
+            int bestRow = -1, bestStart = -1, bestLength = 0, bestCost = INT_MAX;
+
+            if (party.firstRow < 0) {
+                // the exact fit, else the shortest run leaving two or more seats, else one leaving a single seat
+                auto exact = runs.byLength.lower_bound(make_tuple(party.size, -1, -1));
+                auto roomy = runs.byLength.lower_bound(make_tuple(party.size + 2, -1, -1));
+                auto chosen = (exact != runs.byLength.end() && get<0>(*exact) == party.size) ? exact
+                    : (roomy != runs.byLength.end()) ? roomy : exact;
+                if (chosen != runs.byLength.end()) {
+                    tie(bestLength, bestRow, bestStart) = *chosen;
+                }
+            } else {
+                for (int irow = party.firstRow; irow <= party.lastRow; irow++) {
+                    for (const pair<int, int>& run : runs.byRow[irow]) {
+                        if (run.second < party.size) continue;
+                        int cost = fitCost(run.second, party.size);
+                        if (cost < bestCost) {
+                            bestCost = cost;
+                            bestRow = irow;
+                            bestStart = run.first;
+                            bestLength = run.second;
+                        }
+                    }
+                }
+            }
+
+            if (bestRow < 0) {
+                unplaced++;
+                continue;
+            }
+
+            runs.remove(bestRow, bestStart, bestLength);
+            runs.add(bestRow, bestStart + party.size, bestLength - party.size);
+            placements[iparty] = {bestRow, bestStart};
+        }
+
+        return runs.singleGaps();
+    }
+
+    /**
+     * Seats a batch of parties, each in adjacent seats of one row, while leaving as few
+     * single-seat gaps as possible. The first plan places the parties that want certain
+     * rows first and then the largest parties first, each into its best-fitting run.
+     * Until the time budget runs out, more plans are made with the order shuffled among
+     * parties of similar size, keeping the plan that places the most parties and then
+     * leaves the fewest single-seat gaps. The best plan is committed as a whole, or not
+     * at all if a reservation fails or a party is left over when every party is required.
+     *
+     * @param params The parties, the time budget, whether every party must be placed,
+     *               and the client's ID for the batch.
+     *
+     * @returns An AllocationReport with where each party was placed.
+     */
+    AllocationReport allocateParties(const AllocationParams& params) {
+        AllocationReport report;
+        auto started = chrono::steady_clock::now();
+        auto deadline = started + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(params.timeBudget));
+
+        for (const PartyRequest& party : params.parties) {
+            bool rowsValid = party.firstRow < 0 || (party.firstRow <= party.lastRow && party.lastRow < seatrs::data::totalRows);
+            if (party.size < 1 || party.size > seatrs::data::totalColumns || !rowsValid) {
+                report.errorMessage = "The party \"" + party.name + "\" cannot fit in one row of the seat layout.";
+                return report;
+            }
+        }
+
+        // A batch repeated under the ID of one already carried out is not planned again
+        bool planned = false;
+        seatrs::Result result = seatrs::once(params.requestId, [&] {
+            planned = true;
+            Runs runs = collectRuns();
+            report.singleGapsBefore = runs.singleGaps();
+
+            vector<int> order(params.parties.size());
+            for (size_t i = 0; i < order.size(); i++) order[i] = (int) i;
+            auto constrainedThenLargest = [&](const vector<double>& sizes) {
+                sort(order.begin(), order.end(), [&](int a, int b) {
+                    bool constrainedA = params.parties[a].firstRow >= 0, constrainedB = params.parties[b].firstRow >= 0;
+                    if (constrainedA != constrainedB) return constrainedA;
+                    return sizes[a] > sizes[b];
+                });
+            };
+
+            vector<double> sizes(params.parties.size());
+            for (size_t i = 0; i < sizes.size(); i++) sizes[i] = params.parties[i].size;
+            constrainedThenLargest(sizes);
+
+            size_t bestUnplaced = 0;
+            size_t bestGaps = planOnce(params.parties, order, runs, report.placements, bestUnplaced);
+            report.attempts = 1;
+
+            mt19937 random(params.seed);
+            uniform_real_distribution<double> jitter(0, 1.5);
+            vector<Placement> placements;
+            while ((bestUnplaced > 0 || bestGaps > report.singleGapsBefore) && chrono::steady_clock::now() < deadline) {
+                for (size_t i = 0; i < sizes.size(); i++) sizes[i] = params.parties[i].size + jitter(random);
+                constrainedThenLargest(sizes);
+
+                size_t unplaced;
+                size_t gaps = planOnce(params.parties, order, runs, placements, unplaced);
+                report.attempts++;
+                if (unplaced < bestUnplaced || (unplaced == bestUnplaced && gaps < bestGaps)) {
+                    bestUnplaced = unplaced;
+                    bestGaps = gaps;
+                    report.placements.swap(placements);
+                }
+            }
+
+            report.unplaced = bestUnplaced;
+            report.placed = params.parties.size() - bestUnplaced;
+            report.singleGapsAfter = bestGaps;
+
+            if (bestUnplaced == 0 || !params.requireAll) {
+                // Reserve every seat of the plan as one batch, so a seat taken in the
+                // meantime leaves nothing behind and nothing to undo
+                vector<seatrs::SeatReservation> reservations;
+                for (size_t iparty = 0; iparty < params.parties.size(); iparty++) {
+                    const Placement& placement = report.placements[iparty];
+                    if (placement.row < 0) continue;
+                    const PartyRequest& party = params.parties[iparty];
+                    for (int icol = placement.firstColumn; icol < placement.firstColumn + party.size; icol++) {
+                        reservations.push_back({placement.row, icol, party.name, party.description});
+                    }
+                }
+
+                if (seatrs::reserveSeats(reservations) != seatrs::OK) {
+                    report.errorMessage = "A planned seat was taken, so no party was seated.";
+                } else {
+                    report.committed = true;
+                }
+            } else {
+                report.errorMessage = to_string(bestUnplaced) + " of the parties do not fit, so no party was seated.";
+            }
+            return report.committed ? seatrs::OK : seatrs::ALREADY_RESERVED;
+        });
+        if (!planned) {
+            report.repeated = true;
+            report.committed = result == seatrs::OK;
+            report.errorMessage = report.committed ? "" : "This batch was already tried, and no party was seated.";
+        }
+
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return report;
+    }
+
+    struct PartyFile {
+        vector<PartyRequest> parties;
+        bool error = false;
+        string errorMessage;
+    };
+
+    /**
+     * Reads a CSV file of parties: name, size, rows and description. The rows are
+     * empty for any row, a single row, or a range like 5-10, counted from 1. A header
+     * line is optional.
+     *
+     * @param path The path of the file.
+     *
+     * @returns A PartyFile with the parties, or with "error" set.
+     */
+    PartyFile readParties(const string& path) {
+        PartyFile file;
+        ifstream input(path);
+        if (!input) {
+            file.error = true;
+            file.errorMessage = "Unable to read the file \"" + path + "\".";
+            return file;
+        }
+
+        string line;
+        int lineNumber = 0;
+        while (getline(input, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            vector<string> fields = transfer::splitCSVLine(line.data(), line.size());
+            PartyRequest party;
+            party.name = fields[0];
+            if (fields.size() > 3) party.description = fields[3];
+
+            int first = 0, last = 0;
+            const char* sizeEnd = (fields.size() > 1) ? fields[1].data() + fields[1].size() : nullptr;
+            bool sizeValid = sizeEnd && from_chars(fields[1].data(), sizeEnd, party.size).ptr == sizeEnd && party.size > 0;
+
+            bool rowsValid = true;
+            if (fields.size() > 2 && !fields[2].empty()) {
+                const string& rows = fields[2];
+                auto parsed = from_chars(rows.data(), rows.data() + rows.size(), first);
+                last = first;
+                if (parsed.ptr != rows.data() + rows.size()) {
+                    rowsValid = *parsed.ptr == '-' && from_chars(parsed.ptr + 1, rows.data() + rows.size(), last).ptr == rows.data() + rows.size();
+                }
+                rowsValid = rowsValid && first >= 1 && first <= last;
+                party.firstRow = first - 1;
+                party.lastRow = last - 1;
+            }
+
+            if (!sizeValid || !rowsValid || party.name.empty()) {
+                if (lineNumber == 1) continue;      // a header
+                file.error = true;
+                file.errorMessage = "Line " + to_string(lineNumber) + " is not a party of name, size, rows and description.";
+                return file;
+            }
+            file.parties.push_back(party);
+        }
+
+        if (file.parties.empty()) {
+            file.error = true;
+            file.errorMessage = "The file has no parties.";
+        }
+        return file;
+    }
+}
+
+namespace replication {
+
+    // An idle primary sends a heartbeat this often, a record with sequence number 0
+    const chrono::milliseconds heartbeatInterval(1000);
+
+    // A connected primary not heard from for this long may be taken over by the operator
+    const chrono::milliseconds heartbeatTimeout(3000);
+
+    /**
+     * Gets the current time of the monotonic clock in microseconds, which processes
+     * on the same machine share, so a record's commit time can be compared across them.
+     */
+    int64_t nowMicros() {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Encodes a change as one replication record: a header line of numbers followed by
+     * the raw bytes of the name and description, whose lengths are in the header.
+     *
+     * @param output The string to append the record to.
+     * @param sequence The sequence number of the change.
+     * @param committedAt The time the change was committed, from nowMicros().
+     * @param change The change to encode.
+     */
+    void encodeChange(string& output, uint64_t sequence, int64_t committedAt, const seatrs::Change& change) {
+        long long fields[] = {
+            (long long) sequence, (long long) committedAt, (long long) change.kind,
+            change.row, change.column, change.lastRow, change.lastColumn,
+            change.tier, change.price, change.features,
+            (long long) change.name.size(), (long long) change.description.size()
+        };
+
+        char header[256];
+        char* end = header;
+        for (long long field : fields) {
+            end = to_chars(end, header + sizeof(header), field).ptr;
+            *end++ = ' ';
+        }
+        end[-1] = '\n';
+
+        output.append(header, end - header);
+        output += change.name;
+        output += change.description;
+    }
+
+    /**
+     * Decodes the whole record at a position of a buffer.
+     *
+     * @param buffer The received bytes.
+     * @param offset The position of the record, moved past it once decoded.
+     *
+     * @returns false if the buffer does not hold a whole record there yet.
+     */
+    bool decodeChange(const string& buffer, size_t& offset, uint64_t& sequence, int64_t& committedAt, seatrs::Change& change) {
+        size_t end = buffer.find('\n', offset);
+        if (end == string::npos) return false;
+
+        long long fields[12] = {};
+        const char* position = buffer.data() + offset;
+        for (long long& field : fields) {
+            position = from_chars(position, buffer.data() + end, field).ptr + 1;
+        }
+
+        size_t nameLength = fields[10], descriptionLength = fields[11];
+        if (buffer.size() < end + 1 + nameLength + descriptionLength) return false;
+
+        sequence = fields[0];
+        committedAt = fields[1];
+        change.kind = (seatrs::ChangeKind) fields[2];
+        change.row = (int) fields[3];
+        change.column = (int) fields[4];
+        change.lastRow = (int) fields[5];
+        change.lastColumn = (int) fields[6];
+        change.tier = (int) fields[7];
+        change.price = (int) fields[8];
+        change.features = (int) fields[9];
+        change.name.assign(buffer, end + 1, nameLength);
+        change.description.assign(buffer, end + 1 + nameLength, descriptionLength);
+        offset = end + 1 + nameLength + descriptionLength;
+        return true;
+    }
+
+    /**
+     * Applies a replicated change to the local seat layout.
+     */
+    void applyChange(const seatrs::Change& change) {
+        switch (change.kind) {
+            case seatrs::RESERVE: seatrs::reserveSeat(change.row, change.column, change.name, change.description); break;
+            case seatrs::HOLD: seatrs::holdSeat(change.row, change.column, change.name, change.description); break;
+            case seatrs::UPDATE: seatrs::updateSeat(change.row, change.column, change.name, change.description); break;
+            case seatrs::CANCEL: seatrs::cancelSeat(change.row, change.column); break;
+            case seatrs::RESIZE: seatrs::setSize(change.row, change.column); break;
+            case seatrs::ATTRIBUTES:
+                seatrs::setAttributes(change.row, change.lastRow, change.column, change.lastColumn, change.tier, change.price, change.features);
+                break;
+            case seatrs::SHAPE: {
+                istringstream input(change.name);
+                transfer::VenueMap map = transfer::parseVenueMap(input);
+                if (map.error) break;
+                if (map.rows != seatrs::data::totalRows || map.columns != seatrs::data::totalColumns) {
+                    seatrs::setSize(map.rows, map.columns);
+                }
+                seatrs::setShape(map.validity);
+                break;
+            }
+            case seatrs::SECTIONS: seatrs::setSections(seatrs::parseSections(change.name)); break;
+        }
+    }
+
+    /**
+     * The primary side of replication. Committed changes are encoded into a queue on
+     * the booking path, and a shipper thread sends whatever has queued up as one batch,
+     * so the booking path never waits on the standby.
+     */
+    struct Primary {
+        int socketFd = -1;
+        thread shipper;
+        mutex queueMutex;
+        condition_variable queueReady;
+        string queue;               // encoded records waiting to be shipped
+        uint64_t queuedUpTo = 0;    // sequence number of the last queued record
+        bool stopping = false;
+
+        atomic<bool> active{false};
+        atomic<bool> connected{false};
+        atomic<uint64_t> committed{0};
+        atomic<uint64_t> shipped{0};
+        atomic<uint64_t> acknowledged{0};
+        atomic<uint64_t> batches{0};
+        atomic<uint64_t> bytes{0};
+        atomic<int64_t> lagMicros{0};       // commit-to-apply time of the last acknowledged record
+        atomic<int64_t> maxLagMicros{0};
+    } primary;
+
+    /**
+     * Reads the acknowledgements the standby has sent so far, each a line with the
+     * sequence number it applied up to and the commit-to-apply lag of that record.
+     */
+    void readAcknowledgements(string& pending) {
+        #ifdef UNIX_LIKE
+            char buffer[512];
+            ssize_t count;
+            while ((count = recv(primary.socketFd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+                pending.append(buffer, count);
+            }
+            if (count == 0) primary.connected = false;
+
+            size_t end;
+            while ((end = pending.find('\n')) != string::npos) {
+                istringstream line(pending.substr(0, end));
+                pending.erase(0, end + 1);
+
+                uint64_t sequence;
+                int64_t lag;
+                if (line >> sequence >> lag) {
+                    primary.acknowledged = sequence;
+                    primary.lagMicros = lag;
+                    if (lag > primary.maxLagMicros) primary.maxLagMicros = lag;
+                }
+            }
+        #endif
+    }
+
+    /**
+     * Sends the queued records in batches until replication stops or the standby is lost,
+     * and a heartbeat whenever nothing was sent for a while, so the standby can tell an
+     * idle primary from a stuck one.
+     */
+    void shipChanges() {
+        #ifdef UNIX_LIKE
+            string acknowledgements;
+            auto lastSent = chrono::steady_clock::now();
+            unique_lock<mutex> lock(primary.queueMutex);
+
+            while (!primary.stopping && primary.connected) {
+                primary.queueReady.wait_for(lock, chrono::milliseconds(100), [] {
+                    return primary.stopping || !primary.queue.empty();
+                });
+
+                string batch;
+                batch.swap(primary.queue);
+                uint64_t upTo = primary.queuedUpTo;
+                lock.unlock();
+
+                bool heartbeat = batch.empty() && chrono::steady_clock::now() - lastSent >= heartbeatInterval;
+                if (heartbeat) {
+                    seatrs::Change change;
+                    change.kind = (seatrs::ChangeKind) 0;
+                    encodeChange(batch, 0, nowMicros(), change);
+                }
+                if (!batch.empty()) lastSent = chrono::steady_clock::now();
+
+                size_t sent = 0;
+                while (sent < batch.size()) {
+                    ssize_t count = send(primary.socketFd, batch.data() + sent, batch.size() - sent, 0);
+                    if (count < 0 && errno == EINTR) continue;
+                    if (count <= 0) {
+                        primary.connected = false;
+                        break;
+                    }
+                    sent += count;
+                }
+
+                if (!batch.empty() && !heartbeat && primary.connected) {
+                    primary.shipped = upTo;
+                    primary.batches++;
+                    primary.bytes += batch.size();
+                }
+
+                readAcknowledgements(acknowledgements);
+                lock.lock();
+            }
+        #endif
+    }
+
+    /**
+     * Connects to a standby listening on a local socket, sends it the current seat
+     * layout, and starts shipping every later change to it.
+     *
+     * @param path The path of the standby's socket.
+     * @param waitSeconds How long to keep retrying while the standby starts up.
+     *
+     * @returns An error message, or an empty string if replication started.
+     */
+    string startPrimary(const string& path, int waitSeconds = 10) {
+        #ifdef UNIX_LIKE
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(address.sun_path)) {
+                return "The socket path \"" + path + "\" is too long.";
+            }
+            strcpy(address.sun_path, path.c_str());
+
+            auto deadline = chrono::steady_clock::now() + chrono::seconds(waitSeconds);
+            while (true) {
+                primary.socketFd = socket(AF_UNIX, SOCK_STREAM, 0);
+                if (primary.socketFd < 0) return "Unable to create a socket.";
+                if (connect(primary.socketFd, (sockaddr*) &address, sizeof(address)) == 0) break;
+
+                close(primary.socketFd);
+                primary.socketFd = -1;
+                if (chrono::steady_clock::now() >= deadline) {
+                    return "No standby is listening on \"" + path + "\".";
+                }
+                this_thread::sleep_for(chrono::milliseconds(100));
+            }
+
+            // a lost standby must not kill the primary
+            signal(SIGPIPE, SIG_IGN);
+
+            // The standby starts from a copy of the current layout
+            seatrs::Change change;
+            change.kind = seatrs::RESIZE;
+            change.row = seatrs::data::totalRows;
+            change.column = seatrs::data::totalColumns;
+            encodeChange(primary.queue, ++primary.queuedUpTo, nowMicros(), change);
+
+            if (seatrs::data::totalSeats != seatrs::data::totalRows * seatrs::data::totalColumns) {
+                change = seatrs::Change();
+                change.kind = seatrs::SHAPE;
+                change.row = seatrs::data::totalRows;
+                change.column = seatrs::data::totalColumns;
+                change.name = seatrs::describeShape();
+                encodeChange(primary.queue, ++primary.queuedUpTo, nowMicros(), change);
+            }
+
+            if (!seatrs::data::sections.empty()) {
+                change = seatrs::Change();
+                change.kind = seatrs::SECTIONS;
+                change.name = seatrs::describeSections();
+                encodeChange(primary.queue, ++primary.queuedUpTo, nowMicros(), change);
+            }
+
+            for (int irow = 0; irow < seatrs::data::totalRows; irow++) {
+                for (int icol = 0; icol < seatrs::data::totalColumns; icol++) {
+                    size_t index = (size_t) irow * seatrs::data::totalColumns + icol;
+                    if (seatrs::data::tiers[index] || seatrs::data::prices[index] || seatrs::data::features[index]) {
+                        change = seatrs::Change();
+                        change.kind = seatrs::ATTRIBUTES;
+                        change.row = change.lastRow = irow;
+                        change.column = change.lastColumn = icol;
+                        change.tier = seatrs::data::tiers[index];
+                        change.price = seatrs::data::prices[index];
+                        change.features = seatrs::data::features[index];
+                        encodeChange(primary.queue, ++primary.queuedUpTo, nowMicros(), change);
+                    }
+
+                    const seatrs::Seat& seat = seatrs::data::seats[irow][icol];
+                    if (seat.isReserved) {
+                        change = seatrs::Change();
+                        change.kind = seat.isHeld ? seatrs::HOLD : seatrs::RESERVE;
+                        change.row = irow;
+                        change.column = icol;
+                        change.name = seat.name;
+                        change.description = seat.description;
+                        encodeChange(primary.queue, ++primary.queuedUpTo, nowMicros(), change);
+                    }
+                }
+            }
+            primary.committed = primary.queuedUpTo;
+
+            seatrs::changeListeners.push_back([](const seatrs::Change& change) {
+                if (!primary.connected) return;
+
+                int64_t committedAt = nowMicros();
+                bool wasEmpty;
+                {
+                    lock_guard<mutex> lock(primary.queueMutex);
+                    wasEmpty = primary.queue.empty();
+                    encodeChange(primary.queue, ++primary.queuedUpTo, committedAt, change);
+                    primary.committed = primary.queuedUpTo;
+                }
+
+                // the shipper only sleeps on an empty queue, so later changes need no wake-up
+                if (wasEmpty) primary.queueReady.notify_one();
+            });
+
+            primary.active = true;
+            primary.connected = true;
+            primary.shipper = thread(shipChanges);
+            return "";
+        #else
+            return "Replication requires a Unix-like system.";
+        #endif
+    }
+
+    /**
+     * Ships whatever is still queued, then stops replication and disconnects.
+     */
+    void stopPrimary() {
+        #ifdef UNIX_LIKE
+            if (!primary.active) return;
+
+            {
+                lock_guard<mutex> lock(primary.queueMutex);
+                primary.stopping = true;
+            }
+            primary.queueReady.notify_one();
+            primary.shipper.join();
+
+            // ships the records queued after the shipper's last batch
+            size_t sent = 0;
+            while (primary.connected && sent < primary.queue.size()) {
+                ssize_t count = send(primary.socketFd, primary.queue.data() + sent, primary.queue.size() - sent, 0);
+                if (count <= 0) break;
+                sent += count;
+            }
+
+            close(primary.socketFd);
+            primary.active = false;
+            primary.connected = false;
+        #endif
+    }
+
+    /**
+     * Describes the state of replication for the HUD.
+     *
+     * @returns A one-line summary, or an empty string if this process is not a primary.
+     */
+    string primaryStatus() {
+        if (!primary.active) return "";
+
+        uint64_t committed = primary.committed, acknowledged = primary.acknowledged;
+        if (!primary.connected) {
+            return "Standby lost, " + to_string(committed - acknowledged) + " changes not replicated";
+        }
+
+        ostringstream status;
+        status.setf(ios::fixed);
+        status.precision(2);
+        status << "Standby: " << (committed - acknowledged) << " behind, lag "
+            << (primary.lagMicros / 1000.0) << " ms (max " << (primary.maxLagMicros / 1000.0) << " ms)";
+        return status.str();
+    }
+}
+
+namespace feed {
+
+    // The kind of a record telling the subscriber that records were lost, so it
+    // must load the whole layout again. Its sequence number is the last one lost.
+    const int GAP = 0;
+
+    const size_t ringCapacity = 1 << 16;
+
+    /**
+     * A slot of the ring, holding one record encoded by replication::encodeChange().
+     */
+    struct Slot {
+        uint64_t sequence = 0;
+        string record;
+    };
+
+    /**
+     * A single-producer, single-consumer ring of records. The thread that changes the
+     * seats is the producer and only moves head; the publisher thread is the consumer
+     * and only moves tail, once the subscriber has acknowledged the records. Neither
+     * side ever waits on the other: a full ring drops records and sends a GAP later.
+     */
+    struct Ring {
+        vector<Slot> slots = vector<Slot>(ringCapacity);
+        atomic<uint64_t> head{0};           // position of the next record to write
+        atomic<uint64_t> tail{0};           // position of the oldest record not acknowledged
+    };
+
+    namespace data {
+        Ring ring;
+        uint64_t lastSequence = 0;          // of the last change, written by the producer only
+        uint64_t firstLost = 0;             // of the first change dropped since the last GAP, or 0
+        atomic<uint64_t> published{0};      // lastSequence, for the publisher thread
+
+        int listenFd = -1;
+        int wakeFds[2] = {-1, -1};          // wakes the publisher when it sleeps on an empty ring
+        atomic<bool> sleeping{false};
+        atomic<bool> stopping{false};
+        atomic<bool> connected{false};
+        atomic<uint64_t> acknowledged{0};
+        atomic<uint64_t> lost{0};
+        string path;
+        thread publisher;
+        bool active = false;
+    }
+
+    /**
+     * Writes a record into the ring.
+     *
+     * @returns false if the ring is full.
+     */
+    bool push(uint64_t sequence, const seatrs::Change& change) {
+        uint64_t head = data::ring.head.load(memory_order_relaxed);
+        if (head - data::ring.tail.load(memory_order_acquire) >= ringCapacity) return false;
+
+        Slot& slot = data::ring.slots[head & (ringCapacity - 1)];
+        slot.sequence = sequence;
+        slot.record.clear();
+        replication::encodeChange(slot.record, sequence, replication::nowMicros(), change);
+        data::ring.head.store(head + 1, memory_order_release);
+        return true;
+    }
+
+    /**
+     * Gives every committed change the next sequence number and writes it into the
+     * ring. Changes that find the ring full are dropped, and the first record written
+     * after them is a GAP covering them.
+     */
+    void onChange(const seatrs::Change& change) {
+        uint64_t sequence = ++data::lastSequence;
+
+        if (data::firstLost != 0) {
+            seatrs::Change gap;
+            gap.kind = (seatrs::ChangeKind) GAP;
+            if (!push(sequence - 1, gap) || !push(sequence, change)) {
+                data::lost++;
+                data::published.store(sequence);
+                return;
+            }
+            data::firstLost = 0;
+        } else if (!push(sequence, change)) {
+            data::firstLost = sequence;
+            data::lost++;
+        }
+        data::published.store(sequence);
+
+        if (data::sleeping.load() && data::sleeping.exchange(false)) {
+            #ifdef UNIX_LIKE
+                char wake = 1;
+                write(data::wakeFds[1], &wake, 1);
+            #endif
+        }
+    }
+
+    /**
+     * Frees the records up to a sequence number the subscriber acknowledged.
+     */
+    void acknowledge(uint64_t sequence) {
+        uint64_t tail = data::ring.tail.load(memory_order_relaxed);
+        uint64_t head = data::ring.head.load(memory_order_acquire);
+        while (tail < head && data::ring.slots[tail & (ringCapacity - 1)].sequence <= sequence) tail++;
+        data::ring.tail.store(tail, memory_order_release);
+        data::acknowledged = max(data::acknowledged.load(), sequence);
+    }
+
+    #ifdef UNIX_LIKE
+        /**
+         * Sends all of a buffer, waiting while the subscriber's socket is full.
+         *
+         * @returns false if the subscriber is lost or the feed is stopping.
+         */
+        bool sendAll(int fd, const string& bytes) {
+            size_t sent = 0;
+            while (sent < bytes.size()) {
+                ssize_t count = send(fd, bytes.data() + sent, bytes.size() - sent, MSG_DONTWAIT);
+                if (count > 0) {
+                    sent += count;
+                } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    if (data::stopping) return false;
+                    pollfd writable = {fd, POLLOUT, 0};
+                    poll(&writable, 1, 100);
+                } else if (count < 0 && errno == EINTR) {
+                    continue;
+                } else {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Serves one subscriber. It first sends "RESUME <sequence>" with the last
+         * sequence number it has, and "ACK <sequence>" lines as it goes; records it
+         * acknowledged cannot be sent again.
+         */
+        void serve(int fd) {
+            string received;
+            uint64_t position = 0;          // of the next record to send
+            uint64_t sentUpTo = 0;          // sequence number of the last record sent
+            bool resumed = false;
+            char buffer[512];
+
+            while (!data::stopping) {
+                ssize_t count;
+                while ((count = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) received.append(buffer, count);
+                if (count == 0) return;
+
+                size_t end;
+                while ((end = received.find('\n')) != string::npos) {
+                    istringstream line(received.substr(0, end));
+                    received.erase(0, end + 1);
+
+                    string command;
+                    uint64_t sequence;
+                    if (!(line >> command >> sequence)) continue;
+
+                    if (command == "RESUME") {
+                        acknowledge(sequence);
+                        position = data::ring.tail.load();
+                        resumed = true;
+
+                        // the records after the subscriber's sequence number are gone
+                        uint64_t oldest = (position < data::ring.head.load())
+                            ? data::ring.slots[position & (ringCapacity - 1)].sequence
+                            : data::published.load() + 1;
+                        if (sequence + 1 < oldest || sequence > data::published.load()) {
+                            string gap;
+                            seatrs::Change change;
+                            change.kind = (seatrs::ChangeKind) GAP;
+                            replication::encodeChange(gap, oldest - 1, replication::nowMicros(), change);
+                            if (!sendAll(fd, gap)) return;
+                        }
+                        sentUpTo = oldest - 1;
+                    } else if (command == "ACK") {
+                        acknowledge(sequence);
+                    }
+                }
+                if (!resumed) {
+                    pollfd readable = {fd, POLLIN, 0};
+                    poll(&readable, 1, 100);
+                    continue;
+                }
+
+                uint64_t head = data::ring.head.load(memory_order_acquire);
+                if (position < head) {
+                    // Sends what has queued up as one batch
+                    string batch;
+                    for (; position < head && batch.size() < 65536; position++) {
+                        const Slot& slot = data::ring.slots[position & (ringCapacity - 1)];
+                        // a GAP already sent from the check below
+                        if (slot.sequence <= sentUpTo) continue;
+                        batch += slot.record;
+                        sentUpTo = slot.sequence;
+                    }
+                    if (!sendAll(fd, batch)) return;
+                    continue;
+                }
+
+                // Changes published but not in the ring were dropped while it was full.
+                // The producer only sends their GAP with its next change, so it is sent now.
+                uint64_t published = data::published.load();
+                if (published > sentUpTo && data::ring.head.load() == head) {
+                    string gap;
+                    seatrs::Change change;
+                    change.kind = (seatrs::ChangeKind) GAP;
+                    replication::encodeChange(gap, published, replication::nowMicros(), change);
+                    if (!sendAll(fd, gap)) return;
+                    sentUpTo = published;
+                    continue;
+                }
+
+                data::sleeping = true;
+                if (data::ring.head.load() != head) {
+                    data::sleeping = false;
+                    continue;
+                }
+                pollfd ready[2] = {{fd, POLLIN, 0}, {data::wakeFds[0], POLLIN, 0}};
+                poll(ready, 2, 100);
+                if (ready[1].revents & POLLIN) {
+                    char drained[64];
+                    while (read(data::wakeFds[0], drained, sizeof(drained)) > 0) {}
+                }
+                data::sleeping = false;
+            }
+        }
+
+        /**
+         * Accepts subscribers one at a time until the feed stops.
+         */
+        void publish() {
+            while (!data::stopping) {
+                pollfd listening = {data::listenFd, POLLIN, 0};
+                if (poll(&listening, 1, 100) <= 0) continue;
+
+                int fd = accept(data::listenFd, nullptr, nullptr);
+                if (fd < 0) continue;
+
+                data::connected = true;
+                serve(fd);
+                data::connected = false;
+                close(fd);
+            }
+        }
+    #endif
+
+    /**
+     * Starts publishing every committed change on a local socket, numbered from 1.
+     *
+     * @param path The path of the socket to create.
+     *
+     * @returns An error message, or an empty string if the feed started.
+     */
+    string startFeed(const string& path) {
+        #ifdef UNIX_LIKE
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(address.sun_path)) {
+                return "The socket path \"" + path + "\" is too long.";
+            }
+            strcpy(address.sun_path, path.c_str());
+
+            unlink(path.c_str());
+            data::listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (data::listenFd < 0) return "Unable to create a socket.";
+            if (bind(data::listenFd, (sockaddr*) &address, sizeof(address)) != 0 || listen(data::listenFd, 4) != 0) {
+                close(data::listenFd);
+                return "Unable to listen on \"" + path + "\".";
+            }
+            if (pipe(data::wakeFds) != 0) {
+                close(data::listenFd);
+                return "Unable to create a pipe.";
+            }
+            fcntl(data::wakeFds[0], F_SETFL, O_NONBLOCK);
+            fcntl(data::wakeFds[1], F_SETFL, O_NONBLOCK);
+
+            // a lost subscriber must not kill the program
+            signal(SIGPIPE, SIG_IGN);
+
+            data::path = path;
+            seatrs::changeListeners.push_back(onChange);
+            data::active = true;
+            data::publisher = thread(publish);
+            return "";
+        #else
+            return "The change feed requires a Unix-like system.";
+        #endif
+    }
+
+    /**
+     * Stops the feed and removes its socket.
+     */
+    void stopFeed() {
+        #ifdef UNIX_LIKE
+            if (!data::active) return;
+            data::stopping = true;
+            data::publisher.join();
+            close(data::listenFd);
+            close(data::wakeFds[0]);
+            close(data::wakeFds[1]);
+            unlink(data::path.c_str());
+            data::active = false;
+        #endif
+    }
+
+    /**
+     * Describes the state of the feed for the HUD.
+     *
+     * @returns A one-line summary, or an empty string if there is no feed.
+     */
+    string feedStatus() {
+        if (!data::active) return "";
+
+        string status = "Feed: " + to_string(data::published.load()) + " changes, ";
+        status += data::connected ? to_string(data::published.load() - data::acknowledged.load()) + " not acknowledged" : "no subscriber";
+        if (data::lost > 0) status += ", " + to_string(data::lost.load()) + " lost";
+        return status;
+    }
+
+    /**
+     * Gets the name of the kind of a record, as printed by subscribe().
+     */
+    string kindName(int kind) {
+        switch (kind) {
+            case GAP: return "GAP";
+            case seatrs::RESERVE: return "CREATE";
+            case seatrs::UPDATE: return "UPDATE";
+            case seatrs::CANCEL: return "DELETE";
+            case seatrs::RESIZE: return "RESIZE";
+            case seatrs::ATTRIBUTES: return "ATTRIBUTES";
+            case seatrs::SHAPE: return "SHAPE";
+            case seatrs::HOLD: return "HOLD";
+            case seatrs::SECTIONS: return "SECTIONS";
+            default: return "UNKNOWN";
+        }
+    }
+
+    /**
+     * Subscribes to a feed and prints a line for every record, acknowledging them as
+     * they are printed, until the feed ends.
+     *
+     * @param path The path of the feed's socket.
+     * @param from The last sequence number already seen, to resume after it.
+     * @param limit The number of records to print before leaving, or 0 for no limit.
+     *
+     * @returns The exit code of the program.
+     */
+    int subscribe(const string& path, uint64_t from, uint64_t limit) {
+        #ifdef UNIX_LIKE
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(address.sun_path)) {
+                cerr << "The socket path \"" << path << "\" is too long." << endl;
+                return 1;
+            }
+            strcpy(address.sun_path, path.c_str());
+
+            int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0 || connect(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+                cerr << "No feed is published on \"" << path << "\"." << endl;
+                return 1;
+            }
+
+            string request = "RESUME " + to_string(from) + "\n";
+            send(fd, request.data(), request.size(), 0);
+
+            string received;
+            char buffer[65536];
+            uint64_t printed = 0;
+            ssize_t count;
+            while ((limit == 0 || printed < limit) && (count = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+                received.append(buffer, count);
+
+                size_t offset = 0;
+                uint64_t sequence = 0;
+                int64_t committedAt;
+                seatrs::Change change;
+                bool any = false;
+                while ((limit == 0 || printed < limit) && replication::decodeChange(received, offset, sequence, committedAt, change)) {
+                    cout << sequence << ' ' << kindName(change.kind) << ' ' << change.row << ' ' << change.column;
+                    if (!change.name.empty()) cout << ' ' << change.name;
+                    cout << '\n';
+                    printed++;
+                    any = true;
+                }
+                received.erase(0, offset);
+                cout.flush();
+
+                if (any) {
+                    string acknowledgement = "ACK " + to_string(sequence) + "\n";
+                    send(fd, acknowledgement.data(), acknowledgement.size(), 0);
+                }
+            }
+            close(fd);
+            return 0;
+        #else
+            cerr << "The change feed requires a Unix-like system." << endl;
+            return 1;
+        #endif
+    }
+}
+
+namespace utils {
+
+    namespace memory {
+        /**
+         * A scratch arena for the temporary allocations made while building a frame.
+         * Allocations bump through a fixed buffer and are all reclaimed at once by
+         * reset(). Once the buffer is full, allocations fall back to the heap and are
+         * freed as usual, so memory stays bounded even if a reset never comes.
+         */
+        struct ScratchArena : pmr::memory_resource {
+            alignas(max_align_t) char buffer[64 * 1024];
+            size_t used = 0;
+            size_t peakUsed = 0;            // most bytes used between two resets
+            uint64_t allocations = 0;
+            uint64_t fallbacks = 0;         // allocations that did not fit and went to the heap
+            uint64_t resets = 0;
+
+            void* do_allocate(size_t bytes, size_t alignment) override {
+                size_t start = (used + alignment - 1) & ~(alignment - 1);
+                if (start + bytes > sizeof(buffer)) {
+                    fallbacks++;
+                    return pmr::new_delete_resource()->allocate(bytes, alignment);
+                }
+
+                used = start + bytes;
+                peakUsed = max(peakUsed, used);
+                allocations++;
+                return buffer + start;
+            }
+
+            void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+                // memory from the buffer is only reclaimed by reset()
+                if (pointer >= (void*) buffer && pointer < (void*) (buffer + sizeof(buffer))) return;
+                pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+            }
+
+            bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+                return this == &other;
+            }
+
+            /**
+             * Reclaims everything allocated from the buffer. Nothing allocated from the
+             * arena may be in use anymore.
+             */
+            void reset() {
+                used = 0;
+                resets++;
+            }
+        } frameScratch;
+
+        /**
+         * Gets the resident set size of this process.
+         *
+         * @returns The size in bytes, or 0 if it cannot be read on this system.
+         */
+        size_t residentBytes() {
+            #if defined(__linux__)
+                ifstream statm("/proc/self/statm");
+                size_t pages = 0, residentPages = 0;
+                statm >> pages >> residentPages;
+                return residentPages * (size_t) sysconf(_SC_PAGESIZE);
+            #else
+                return 0;
+            #endif
+        }
+    }
+
+    namespace format {
+
+        /**
+         * Repeat a given string a given number of times.
+         *
+         * @param num The number of times to repeat the string.
+         * @param text The string to repeat.
+         *
+         * @returns A string consisting of the given string repeated the
+         *          given number of times.
+         */
+        string repeatText(int num, string text) {
+            string result;
+            result.reserve(num > 0 ? num * text.length() : 0);
+            for (int i = 0; i < num; i++) {
+                result += text;
+            }
+            return result;
+        }
+        
+        /**
+         * Repeat a given char a given number of times.
+         *
+         * @param num The number of times to repeat the character.
+         * @param text The character to repeat.
+         *
+         * @returns A string consisting of the given character repeated the
+         *          given number of times.
+         */
+        string repeatText(int num, char text) {
+            return string(num, text);
+        }
+
+        /**
+         * Checks if a run of bytes is plain ASCII, 16 bytes at a time with SSE2 when
+         * available, otherwise 8 bytes at a time.
+         *
+         * @param text The bytes to check.
+         * @param length The number of bytes to check.
+         *
+         * @returns true if no byte has its high bit set, false otherwise.
+         */
+        bool isASCII(const char* text, size_t length) {
+            size_t i = 0;
+
+            #ifdef __SSE2__
+                for (; i + 16 <= length; i += 16) {
+                    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+                    if (_mm_movemask_epi8(chunk) != 0) return false;
+                }
+            #endif
+
+            for (; i + 8 <= length; i += 8) {
+                uint64_t chunk;
+                memcpy(&chunk, text + i, 8);
+                if (chunk & 0x8080808080808080ULL) return false;
+            }
+
+            for (; i < length; i++) {
+                if (text[i] & 0x80) return false;
+            }
+
+            return true;
+        }
+
+        struct WidthRange {
+            char32_t first, last;
+            int width;
+        };
+
+        // Unicode ranges that do not take exactly one column, sorted by code point and
+        // generated from the Unicode 14.0 character database (EastAsianWidth.txt and the
+        // general categories), not listed by hand:
+        //   - nonspacing and enclosing marks (Mn, Me) and format characters (Cf) other
+        //     than the soft hyphen take none, and so do the conjoining Hangul vowels
+        //     and final consonants (1160..11FF, D7B0..D7FF);
+        //   - wide and fullwidth characters (W, F) take two, and so do the unassigned
+        //     code points of the ideograph planes (20000..3FFFD);
+        //   - every other code point, including unassigned ones, takes one.
+        constexpr WidthRange widthRanges[] = {
+            {0x0300, 0x036F, 0}, {0x0483, 0x0489, 0}, {0x0591, 0x05BD, 0}, {0x05BF, 0x05BF, 0},
+            {0x05C1, 0x05C2, 0}, {0x05C4, 0x05C5, 0}, {0x05C7, 0x05C7, 0}, {0x0600, 0x0605, 0},
+            {0x0610, 0x061A, 0}, {0x061C, 0x061C, 0}, {0x064B, 0x065F, 0}, {0x0670, 0x0670, 0},
+            {0x06D6, 0x06DD, 0}, {0x06DF, 0x06E4, 0}, {0x06E7, 0x06E8, 0}, {0x06EA, 0x06ED, 0},
+            {0x070F, 0x070F, 0}, {0x0711, 0x0711, 0}, {0x0730, 0x074A, 0}, {0x07A6, 0x07B0, 0},
+            {0x07EB, 0x07F3, 0}, {0x07FD, 0x07FD, 0}, {0x0816, 0x0819, 0}, {0x081B, 0x0823, 0},
+            {0x0825, 0x0827, 0}, {0x0829, 0x082D, 0}, {0x0859, 0x085B, 0}, {0x0890, 0x0891, 0},
+            {0x0898, 0x089F, 0}, {0x08CA, 0x0902, 0}, {0x093A, 0x093A, 0}, {0x093C, 0x093C, 0},
+            {0x0941, 0x0948, 0}, {0x094D, 0x094D, 0}, {0x0951, 0x0957, 0}, {0x0962, 0x0963, 0},
+            {0x0981, 0x0981, 0}, {0x09BC, 0x09BC, 0}, {0x09C1, 0x09C4, 0}, {0x09CD, 0x09CD, 0},
+            {0x09E2, 0x09E3, 0}, {0x09FE, 0x09FE, 0}, {0x0A01, 0x0A02, 0}, {0x0A3C, 0x0A3C, 0},
+            {0x0A41, 0x0A42, 0}, {0x0A47, 0x0A48, 0}, {0x0A4B, 0x0A4D, 0}, {0x0A51, 0x0A51, 0},
+            {0x0A70, 0x0A71, 0}, {0x0A75, 0x0A75, 0}, {0x0A81, 0x0A82, 0}, {0x0ABC, 0x0ABC, 0},
+            {0x0AC1, 0x0AC5, 0}, {0x0AC7, 0x0AC8, 0}, {0x0ACD, 0x0ACD, 0}, {0x0AE2, 0x0AE3, 0},
+            {0x0AFA, 0x0AFF, 0}, {0x0B01, 0x0B01, 0}, {0x0B3C, 0x0B3C, 0}, {0x0B3F, 0x0B3F, 0},
+            {0x0B41, 0x0B44, 0}, {0x0B4D, 0x0B4D, 0}, {0x0B55, 0x0B56, 0}, {0x0B62, 0x0B63, 0},
+            {0x0B82, 0x0B82, 0}, {0x0BC0, 0x0BC0, 0}, {0x0BCD, 0x0BCD, 0}, {0x0C00, 0x0C00, 0},
+            {0x0C04, 0x0C04, 0}, {0x0C3C, 0x0C3C, 0}, {0x0C3E, 0x0C40, 0}, {0x0C46, 0x0C48, 0},
+            {0x0C4A, 0x0C4D, 0}, {0x0C55, 0x0C56, 0}, {0x0C62, 0x0C63, 0}, {0x0C81, 0x0C81, 0},
+            {0x0CBC, 0x0CBC, 0}, {0x0CBF, 0x0CBF, 0}, {0x0CC6, 0x0CC6, 0}, {0x0CCC, 0x0CCD, 0},
+            {0x0CE2, 0x0CE3, 0}, {0x0D00, 0x0D01, 0}, {0x0D3B, 0x0D3C, 0}, {0x0D41, 0x0D44, 0},
+            {0x0D4D, 0x0D4D, 0}, {0x0D62, 0x0D63, 0}, {0x0D81, 0x0D81, 0}, {0x0DCA, 0x0DCA, 0},
+            {0x0DD2, 0x0DD4, 0}, {0x0DD6, 0x0DD6, 0}, {0x0E31, 0x0E31, 0}, {0x0E34, 0x0E3A, 0},
+            {0x0E47, 0x0E4E, 0}, {0x0EB1, 0x0EB1, 0}, {0x0EB4, 0x0EBC, 0}, {0x0EC8, 0x0ECD, 0},
+            {0x0F18, 0x0F19, 0}, {0x0F35, 0x0F35, 0}, {0x0F37, 0x0F37, 0}, {0x0F39, 0x0F39, 0},
+            {0x0F71, 0x0F7E, 0}, {0x0F80, 0x0F84, 0}, {0x0F86, 0x0F87, 0}, {0x0F8D, 0x0F97, 0},
+            {0x0F99, 0x0FBC, 0}, {0x0FC6, 0x0FC6, 0}, {0x102D, 0x1030, 0}, {0x1032, 0x1037, 0},
+            {0x1039, 0x103A, 0}, {0x103D, 0x103E, 0}, {0x1058, 0x1059, 0}, {0x105E, 0x1060, 0},
+            {0x1071, 0x1074, 0}, {0x1082, 0x1082, 0}, {0x1085, 0x1086, 0}, {0x108D, 0x108D, 0},
+            {0x109D, 0x109D, 0}, {0x1100, 0x115F, 2}, {0x1160, 0x11FF, 0}, {0x135D, 0x135F, 0},
+            {0x1712, 0x1714, 0}, {0x1732, 0x1733, 0}, {0x1752, 0x1753, 0}, {0x1772, 0x1773, 0},
+            {0x17B4, 0x17B5, 0}, {0x17B7, 0x17BD, 0}, {0x17C6, 0x17C6, 0}, {0x17C9, 0x17D3, 0},
+            {0x17DD, 0x17DD, 0}, {0x180B, 0x180F, 0}, {0x1885, 0x1886, 0}, {0x18A9, 0x18A9, 0},
+            {0x1920, 0x1922, 0}, {0x1927, 0x1928, 0}, {0x1932, 0x1932, 0}, {0x1939, 0x193B, 0},
+            {0x1A17, 0x1A18, 0}, {0x1A1B, 0x1A1B, 0}, {0x1A56, 0x1A56, 0}, {0x1A58, 0x1A5E, 0},
+            {0x1A60, 0x1A60, 0}, {0x1A62, 0x1A62, 0}, {0x1A65, 0x1A6C, 0}, {0x1A73, 0x1A7C, 0},
+            {0x1A7F, 0x1A7F, 0}, {0x1AB0, 0x1ACE, 0}, {0x1B00, 0x1B03, 0}, {0x1B34, 0x1B34, 0},
+            {0x1B36, 0x1B3A, 0}, {0x1B3C, 0x1B3C, 0}, {0x1B42, 0x1B42, 0}, {0x1B6B, 0x1B73, 0},
+            {0x1B80, 0x1B81, 0}, {0x1BA2, 0x1BA5, 0}, {0x1BA8, 0x1BA9, 0}, {0x1BAB, 0x1BAD, 0},
+            {0x1BE6, 0x1BE6, 0}, {0x1BE8, 0x1BE9, 0}, {0x1BED, 0x1BED, 0}, {0x1BEF, 0x1BF1, 0},
+            {0x1C2C, 0x1C33, 0}, {0x1C36, 0x1C37, 0}, {0x1CD0, 0x1CD2, 0}, {0x1CD4, 0x1CE0, 0},
+            {0x1CE2, 0x1CE8, 0}, {0x1CED, 0x1CED, 0}, {0x1CF4, 0x1CF4, 0}, {0x1CF8, 0x1CF9, 0},
+            {0x1DC0, 0x1DFF, 0}, {0x200B, 0x200F, 0}, {0x202A, 0x202E, 0}, {0x2060, 0x2064, 0},
+            {0x2066, 0x206F, 0}, {0x20D0, 0x20F0, 0}, {0x231A, 0x231B, 2}, {0x2329, 0x232A, 2},
+            {0x23E9, 0x23EC, 2}, {0x23F0, 0x23F0, 2}, {0x23F3, 0x23F3, 2}, {0x25FD, 0x25FE, 2},
+            {0x2614, 0x2615, 2}, {0x2648, 0x2653, 2}, {0x267F, 0x267F, 2}, {0x2693, 0x2693, 2},
+            {0x26A1, 0x26A1, 2}, {0x26AA, 0x26AB, 2}, {0x26BD, 0x26BE, 2}, {0x26C4, 0x26C5, 2},
+            {0x26CE, 0x26CE, 2}, {0x26D4, 0x26D4, 2}, {0x26EA, 0x26EA, 2}, {0x26F2, 0x26F3, 2},
+            {0x26F5, 0x26F5, 2}, {0x26FA, 0x26FA, 2}, {0x26FD, 0x26FD, 2}, {0x2705, 0x2705, 2},
+            {0x270A, 0x270B, 2}, {0x2728, 0x2728, 2}, {0x274C, 0x274C, 2}, {0x274E, 0x274E, 2},
+            {0x2753, 0x2755, 2}, {0x2757, 0x2757, 2}, {0x2795, 0x2797, 2}, {0x27B0, 0x27B0, 2},
+            {0x27BF, 0x27BF, 2}, {0x2B1B, 0x2B1C, 2}, {0x2B50, 0x2B50, 2}, {0x2B55, 0x2B55, 2},
+            {0x2CEF, 0x2CF1, 0}, {0x2D7F, 0x2D7F, 0}, {0x2DE0, 0x2DFF, 0}, {0x2E80, 0x2E99, 2},
+            {0x2E9B, 0x2EF3, 2}, {0x2F00, 0x2FD5, 2}, {0x2FF0, 0x2FFB, 2}, {0x3000, 0x3029, 2},
+            {0x302A, 0x302D, 0}, {0x302E, 0x303E, 2}, {0x3041, 0x3096, 2}, {0x3099, 0x309A, 0},
+            {0x309B, 0x30FF, 2}, {0x3105, 0x312F, 2}, {0x3131, 0x318E, 2}, {0x3190, 0x31E3, 2},
+            {0x31F0, 0x321E, 2}, {0x3220, 0x3247, 2}, {0x3250, 0x4DBF, 2}, {0x4E00, 0xA48C, 2},
+            {0xA490, 0xA4C6, 2}, {0xA66F, 0xA672, 0}, {0xA674, 0xA67D, 0}, {0xA69E, 0xA69F, 0},
+            {0xA6F0, 0xA6F1, 0}, {0xA802, 0xA802, 0}, {0xA806, 0xA806, 0}, {0xA80B, 0xA80B, 0},
+            {0xA825, 0xA826, 0}, {0xA82C, 0xA82C, 0}, {0xA8C4, 0xA8C5, 0}, {0xA8E0, 0xA8F1, 0},
+            {0xA8FF, 0xA8FF, 0}, {0xA926, 0xA92D, 0}, {0xA947, 0xA951, 0}, {0xA960, 0xA97C, 2},
+            {0xA980, 0xA982, 0}, {0xA9B3, 0xA9B3, 0}, {0xA9B6, 0xA9B9, 0}, {0xA9BC, 0xA9BD, 0},
+            {0xA9E5, 0xA9E5, 0}, {0xAA29, 0xAA2E, 0}, {0xAA31, 0xAA32, 0}, {0xAA35, 0xAA36, 0},
+            {0xAA43, 0xAA43, 0}, {0xAA4C, 0xAA4C, 0}, {0xAA7C, 0xAA7C, 0}, {0xAAB0, 0xAAB0, 0},
+            {0xAAB2, 0xAAB4, 0}, {0xAAB7, 0xAAB8, 0}, {0xAABE, 0xAABF, 0}, {0xAAC1, 0xAAC1, 0},
+            {0xAAEC, 0xAAED, 0}, {0xAAF6, 0xAAF6, 0}, {0xABE5, 0xABE5, 0}, {0xABE8, 0xABE8, 0},
+            {0xABED, 0xABED, 0}, {0xAC00, 0xD7A3, 2}, {0xD7B0, 0xD7FF, 0}, {0xF900, 0xFA6D, 2},
+            {0xFA70, 0xFAD9, 2}, {0xFB1E, 0xFB1E, 0}, {0xFE00, 0xFE0F, 0}, {0xFE10, 0xFE19, 2},
+            {0xFE20, 0xFE2F, 0}, {0xFE30, 0xFE52, 2}, {0xFE54, 0xFE66, 2}, {0xFE68, 0xFE6B, 2},
+            {0xFEFF, 0xFEFF, 0}, {0xFF01, 0xFF60, 2}, {0xFFE0, 0xFFE6, 2}, {0xFFF9, 0xFFFB, 0},
+            {0x101FD, 0x101FD, 0}, {0x102E0, 0x102E0, 0}, {0x10376, 0x1037A, 0}, {0x10A01, 0x10A03, 0},
+            {0x10A05, 0x10A06, 0}, {0x10A0C, 0x10A0F, 0}, {0x10A38, 0x10A3A, 0}, {0x10A3F, 0x10A3F, 0},
+            {0x10AE5, 0x10AE6, 0}, {0x10D24, 0x10D27, 0}, {0x10EAB, 0x10EAC, 0}, {0x10F46, 0x10F50, 0},
+            {0x10F82, 0x10F85, 0}, {0x11001, 0x11001, 0}, {0x11038, 0x11046, 0}, {0x11070, 0x11070, 0},
+            {0x11073, 0x11074, 0}, {0x1107F, 0x11081, 0}, {0x110B3, 0x110B6, 0}, {0x110B9, 0x110BA, 0},
+            {0x110BD, 0x110BD, 0}, {0x110C2, 0x110C2, 0}, {0x110CD, 0x110CD, 0}, {0x11100, 0x11102, 0},
+            {0x11127, 0x1112B, 0}, {0x1112D, 0x11134, 0}, {0x11173, 0x11173, 0}, {0x11180, 0x11181, 0},
+            {0x111B6, 0x111BE, 0}, {0x111C9, 0x111CC, 0}, {0x111CF, 0x111CF, 0}, {0x1122F, 0x11231, 0},
+            {0x11234, 0x11234, 0}, {0x11236, 0x11237, 0}, {0x1123E, 0x1123E, 0}, {0x112DF, 0x112DF, 0},
+            {0x112E3, 0x112EA, 0}, {0x11300, 0x11301, 0}, {0x1133B, 0x1133C, 0}, {0x11340, 0x11340, 0},
+            {0x11366, 0x1136C, 0}, {0x11370, 0x11374, 0}, {0x11438, 0x1143F, 0}, {0x11442, 0x11444, 0},
+            {0x11446, 0x11446, 0}, {0x1145E, 0x1145E, 0}, {0x114B3, 0x114B8, 0}, {0x114BA, 0x114BA, 0},
+            {0x114BF, 0x114C0, 0}, {0x114C2, 0x114C3, 0}, {0x115B2, 0x115B5, 0}, {0x115BC, 0x115BD, 0},
+            {0x115BF, 0x115C0, 0}, {0x115DC, 0x115DD, 0}, {0x11633, 0x1163A, 0}, {0x1163D, 0x1163D, 0},
+            {0x1163F, 0x11640, 0}, {0x116AB, 0x116AB, 0}, {0x116AD, 0x116AD, 0}, {0x116B0, 0x116B5, 0},
+            {0x116B7, 0x116B7, 0}, {0x1171D, 0x1171F, 0}, {0x11722, 0x11725, 0}, {0x11727, 0x1172B, 0},
+            {0x1182F, 0x11837, 0}, {0x11839, 0x1183A, 0}, {0x1193B, 0x1193C, 0}, {0x1193E, 0x1193E, 0},
+            {0x11943, 0x11943, 0}, {0x119D4, 0x119D7, 0}, {0x119DA, 0x119DB, 0}, {0x119E0, 0x119E0, 0},
+            {0x11A01, 0x11A0A, 0}, {0x11A33, 0x11A38, 0}, {0x11A3B, 0x11A3E, 0}, {0x11A47, 0x11A47, 0},
+            {0x11A51, 0x11A56, 0}, {0x11A59, 0x11A5B, 0}, {0x11A8A, 0x11A96, 0}, {0x11A98, 0x11A99, 0},
+            {0x11C30, 0x11C36, 0}, {0x11C38, 0x11C3D, 0}, {0x11C3F, 0x11C3F, 0}, {0x11C92, 0x11CA7, 0},
+            {0x11CAA, 0x11CB0, 0}, {0x11CB2, 0x11CB3, 0}, {0x11CB5, 0x11CB6, 0}, {0x11D31, 0x11D36, 0},
+            {0x11D3A, 0x11D3A, 0}, {0x11D3C, 0x11D3D, 0}, {0x11D3F, 0x11D45, 0}, {0x11D47, 0x11D47, 0},
+            {0x11D90, 0x11D91, 0}, {0x11D95, 0x11D95, 0}, {0x11D97, 0x11D97, 0}, {0x11EF3, 0x11EF4, 0},
+            {0x13430, 0x13438, 0}, {0x16AF0, 0x16AF4, 0}, {0x16B30, 0x16B36, 0}, {0x16F4F, 0x16F4F, 0},
+            {0x16F8F, 0x16F92, 0}, {0x16FE0, 0x16FE3, 2}, {0x16FE4, 0x16FE4, 0}, {0x16FF0, 0x16FF1, 2},
+            {0x17000, 0x187F7, 2}, {0x18800, 0x18CD5, 2}, {0x18D00, 0x18D08, 2}, {0x1AFF0, 0x1AFF3, 2},
+            {0x1AFF5, 0x1AFFB, 2}, {0x1AFFD, 0x1AFFE, 2}, {0x1B000, 0x1B122, 2}, {0x1B150, 0x1B152, 2},
+            {0x1B164, 0x1B167, 2}, {0x1B170, 0x1B2FB, 2}, {0x1BC9D, 0x1BC9E, 0}, {0x1BCA0, 0x1BCA3, 0},
+            {0x1CF00, 0x1CF2D, 0}, {0x1CF30, 0x1CF46, 0}, {0x1D167, 0x1D169, 0}, {0x1D173, 0x1D182, 0},
+            {0x1D185, 0x1D18B, 0}, {0x1D1AA, 0x1D1AD, 0}, {0x1D242, 0x1D244, 0}, {0x1DA00, 0x1DA36, 0},
+            {0x1DA3B, 0x1DA6C, 0}, {0x1DA75, 0x1DA75, 0}, {0x1DA84, 0x1DA84, 0}, {0x1DA9B, 0x1DA9F, 0},
+            {0x1DAA1, 0x1DAAF, 0}, {0x1E000, 0x1E006, 0}, {0x1E008, 0x1E018, 0}, {0x1E01B, 0x1E021, 0},
+            {0x1E023, 0x1E024, 0}, {0x1E026, 0x1E02A, 0}, {0x1E130, 0x1E136, 0}, {0x1E2AE, 0x1E2AE, 0},
+            {0x1E2EC, 0x1E2EF, 0}, {0x1E8D0, 0x1E8D6, 0}, {0x1E944, 0x1E94A, 0}, {0x1F004, 0x1F004, 2},
+            {0x1F0CF, 0x1F0CF, 2}, {0x1F18E, 0x1F18E, 2}, {0x1F191, 0x1F19A, 2}, {0x1F200, 0x1F202, 2},
+            {0x1F210, 0x1F23B, 2}, {0x1F240, 0x1F248, 2}, {0x1F250, 0x1F251, 2}, {0x1F260, 0x1F265, 2},
+            {0x1F300, 0x1F320, 2}, {0x1F32D, 0x1F335, 2}, {0x1F337, 0x1F37C, 2}, {0x1F37E, 0x1F393, 2},
+            {0x1F3A0, 0x1F3CA, 2}, {0x1F3CF, 0x1F3D3, 2}, {0x1F3E0, 0x1F3F0, 2}, {0x1F3F4, 0x1F3F4, 2},
+            {0x1F3F8, 0x1F43E, 2}, {0x1F440, 0x1F440, 2}, {0x1F442, 0x1F4FC, 2}, {0x1F4FF, 0x1F53D, 2},
+            {0x1F54B, 0x1F54E, 2}, {0x1F550, 0x1F567, 2}, {0x1F57A, 0x1F57A, 2}, {0x1F595, 0x1F596, 2},
+            {0x1F5A4, 0x1F5A4, 2}, {0x1F5FB, 0x1F64F, 2}, {0x1F680, 0x1F6C5, 2}, {0x1F6CC, 0x1F6CC, 2},
+            {0x1F6D0, 0x1F6D2, 2}, {0x1F6D5, 0x1F6D7, 2}, {0x1F6DD, 0x1F6DF, 2}, {0x1F6EB, 0x1F6EC, 2},
+            {0x1F6F4, 0x1F6FC, 2}, {0x1F7E0, 0x1F7EB, 2}, {0x1F7F0, 0x1F7F0, 2}, {0x1F90C, 0x1F93A, 2},
+            {0x1F93C, 0x1F945, 2}, {0x1F947, 0x1F9FF, 2}, {0x1FA70, 0x1FA74, 2}, {0x1FA78, 0x1FA7C, 2},
+            {0x1FA80, 0x1FA86, 2}, {0x1FA90, 0x1FAAC, 2}, {0x1FAB0, 0x1FABA, 2}, {0x1FAC0, 0x1FAC5, 2},
+            {0x1FAD0, 0x1FAD9, 2}, {0x1FAE0, 0x1FAE7, 2}, {0x1FAF0, 0x1FAF6, 2}, {0x20000, 0x2FFFD, 2},
+            {0x30000, 0x3FFFD, 2}, {0xE0001, 0xE0001, 0}, {0xE0020, 0xE007F, 0}, {0xE0100, 0xE01EF, 0}
+        };
+
+        /**
+         * The widths of the Basic Multilingual Plane, generated at compile time from
+         * widthRanges and packed 2 bits per code point, so most code points are 
+         * measured without a search.
+         */
+        struct PlaneWidths {
+            uint8_t packed[0x10000 / 4] = {};
+
+            constexpr PlaneWidths() {
+                for (int i = 0; i < 0x10000 / 4; i++) {
+                    packed[i] = 0x55; // every code point takes 1 column by default
+                }
+                for (const WidthRange& range : widthRanges) {
+                    for (char32_t codePoint = range.first; codePoint <= range.last && codePoint < 0x10000; codePoint++) {
+                        int shift = (codePoint % 4) * 2;
+                        packed[codePoint / 4] = (uint8_t) ((packed[codePoint / 4] & ~(3 << shift)) | (range.width << shift));
+                    }
+                }
+            }
+        };
+
+        constexpr PlaneWidths planeWidths;
+
+        /**
+         * Gets the number of terminal columns a Unicode code point takes.
+         *
+         * @param codePoint The code point to measure.
+         *
+         * @returns 0 for combining marks, 2 for wide characters, 1 otherwise.
+         */
+        int codePointWidth(char32_t codePoint) {
+            if (codePoint < 0x10000) {
+                return (planeWidths.packed[codePoint / 4] >> ((codePoint % 4) * 2)) & 3;
+            }
+
+            size_t low = 0, high = sizeof(widthRanges) / sizeof(widthRanges[0]);
+
+            while (low < high) {
+                size_t middle = (low + high) / 2;
+                if (codePoint < widthRanges[middle].first) {
+                    high = middle;
+                } else if (codePoint > widthRanges[middle].last) {
+                    low = middle + 1;
+                } else {
+                    return widthRanges[middle].width;
+                }
+            }
+            return 1;
+        }
+
+        /**
+         * Gets the number of terminal columns a UTF-8 text takes. Pure ASCII text is
+         * detected first and measured by its length; otherwise each code point is
+         * decoded and measured. Invalid bytes count as one column each.
+         *
+         * @param text The text to measure.
+         * @param length The number of bytes of the text.
+         *
+         * @returns The display width of the text.
+         */
+        size_t displayWidth(const char* text, size_t length) {
+            if (isASCII(text, length)) {
+                return length;
+            }
+
+            size_t width = 0;
+            size_t i = 0;
+
+            while (i < length) {
+                #ifdef __SSE2__
+                    // skip runs of ASCII 16 bytes at a time
+                    if (i + 16 <= length && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i))) == 0) {
+                        width += 16;
+                        i += 16;
+                        continue;
+                    }
+                #endif
+
+                unsigned char lead = text[i];
+                if (lead < 0x80) {
+                    width++;
+                    i++;
+                    continue;
+                }
+
+                int extra = (lead >= 0xF8) ? 0 : (lead >= 0xF0) ? 3 : (lead >= 0xE0) ? 2 : (lead >= 0xC0) ? 1 : 0;
+                char32_t codePoint = (extra == 3) ? (lead & 0x07) : (extra == 2) ? (lead & 0x0F) : (extra == 1) ? (lead & 0x1F) : lead;
+
+                bool valid = (extra > 0) && (i + extra < length);
+                for (int k = 1; valid && k <= extra; k++) {
+                    unsigned char next = text[i + k];
+                    valid = ((next & 0xC0) == 0x80);
+                    codePoint = (codePoint << 6) | (next & 0x3F);
+                }
+
+                if (!valid) {
+                    width += 1;
+                    i += 1;
+                    continue;
+                }
+
+                width += codePointWidth(codePoint);
+                i += extra + 1;
+            }
+
+            return width;
+        }
+
+        size_t displayWidth(const string& text) {
+            return displayWidth(text.data(), text.length());
+        }
+
+        /**
+         * Split a given string into words, ensuring that no word exceeds the
+         * given limit. Lengths are measured in display width, so multibyte
+         * characters are counted by the columns they take.
+         *
+         * Every split line is a run of the input, so the lines are views into it
+         * and the list of them comes from the frame's scratch arena.
+         *
+         * @param input The string to split into words.
+         * @param limit The maximum number of columns allowed in each word.
+         *
+         * @returns A vector of views, each containing a line from the original 
+         *          input string. No line exceeds the given limit.
+         */
+        pmr::vector<string_view> splitWords(const string& input, size_t limit) {
+            pmr::vector<string_view> results(&memory::frameScratch);
+            char space = ' ';
+            size_t lineStart = 0;
+
+            // Process the input line by line, the same way getline() would split it
+            while (lineStart < input.length()) {
+                size_t lineEnd = input.find('\n', lineStart);
+                if (lineEnd == string::npos) lineEnd = input.length();
+                string_view line(input.data() + lineStart, lineEnd - lineStart);
+                lineStart = lineEnd + 1;
+
+                int currentLength = 0;
+                int i = 0;
+                int resultStart = 0, resultEnd = 0;
+
+                // Most lines are plain ASCII, where the width of a word is its length
+                bool ascii = isASCII(line.data(), line.length());
+
+                // Preserve leading spaces (indent) for each line
+                while (i < line.length() && line[i] == space) i++;
+                
+                resultEnd = i;
+                currentLength = i;
+
+                while (i < line.length()) {
+                    int spaceStart = i;
+                    while (i < line.length() && line[i] == space) i++;
+                    int wordStart = i;
+                    while (i < line.length() && line[i] != space) i++;
+                    int wordWidth = ascii ? (i - wordStart) : displayWidth(line.data() + wordStart, i - wordStart);
+                    int wholeWidth = (wordStart - spaceStart) + wordWidth;
+
+                    if ((currentLength + (currentLength > 0 ? wholeWidth : wordWidth) > limit) && !(wordWidth > limit)) {
+                        results.push_back(line.substr(resultStart, resultEnd - resultStart));
+                        currentLength = 0;
+                    }
+
+                    if (currentLength == 0) resultStart = wordStart;
+                    resultEnd = i;
+                    currentLength += (currentLength > 0 ? wholeWidth : wordWidth);
+                }
+
+                // Add the last part of the processed line
+                results.push_back(line.substr(resultStart, resultEnd - resultStart));
+                
+            }
+
+            return results;
+        }
+
+        enum FormatAlign { 
+            LEFT, 
+            CENTER, 
+            RIGHT 
+        };
+
+        struct FormatParams {
+            FormatAlign align = LEFT;
+            int limitLength = -1;       // negative means use program::config::lengthHUD
+            int padding = 0;
+            string space = " ";
+        } optionsFormat = {LEFT, -1, 8};
+
+        /**
+         * Format a given string into a block of text with a specified length, 
+         * with optional padding and centering. The text is split into words and 
+         * each word is placed on a new line if it exceeds the specified length. 
+         * The words are then formatted and padded with a given space character.
+         * 
+         * @param text The text to format.
+         * @param params The parameters for formatting the text.
+         * 
+         * @returns A string consisting of the formatted text.
+         */
+        string formatText(const string& text, FormatParams params) {
+            int spaceLeft, spaceRight;
+            int lineLength;
+            string result;
+
+            // get the lines after splitting the words based on the limit length for each line.
+            pmr::vector<string_view> lines = splitWords(text, params.limitLength - (params.padding * 2));
+
+            for (int i = 0; i < lines.size(); i++) {
+                string_view line = lines[i];
+
+                lineLength = displayWidth(line.data(), line.length());
+
+                if (params.limitLength < 0) {
+                    params.limitLength = program::config::lengthHUD;
+                }
+                
+                // Determine how much space each line should have, excluding padding and line length
+                int spaceTotalLength = params.limitLength - lineLength - (params.padding * 2);
+
+                // Determine in what alignment each line should be formatted in
+                switch (params.align) {
+                    case LEFT:
+                        spaceLeft = 0;
+                        spaceRight = spaceTotalLength;
+                        break;
+                    case CENTER:
+                        spaceLeft = ((params.limitLength - lineLength) / 2) - params.padding;
+                        if ((params.limitLength - lineLength) % 2 == 0) {
+                            spaceRight = spaceLeft;
+                        }
+                        else {
+                            spaceRight = spaceLeft + 1;
+                        }
+                        break;
+                    case RIGHT:
+                        spaceLeft = spaceTotalLength;
+                        spaceRight = 0;
+                        break;
+                }
+
+                // the spaces are appended in place instead of building them separately
+                for (int s = 0; s < params.padding + spaceLeft; s++) result += params.space;
+                result += line;
+                for (int s = 0; s < spaceRight + params.padding; s++) result += params.space;
+                if (i < lines.size() - 1) result += '\n';
+            }
+
+            return result;
+        }
+
+
+        /**
+         * Format a given vector of strings into a block of text with a specified length, 
+         * with optional padding and centering. The words are then formatted and padded
+         * with a given space character.
+         * 
+         * @param text The text to format, given as a vector of strings.
+         * @param params The parameters for formatting the text.
+         * 
+         * @returns A string consisting of the formatted text.
+         */
+        string formatText(const vector<string> text, FormatParams params) {
+            string result;
+            for (auto line : text) {
+                result += (formatText(line, params) + "\n");
+            }
+            return result;
+        }
+
+        /**
+         * Format a given input prompt and value as a string. Used to
+         * save a user's input for continuous prompts.
+         * 
+         * @param prompt The input prompt to format.
+         * @param value The value entered by the user, if any.
+         * @param indentString The optional indent string to prepend to the formatted string.
+         * 
+         * @returns A string consisting of the formatted input prompt and value.
+         */
+        string formatAsInput(const string& prompt, const string& value = "", const string& indentString = " >> ") {
+            return (indentString + prompt + value + '\n');
+        }
+
+        /**
+         * A fixed-capacity text buffer that can be filled at compile time. Used to
+         * generate the text that never changes for a given HUD length.
+         */
+        template <size_t Capacity>
+        struct StaticText {
+            char data[Capacity] = {};
+            size_t size = 0;
+
+            constexpr void append(const char* text, size_t length, int times = 1) {
+                for (int t = 0; t < times; t++) {
+                    for (size_t i = 0; i < length; i++) {
+                        data[size++] = text[i];
+                    }
+                }
+            }
+
+            constexpr string_view view() const {
+                return string_view(data, size);
+            }
+        };
+
+        /**
+         * Counts the bytes of a null-terminated string at compile time.
+         */
+        constexpr size_t textLength(const char* text) {
+            size_t length = 0;
+            while (text[length] != '\0') length++;
+            return length;
+        }
+
+        /**
+         * Counts the lines of a null-terminated string at compile time, the same way
+         * getline() would split it.
+         */
+        constexpr size_t countLines(const char* text) {
+            size_t lines = 0;
+            size_t length = textLength(text);
+            for (size_t i = 0; i < length; i++) {
+                if (text[i] == '\n') lines++;
+            }
+            return (length > 0 && text[length - 1] != '\n') ? lines + 1 : lines;
+        }
+
+        /**
+         * Compile-time counterpart of formatText() for one line of text, padded with
+         * spaces. The text must fit in the limit length, as it is never wrapped.
+         *
+         * @param out The buffer to append the formatted line to.
+         * @param text The line to format.
+         * @param length The number of characters of the line.
+         * @param align The alignment of the line.
+         * @param limitLength The total length of the formatted line.
+         * @param padding The number of spaces on both ends of the line.
+         */
+        template <size_t Capacity>
+        constexpr void appendFormatted(StaticText<Capacity>& out, const char* text, size_t length, FormatAlign align, int limitLength, int padding = 0) {
+            int lineLength = (int) length;
+            int spaceTotalLength = limitLength - lineLength - (padding * 2);
+            int spaceLeft = 0, spaceRight = 0;
+
+            switch (align) {
+                case LEFT:
+                    spaceRight = spaceTotalLength;
+                    break;
+                case CENTER:
+                    spaceLeft = ((limitLength - lineLength) / 2) - padding;
+                    spaceRight = ((limitLength - lineLength) % 2 == 0) ? spaceLeft : spaceLeft + 1;
+                    break;
+                case RIGHT:
+                    spaceLeft = spaceTotalLength;
+                    break;
+            }
+
+            out.append(" ", 1, padding + spaceLeft);
+            out.append(text, length);
+            out.append(" ", 1, spaceRight + padding);
+        }
+
+        /**
+         * Compile-time counterpart of formatText() with optionsFormat, for a block of
+         * option lines such as a menu.
+         *
+         * @param text The option lines, each ending with a newline.
+         *
+         * @returns A buffer holding the formatted block.
+         */
+        template <int Width, size_t Lines, size_t N>
+        constexpr StaticText<N + Lines * (Width + 17)> buildStaticOptions(const char (&text)[N]) {
+            StaticText<N + Lines * (Width + 17)> out;
+            size_t start = 0;
+            size_t line = 0;
+
+            for (size_t i = 0; i < N - 1; i++) {
+                if (text[i] == '\n') {
+                    appendFormatted(out, text + start, i - start, LEFT, Width, 8);
+                    if (++line < Lines) out.append("\n", 1);
+                    start = i + 1;
+                }
+            }
+            if (start < N - 1) {
+                appendFormatted(out, text + start, N - 1 - start, LEFT, Width, 8);
+            }
+
+            return out;
+        }
+    }
+
+    namespace input {
+        /**
+         * The input lines of a session, recorded to a file with their timestamps, or
+         * replayed from one instead of reading standard input.
+         */
+        struct InputLog {
+            ofstream recording;                     // open while recording
+            chrono::steady_clock::time_point started;
+
+            bool replaying = false;
+            vector<string> lines;                   // the lines to replay, in order
+            size_t next = 0;
+            function<void()> onRead;                // called before each replayed line is read
+        } inputLog;
+
+        // Thrown when a replay runs out of recorded lines
+        struct ReplayFinished {};
+
+        /**
+         * Reads a line of input from standard input or the replayed recording,
+         * recording it when a recording is open.
+         *
+         * @param line A reference to a string variable where the line will be stored.
+         *
+         * @returns false if there is no more input.
+         */
+        bool readLine(string& line) {
+            if (inputLog.replaying) {
+                if (inputLog.onRead) inputLog.onRead();
+                if (inputLog.next >= inputLog.lines.size()) throw ReplayFinished();
+                line = inputLog.lines[inputLog.next++];
+                return true;
+            }
+
+            if (!getline(cin, line)) {
+                line.clear();
+                return false;
+            }
+
+            if (inputLog.recording.is_open()) {
+                // flushed right away so a session that crashes is still recorded
+                inputLog.recording 
+                    << chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - inputLog.started).count()
+                    << '\t' << line << endl;
+            }
+            return true;
+        }
+
+        /**
+         * Parses an integer the same way reading one from cin does.
+         *
+         * @param line The line entered by the operator.
+         * @param value A reference to an int variable where the value will be stored.
+         *
+         * @returns A boolean indicating whether the input is invalid.
+         */
+        bool parseInt(const string& line, int& value) {
+            stringstream stream(line);
+            stream >> value;
+            return stream.fail();
+        }
+
+        /**
+         * Prompts the user for input and reads an integer into the provided variable.
+         * Blank lines are skipped, like reading an integer from cin does.
+         * 
+         * @param prompt The message displayed to the user before input.
+         * @param var A reference to an int variable where the input will be stored.
+         * 
+         * @returns A boolean indicating whether the input is invalid.
+         */
+        bool getInput(const string prompt, int& var) {
+            string line;
+
+            cout << " >> " << prompt;
+            do {
+                if (!readLine(line)) return true;
+            } while (line.find_first_not_of(" \t\r") == string::npos);
+
+            return parseInt(line, var);
+        }
+
+        /**
+         * Prompts the user for input and reads a line of text into the provided variable.
+         * 
+         * @param prompt The message displayed to the user before input.
+         * @param var A reference to a string variable where the input will be stored.
+         * 
+         * @returns A boolean indicating whether the input was invalid (empty).
+         */
+        bool getInput(const string prompt, string& var) {
+            cout << " >> " << prompt;
+            readLine(var);
+            return var.empty();
+        }
+
+        /**
+         * Starts recording every input line to a file, each as the microseconds since
+         * the recording started, a tab, and the line.
+         *
+         * @returns A boolean indicating whether the file could not be opened.
+         */
+        bool startRecording(const string& path) {
+            inputLog.recording.open(path, ios::trunc);
+            inputLog.started = chrono::steady_clock::now();
+            return !inputLog.recording;
+        }
+
+        /**
+         * Loads a recording to be replayed in place of standard input.
+         *
+         * @param path The path of the recording.
+         * @param duration Set to how long the recorded session took, in seconds.
+         *
+         * @returns A boolean indicating whether the file could not be read.
+         */
+        bool loadReplay(const string& path, double& duration) {
+            ifstream stream(path);
+            if (!stream) return true;
+
+            string line;
+            duration = 0;
+            inputLog.lines.clear();
+            while (getline(stream, line)) {
+                size_t tab = line.find('\t');
+                if (tab == string::npos) continue;
+                duration = atoll(line.c_str()) / 1e6;
+                inputLog.lines.push_back(line.substr(tab + 1));
+            }
+
+            inputLog.next = 0;
+            inputLog.replaying = true;
+            return false;
+        }
+    }
+    
+}
+
+namespace sharding {
+    using namespace utils;
+
+    // Requests with these kinds read from a shard instead of changing a seat: its occupancy
+    // bits, or whether a seat is reserved (OK) or not (NOT_RESERVED) and under what name
+    const int OCCUPANCY_REQUEST = 0;
+    const int LOOKUP_REQUEST = -1;
+
+    /**
+     * A worker process that owns a range of rows, and the router's side of its connection.
+     */
+    struct Shard {
+        int pid = -1;
+        int fd = -1;
+        int firstRow = 0, rowCount = 0;
+        string outgoing;            // requests not yet written
+        string incoming;            // replies not yet read in full
+        uint64_t pending = 0;       // requests not yet answered
+    };
+
+    /**
+     * Sends each operation to the shard owning its row, and gathers cross-shard reads.
+     */
+    struct Router {
+        vector<Shard> shards;
+        int totalRows = 0, totalColumns = 0;
+        int rowsPerShard = 1;
+        uint64_t nextSequence = 0;
+    };
+
+    /**
+     * Runs a shard: applies every request read from the router to this process's own
+     * seat layout, and replies to each with its sequence number, result, and payload.
+     *
+     * @param fd The connection to the router.
+     */
+    void runShard(int fd) {
+        #ifdef UNIX_LIKE
+            string received, replies;
+            char buffer[65536];
+
+            while (true) {
+                ssize_t count = read(fd, buffer, sizeof(buffer));
+                if (count < 0 && errno == EINTR) continue;
+                if (count <= 0) break;
+                received.append(buffer, count);
+
+                size_t offset = 0;
+                uint64_t sequence;
+                int64_t sentAt;
+                seatrs::Change change;
+
+                while (replication::decodeChange(received, offset, sequence, sentAt, change)) {
+                    string payload;
+                    int result;
+
+                    if ((int) change.kind == OCCUPANCY_REQUEST) {
+                        payload.assign((const char*) seatrs::data::occupancy.data(), seatrs::data::occupancy.size() * sizeof(uint64_t));
+                        result = seatrs::data::totalOccupiedSeats;
+                    } else if ((int) change.kind == LOOKUP_REQUEST) {
+                        if (!seatrs::isValidSeat(change.row, change.column)) {
+                            result = seatrs::INVALID_SEAT;
+                        } else if (!seatrs::data::seats[change.row][change.column].isReserved) {
+                            result = seatrs::NOT_RESERVED;
+                        } else {
+                            payload = seatrs::data::seats[change.row][change.column].name;
+                            result = seatrs::OK;
+                        }
+                    } else if (change.kind == seatrs::RESERVE) {
+                        result = seatrs::reserveSeat(change.row, change.column, change.name, change.description);
+                    } else if (change.kind == seatrs::UPDATE) {
+                        result = seatrs::updateSeat(change.row, change.column, change.name, change.description);
+                    } else if (change.kind == seatrs::CANCEL) {
+                        result = seatrs::cancelSeat(change.row, change.column);
+                    } else {
+                        result = seatrs::INVALID_SEAT;
+                    }
+
+                    replies += to_string(sequence) + ' ' + to_string(result) + ' ' + to_string(payload.size()) + '\n';
+                    replies += payload;
+                }
+                received.erase(0, offset);
+
+                size_t written = 0;
+                while (written < replies.size()) {
+                    count = write(fd, replies.data() + written, replies.size() - written);
+                    if (count < 0 && errno == EINTR) continue;
+                    if (count <= 0) return;
+                    written += count;
+                }
+                replies.clear();
+            }
+        #endif
+    }
+
+    /**
+     * Splits the current seat layout by row ranges across worker processes. Each worker
+     * keeps the reservations and attributes of its rows, and the router keeps only the
+     * connections.
+     *
+     * @param router The router to start the shards of.
+     * @param count The number of shards, at most one per row.
+     *
+     * @returns An error message, or an empty string if every shard started.
+     */
+    string startShards(Router& router, int count) {
+        #ifdef UNIX_LIKE
+            router.totalRows = seatrs::data::totalRows;
+            router.totalColumns = seatrs::data::totalColumns;
+            count = max(1, min(count, router.totalRows));
+            router.rowsPerShard = (router.totalRows + count - 1) / count;
+            router.shards.assign(count, Shard());
+
+            // a shard that exits must not kill the router
+            signal(SIGPIPE, SIG_IGN);
+            cout.flush();
+
+            for (int ishard = 0; ishard < count; ishard++) {
+                Shard& shard = router.shards[ishard];
+                shard.firstRow = ishard * router.rowsPerShard;
+                shard.rowCount = max(0, min(router.rowsPerShard, router.totalRows - shard.firstRow));
+
+                int fds[2];
+                if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+                    return "Unable to create a connection to a shard.";
+                }
+
+                pid_t pid = fork();
+                if (pid < 0) {
+                    return "Unable to start a shard process.";
+                }
+
+                if (pid == 0) {
+                    close(fds[0]);
+                    for (int iother = 0; iother < ishard; iother++) {
+                        close(router.shards[iother].fd);
+                    }
+                    seatrs::changeListeners.clear();
+
+                    // Keeps only this shard's rows, moved up to start at row 0
+                    int columns = seatrs::data::totalColumns;
+                    for (int irow = 0; irow < shard.rowCount; irow++) {
+                        swap(seatrs::data::seats[irow], seatrs::data::seats[shard.firstRow + irow]);
+                    }
+                    size_t first = (size_t) shard.firstRow * columns, last = first + (size_t) shard.rowCount * columns;
+                    vector<uint8_t> tiers(seatrs::data::tiers.begin() + first, seatrs::data::tiers.begin() + last);
+                    vector<int32_t> prices(seatrs::data::prices.begin() + first, seatrs::data::prices.begin() + last);
+                    vector<uint8_t> features(seatrs::data::features.begin() + first, seatrs::data::features.begin() + last);
+
+                    seatrs::setSize(shard.rowCount, columns);
+                    seatrs::data::tiers = tiers;
+                    seatrs::data::prices = prices;
+                    seatrs::data::features = features;
+
+                    runShard(fds[1]);
+                    _exit(0);
+                }
+
+                close(fds[1]);
+                fcntl(fds[0], F_SETFL, O_NONBLOCK);
+                shard.pid = pid;
+                shard.fd = fds[0];
+            }
+
+            return "";
+        #else
+            return "Sharding requires a Unix-like system.";
+        #endif
+    }
+
+    /**
+     * Gets the index of the shard that owns a row.
+     */
+    int shardOfRow(const Router& router, int irow) {
+        return irow / router.rowsPerShard;
+    }
+
+    /**
+     * Queues an operation for the shard that owns its row, translated to the shard's rows.
+     * Nothing is sent until exchange() is called, so many operations go out together.
+     *
+     * @param router The router to queue the operation on.
+     * @param change The operation, with its row in the whole layout.
+     *
+     * @returns The sequence number of the operation, or 0 if its row is not in the layout.
+     */
+    uint64_t submit(Router& router, seatrs::Change change) {
+        if (change.row < 0 || change.row >= router.totalRows) return 0;
+
+        Shard& shard = router.shards[shardOfRow(router, change.row)];
+        change.row -= shard.firstRow;
+
+        uint64_t sequence = ++router.nextSequence;
+        replication::encodeChange(shard.outgoing, sequence, replication::nowMicros(), change);
+        shard.pending++;
+        return sequence;
+    }
+
+    /**
+     * Sends every queued operation to its shard and waits for all of their replies,
+     * writing to and reading from every shard at once.
+     *
+     * @param router The router whose operations to send.
+     * @param onReply Called for each reply with the index of the shard, the sequence
+     *                number, the result, and the payload.
+     *
+     * @returns false if a shard was lost.
+     */
+    bool exchange(Router& router, const function<void(int, uint64_t, int, const string&)>& onReply) {
+        #ifdef UNIX_LIKE
+            char buffer[65536];
+
+            while (true) {
+                vector<pollfd> polls;
+                vector<int> owners;
+                for (size_t ishard = 0; ishard < router.shards.size(); ishard++) {
+                    Shard& shard = router.shards[ishard];
+                    if (shard.pending == 0 && shard.outgoing.empty()) continue;
+                    polls.push_back({shard.fd, (short) (POLLIN | (shard.outgoing.empty() ? 0 : POLLOUT)), 0});
+                    owners.push_back((int) ishard);
+                }
+                if (polls.empty()) return true;
+
+                if (poll(polls.data(), polls.size(), -1) < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+
+                for (size_t p = 0; p < polls.size(); p++) {
+                    Shard& shard = router.shards[owners[p]];
+
+                    if (polls[p].revents & POLLOUT) {
+                        ssize_t count = write(shard.fd, shard.outgoing.data(), shard.outgoing.size());
+                        if (count > 0) shard.outgoing.erase(0, count);
+                    }
+
+                    if (polls[p].revents & (POLLIN | POLLHUP | POLLERR)) {
+                        ssize_t count = read(shard.fd, buffer, sizeof(buffer));
+                        if (count <= 0) {
+                            if (count < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+                            return false;
+                        }
+                        shard.incoming.append(buffer, count);
+
+                        size_t offset = 0, end;
+                        while ((end = shard.incoming.find('\n', offset)) != string::npos) {
+                            long long fields[3] = {};
+                            const char* position = shard.incoming.data() + offset;
+                            for (long long& field : fields) {
+                                position = from_chars(position, shard.incoming.data() + end, field).ptr + 1;
+                            }
+                            if (shard.incoming.size() < end + 1 + fields[2]) break;
+
+                            onReply(owners[p], fields[0], (int) fields[1], shard.incoming.substr(end + 1, fields[2]));
+                            offset = end + 1 + fields[2];
+                            shard.pending--;
+                        }
+                        shard.incoming.erase(0, offset);
+                    }
+                }
+            }
+        #else
+            return false;
+        #endif
+    }
+
+    /**
+     * Gathers the occupancy bits of every shard into one bitmap of the whole layout,
+     * laid out like seatrs::data::occupancy.
+     *
+     * @param router The router to gather from.
+     * @param occupancy Filled with the occupancy bits of the whole layout.
+     *
+     * @returns The number of occupied seats, or -1 if a shard was lost.
+     */
+    int gatherOccupancy(Router& router, vector<uint64_t>& occupancy) {
+        int wordsPerRow = (router.totalColumns + 63) / 64;
+        occupancy.assign((size_t) router.totalRows * wordsPerRow, 0);
+
+        seatrs::Change request;
+        request.kind = (seatrs::ChangeKind) OCCUPANCY_REQUEST;
+        for (Shard& shard : router.shards) {
+            request.row = shard.firstRow;
+            submit(router, request);
+        }
+
+        int total = 0;
+        bool gathered = exchange(router, [&](int ishard, uint64_t, int result, const string& payload) {
+            const Shard& shard = router.shards[ishard];
+            size_t words = min(payload.size() / sizeof(uint64_t), (size_t) shard.rowCount * wordsPerRow);
+            memcpy(occupancy.data() + (size_t) shard.firstRow * wordsPerRow, payload.data(), words * sizeof(uint64_t));
+            total += result;
+        });
+
+        return gathered ? total : -1;
+    }
+
+    /**
+     * Stops every shard and waits for their processes to exit.
+     */
+    void stopShards(Router& router) {
+        #ifdef UNIX_LIKE
+            for (Shard& shard : router.shards) {
+                if (shard.fd >= 0) close(shard.fd);
+            }
+            for (Shard& shard : router.shards) {
+                if (shard.pid > 0) waitpid(shard.pid, nullptr, 0);
+            }
+            router.shards.clear();
+        #endif
+    }
+
+    /**
+     * Measures how the throughput of reservations and cancellations scales with the
+     * number of shards, doubling it from 1 up to a limit. Operations on random seats go
+     * out in pipelined batches, and the occupied total gathered from the shards at the
+     * end is checked against the results the router received.
+     *
+     * @param maxShards The largest number of shards to measure.
+     * @param rows The number of rows of the layout.
+     * @param columns The number of columns of the layout.
+     * @param operations The number of operations for each number of shards.
+     *
+     * @returns The exit code of the program.
+     */
+    int benchShards(int maxShards, int rows, int columns, int operations) {
+        const int batchSize = 1024;
+
+        cout << "shards  operations/s  occupied  consistent" << endl;
+
+        for (int count = 1; count <= maxShards; count *= 2) {
+            seatrs::resetLayout(rows, columns);
+
+            Router router;
+            string errorMessage = startShards(router, count);
+            if (!errorMessage.empty()) {
+                cerr << errorMessage << endl;
+                stopShards(router);
+                return 1;
+            }
+
+            mt19937 random(12345);
+            vector<seatrs::ChangeKind> kinds(batchSize + 1);
+            long long expected = 0;
+            bool lost = false;
+
+            auto started = chrono::steady_clock::now();
+            for (int done = 0; done < operations && !lost; done += batchSize) {
+                uint64_t firstSequence = router.nextSequence + 1;
+                for (int i = 0; i < batchSize; i++) {
+                    seatrs::Change change;
+                    change.kind = (random() % 2) ? seatrs::RESERVE : seatrs::CANCEL;
+                    change.row = random() % rows;
+                    change.column = random() % columns;
+                    change.name = "Bench";
+                    kinds[i] = change.kind;
+                    submit(router, change);
+                }
+
+                lost = !exchange(router, [&](int, uint64_t sequence, int result, const string&) {
+                    if (result == seatrs::OK) {
+                        expected += (kinds[sequence - firstSequence] == seatrs::RESERVE) ? 1 : -1;
+                    }
+                });
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+            vector<uint64_t> occupancy;
+            int occupied = lost ? -1 : gatherOccupancy(router, occupancy);
+            stopShards(router);
+
+            if (occupied < 0) {
+                cerr << "A shard was lost." << endl;
+                return 1;
+            }
+
+            cout << format::formatText(to_string(count), {format::LEFT, 8})
+                << format::formatText(to_string((long long) (operations / seconds)), {format::LEFT, 14})
+                << format::formatText(to_string(occupied), {format::LEFT, 10})
+                << (occupied == expected ? "yes" : "NO") << endl;
+        }
+
+        return 0;
+    }
+}
+
+namespace display {
+
+    namespace screen {
+        
+        /**
+         * The lines last drawn to an output, so the next frame only rewrites what changed.
+         */
+        struct FrameBuffer {
+            vector<string> previousLines;   // lines of the last frame drawn
+            size_t previousWidth = 0;       // columns taken by the widest line of the last frame
+            bool hasPrevious = false;       // false forces the next frame to redraw everything
+            size_t bytesWritten = 0;        // total bytes written for this output so far
+            size_t lastBytesWritten = 0;    // bytes written for the latest frame
+        } terminalFrame;
+
+        // The first line of the title of the last screen built, used to time replays
+        string currentTitle;
+
+        /**
+         * Clears the console screen and moves the cursor to the top left position.
+         * The next call to render() will redraw the whole frame.
+         * 
+         * This function will work on both Windows and Unix-like systems.
+         */
+        void clear() {
+            terminalFrame.previousLines.clear();
+            terminalFrame.hasPrevious = false;
+
+            #ifdef UNIX_LIKE
+                cout << "\x1b[2J\x1b[H";
+                // credit: https://stackoverflow.com/a/6487534
+            #else
+                cout << string(100, '\n');
+                // Windows is not a Unix-like system, thus we use a different, less preferable method
+            #endif
+            return;
+        }
+
+        /**
+         * Gets the number of lines the terminal can show at once.
+         * 
+         * @param fd The output, the standard output by default.
+         * 
+         * @returns The terminal height, or 0 if it cannot be determined (e.g. the
+         *          output is not a terminal).
+         */
+        int terminalHeight(int fd = 1) {
+            #ifdef UNIX_LIKE
+                winsize size;
+                if (ioctl(fd, TIOCGWINSZ, &size) == 0) {
+                    return size.ws_row;
+                }
+            #endif
+            return 0;
+        }
+
+        /**
+         * Gets the number of columns the terminal can show on one line.
+         * 
+         * @param fd The output, the standard output by default.
+         * 
+         * @returns The terminal width, or 0 if it cannot be determined (e.g. the
+         *          output is not a terminal).
+         */
+        int terminalWidth(int fd = 1) {
+            #ifdef UNIX_LIKE
+                winsize size;
+                if (ioctl(fd, TIOCGWINSZ, &size) == 0) {
+                    return size.ws_col;
+                }
+            #endif
+            return 0;
+        }
+
+        /**
+         * Builds the bytes that turn the previously drawn frame of a buffer into the 
+         * given one, by only rewriting the lines that changed. Changed lines are 
+         * reached with ANSI cursor movement, and anything below the new frame is erased.
+         * 
+         * The last line of the frame is always rewritten since it is where the user
+         * types their input, so the cursor is left right after it. The first frame
+         * and frames that do not fit are drawn in full, since scrolling would shift
+         * lines and a line wider than the output wraps onto the rows below it.
+         * 
+         * @param buffer The frame buffer of the output the frame is drawn on.
+         * @param text The whole screen to display.
+         * @param height The height of the output in lines, or 0 if unlimited.
+         * @param width The width of the output in columns, or 0 if unlimited.
+         * 
+         * @returns The bytes to write to the output.
+         */
+        string buildFrameUpdate(FrameBuffer& buffer, const string& text, int height = 0, int width = 0) {
+            pmr::vector<string_view> lines(&utils::memory::frameScratch);
+            size_t start = 0, end;
+            while ((end = text.find('\n', start)) != string::npos) {
+                lines.push_back(string_view(text).substr(start, end - start));
+                start = end + 1;
+            }
+            lines.push_back(string_view(text).substr(start));
+
+            // The last line only gets the user's input after it, so it is measured as well
+            size_t frameWidth = 0;
+            if (width > 0) {
+                for (string_view line : lines) {
+                    frameWidth = max(frameWidth, utils::format::displayWidth(line.data(), line.size()));
+                }
+            }
+
+            bool fits = (height <= 0) || (lines.size() < (size_t) height && buffer.previousLines.size() < (size_t) height);
+            fits = fits && (width <= 0 || (frameWidth <= (size_t) width && buffer.previousWidth <= (size_t) width));
+            string output;
+
+            if (buffer.hasPrevious && fits) {
+                for (size_t i = 0; i < lines.size(); i++) {
+                    bool isLast = (i == lines.size() - 1);
+                    if (isLast || i >= buffer.previousLines.size() || buffer.previousLines[i] != lines[i]) {
+                        output += "\x1b[" + to_string(i + 1) + ";1H";
+                        output += lines[i];
+                        output += (isLast ? "\x1b[J" : "\x1b[K");
+                    }
+                }
+            } else {
+                output = "\x1b[2J\x1b[H" + text;
+            }
+
+            buffer.lastBytesWritten = output.size();
+            buffer.bytesWritten += output.size();
+
+            // The user's input is echoed on the last line, so it never matches next time
+            lines.back() = "\x1b";
+
+            // Reuses the strings of the previous frame, so a steady screen allocates nothing here
+            buffer.previousLines.resize(lines.size());
+            for (size_t i = 0; i < lines.size(); i++) {
+                buffer.previousLines[i].assign(lines[i].data(), lines[i].size());
+            }
+            buffer.previousWidth = frameWidth;
+            buffer.hasPrevious = true;
+
+            // The frame is built, so its scratch allocations are no longer needed
+            utils::memory::frameScratch.reset();
+
+            return output;
+        }
+
+        /**
+         * Draws a whole screen on the console, only rewriting what changed since 
+         * the previous screen (see buildFrameUpdate). Falls back to a full 
+         * clear-and-redraw on systems without ANSI support.
+         * 
+         * @param text The whole screen to display.
+         */
+        void render(const string& text) {
+            #ifdef UNIX_LIKE
+                cout << buildFrameUpdate(terminalFrame, text, terminalHeight(), terminalWidth());
+            #else
+                clear();
+                cout << text;
+                terminalFrame.lastBytesWritten = text.size();
+                terminalFrame.bytesWritten += text.size();
+            #endif
+        }
+
+        enum Status {
+            SUCCESS = 1,
+            RETURN = -1,
+            FINISH = 0
+        };
+    }
+
+    namespace components {
+        using namespace utils;
+
+        /**
+         * Builds a header string consisting of a repeated character.
+         *
          * @param lineChar The character to repeat for the header line.
          * @param length The total length of the header line.
          * @param newLine Whether to append a newline character at the end of the header.
          *
-         * @returns A string consisting of the repeated character forming a header.
+         * @returns A string consisting of the repeated character forming a header.
+         */
+        string buildHeader(char lineChar = '=', int length = program::config::lengthHUD, bool newLine = true) {
+            return (newLine ? string(length, lineChar) + '\n' : string(length, lineChar));
+        }
+
+        /**
+         * Looks up text generated at compile time for every supported HUD length.
+         * The source is a type with a `build<Width>()` function that is evaluated
+         * once per length, from program::control::minLengthHUD to maxLengthHUD.
+         */
+        template <typename Source, int Width>
+        struct Generated {
+            static constexpr auto text = Source::template build<Width>();
+        };
+
+        template <typename Source, int... Offsets>
+        string_view lookupGenerated(int length, integer_sequence<int, Offsets...>) {
+            static constexpr string_view table[] = {
+                Generated<Source, program::control::minLengthHUD + Offsets>::text.view()...
+            };
+
+            // the HUD length is always validated against these bounds when set
+            if (length < program::control::minLengthHUD) length = program::control::minLengthHUD;
+            if (length > program::control::maxLengthHUD) length = program::control::maxLengthHUD;
+
+            return table[length - program::control::minLengthHUD];
+        }
+
+        /**
+         * Gets the compile-time generated text of a source for the current HUD length.
+         *
+         * @returns The generated text.
+         */
+        template <typename Source>
+        string_view generated(int length = program::config::lengthHUD) {
+            return lookupGenerated<Source>(
+                length, 
+                make_integer_sequence<int, program::control::maxLengthHUD - program::control::minLengthHUD + 1>()
+            );
+        }
+
+        /**
+         * The part of the HUD that never changes for a given length: the name art
+         * centered on "░", and the title between two header lines.
+         */
+        struct StaticHUD {
+            static constexpr const char* nameArtLines[] = {
+                "░██████╗░░█████╗░██████╗░░░░░░░░░░██████╗██████╗░░██████╗",
+                "██╔════╝░██╔══██╗██╔══██╗░░░░░░░░██╔════╝██╔══██╗██╔════╝",
+                "██║░░██╗░███████║██████╔╝░█████╗░╚█████╗░██████╔╝░╚████╗░",
+                "██║░░╚██╗██╔══██║██╔═══╝░░╚════╝░░╚═══██╗██╔══██╗░╚═══██╗",
+                "╚██████╔╝██║░░██║██║░░░░░░░░░░░░░██████╔╝██║░░██║██████╔╝",
+                "░╚═════╝░╚═╝░░╚═╝╚═╝░░░░░░░░░░░░░╚═════╝░╚═╝░░╚═╝╚═════╝░" 
+            };
+            static constexpr int nameArtWidth = 57;         // every character of the art is 3 bytes long
+            static constexpr const char* nameArtSpace = "░";
+
+            template <int Width>
+            static constexpr auto build() {
+                format::StaticText<6 * (Width * 3 + 1) + 1 + 4 * (Width + 1)> out;
+
+                int spaceLeft = (Width - nameArtWidth) / 2;
+                int spaceRight = ((Width - nameArtWidth) % 2 == 0) ? spaceLeft : spaceLeft + 1;
+
+                for (const char* line : nameArtLines) {
+                    out.append(nameArtSpace, 3, spaceLeft);
+                    out.append(line, format::textLength(line));
+                    out.append(nameArtSpace, 3, spaceRight);
+                    out.append("\n", 1);
+                }
+                out.append("\n", 1);
+
+                out.append("=", 1, Width);
+                out.append("\n", 1);
+                format::appendFormatted(out, "Geevoi A. Plaza's", 17, format::CENTER, Width - 20);
+                out.append("|", 1);
+                format::appendFormatted(out, "CS-1105", 7, format::RIGHT, 19);
+                out.append("\n", 1);
+                format::appendFormatted(out, "Seat Reservation System", 23, format::CENTER, Width - 20);
+                out.append("|", 1);
+                format::appendFormatted(out, "CS 111", 6, format::RIGHT, 19);
+                out.append("\n", 1);
+                out.append("=", 1, Width);
+                out.append("\n", 1);
+
+                return out;
+            }
+        };
+
+        /**
+         * A block of option lines formatted with format::optionsFormat at compile
+         * time. The deriving type provides the lines as `text`.
+         */
+        template <typename Source>
+        struct StaticOptions {
+            template <int Width>
+            static constexpr auto build() {
+                return format::buildStaticOptions<Width, format::countLines(Source::text)>(Source::text);
+            }
+        };
+
+        struct MainMenuOptions : StaticOptions<MainMenuOptions> {
+            static constexpr char text[] = 
+                "[1] Display Seat Layout\n"
+                "[2] Create Seat Reservation\n"
+                "[3] Read/Display Seat Reservation\n"
+                "[4] Update Seat Reservation\n"
+                "[5] Delete/Cancel Seat Reservation\n"
+                "[6] Find Seats by Attributes\n"
+                "[7] Join Waitlist\n"
+                "[8] Find Nearest Free Seats\n"
+                "[9] Count Free Seats in an Area\n"
+                "[10] Showtimes\n"
+                "[11] Hold Seat\n"
+                "[0] Settings (-> Exit)\n";
+        };
+
+        struct SessionMenuOptions : StaticOptions<SessionMenuOptions> {
+            static constexpr char text[] = 
+                "[1] Display Seat Layout\n"
+                "[2] Create Seat Reservation\n"
+                "[3] Read/Display Seat Reservation\n"
+                "[4] Update Seat Reservation\n"
+                "[5] Delete/Cancel Seat Reservation\n"
+                "[6] Find Seats by Attributes\n"
+                "[7] Join Waitlist\n"
+                "[8] Find Nearest Free Seats\n"
+                "[9] Count Free Seats in an Area\n"
+                "[11] Hold Seat\n"
+                "[0] Disconnect\n";
+        };
+
+        struct SettingsOptions : StaticOptions<SettingsOptions> {
+            static constexpr char text[] = 
+                "[1] Exit\n"
+                "[2] Edit Seat Layout Dimensions\n"
+                "[3] Edit HUD Length\n"
+                "[4] Import Reservations (CSV)\n"
+                "[5] Export Reservations\n"
+                "[6] Edit Seat Attributes\n"
+                "[7] Memory Statistics\n"
+                "[8] Load Venue Map\n"
+                "[9] Allocate Parties (CSV)\n"
+                "[10] Edit Sections\n"
+                "[0] Return to Main Menu\n";
+        };
+
+        struct ExportFormatOptions : StaticOptions<ExportFormatOptions> {
+            static constexpr char text[] = 
+                "[1] CSV\n"
+                "[2] JSON Lines\n"
+                "[0] Return to Settings\n";
+        };
+
+        struct FindSeatsPostOptions : StaticOptions<FindSeatsPostOptions> {
+            static constexpr char text[] = 
+                "[0] Find other Seats\n"
+                "[Enter] Return to Main Menu\n";
+        };
+
+        struct CountPostOptions : StaticOptions<CountPostOptions> {
+            static constexpr char text[] = 
+                "[0] Count another Area\n"
+                "[Enter] Return to Main Menu\n";
+        };
+
+        struct MetricOptions : StaticOptions<MetricOptions> {
+            static constexpr char text[] = 
+                "[1] Straight Line\n"
+                "[2] Walking (rows + seats)\n"
+                "[0] Return to Main Menu\n";
+        };
+
+        struct ShowtimesOptions : StaticOptions<ShowtimesOptions> {
+            static constexpr char text[] = 
+                "[1] Add Showtime\n"
+                "[2] Book a Seat\n"
+                "[3] Cancel a Booking\n"
+                "[4] Show Seat Layout of a Showtime\n"
+                "[5] Find Seats Free for a Time Window\n"
+                "[0] Return to Main Menu\n";
+        };
+
+        struct ReturnShowtimesOptions : StaticOptions<ReturnShowtimesOptions> {
+            static constexpr char text[] = "[0] Return to Showtimes\n";
+        };
+
+        struct EnterReturnShowtimesOptions : StaticOptions<EnterReturnShowtimesOptions> {
+            static constexpr char text[] = "[Enter] Return to Showtimes\n";
+        };
+
+        struct ReturnSettingsOptions : StaticOptions<ReturnSettingsOptions> {
+            static constexpr char text[] = "[0] Return to Settings\n";
+        };
+
+        struct ReturnOptions : StaticOptions<ReturnOptions> {
+            static constexpr char text[] = "[0] Return to Main Menu\n";
+        };
+
+        struct EnterReturnOptions : StaticOptions<EnterReturnOptions> {
+            static constexpr char text[] = "[Enter] Return to Main Menu\n";
+        };
+
+        struct CreatePostOptions : StaticOptions<CreatePostOptions> {
+            static constexpr char text[] = 
+                "[0] Create another Seat Reservation\n"
+                "[Enter] Return to Main Menu\n";
+        };
+
+        struct HoldPostOptions : StaticOptions<HoldPostOptions> {
+            static constexpr char text[] = 
+                "[0] Hold another Seat\n"
+                "[Enter] Return to Main Menu\n";
+        };
+
+        struct ReadPostOptions : StaticOptions<ReadPostOptions> {
+            static constexpr char text[] = 
+                "[0] Read/View another Seat Reservation\n"
+                "[Enter] Return to Main Menu\n";
+        };
+
+        struct UpdatePostOptions : StaticOptions<UpdatePostOptions> {
+            static constexpr char text[] = 
+                "[0] Update another Seat Reservation\n"
+                "[Enter] Return to Main Menu\n";
+        };
+
+        struct DeletePostOptions : StaticOptions<DeletePostOptions> {
+            static constexpr char text[] = 
+                "[0] Delete another Seat Reservation\n"
+                "[Enter] Return to Main Menu\n";
+        };
+
+        struct WaitlistPostOptions : StaticOptions<WaitlistPostOptions> {
+            static constexpr char text[] = 
+                "[0] Add another Party\n"
+                "[Enter] Return to Main Menu\n";
+        };
+
+        /**
+         * Builds the entire HUD string, consisting of the name art, title, and information about the
+         * layout dimensions and the number of occupied seats, plus the replication status on a
+         * primary, the state of the change feed, the sharing status of a shared layout, the
+         * number of waiting parties, and the seats of each section. Everything but the
+         * information lines is generated at compile time. The seats that other windows
+         * changed in a shared layout are copied in first.
+         *
+         * @returns A string representing the entire HUD.
+         */
+        string buildHUD() {
+            shared::pull();
+
+            int length = program::config::lengthHUD;
+
+            format::FormatParams hudDimensionsFormat = {format::LEFT, length/2};
+            format::FormatParams hudOccupiedFormat = {format::RIGHT, (length % 2 == 0 ? length/2 : (length/2) + 1)};
+
+            string output = string(generated<StaticHUD>())
+                + format::formatText(
+                    (to_string(seatrs::data::totalRows) + " Rows x " + to_string(seatrs::data::totalColumns) + " Cols"),
+                    hudDimensionsFormat
+                ) 
+                + format::formatText(
+                    (to_string(seatrs::data::totalOccupiedSeats) + "/" + to_string(seatrs::data::totalSeats) + " seats occupied"),
+                    hudOccupiedFormat
+                ) + '\n';
+
+            string replicationStatus = replication::primaryStatus();
+            if (!replicationStatus.empty()) {
+                output += format::formatText(replicationStatus, {format::CENTER}) + '\n';
+            }
+
+            string feedStatus = feed::feedStatus();
+            if (!feedStatus.empty()) {
+                output += format::formatText(feedStatus, {format::CENTER}) + '\n';
+            }
+
+            string sharedStatus = shared::status();
+            if (!sharedStatus.empty()) {
+                output += format::formatText(sharedStatus, {format::CENTER}) + '\n';
+            }
+
+            size_t waiting = waitlists::totalWaiting();
+            if (waiting > 0) {
+                output += format::formatText(to_string(waiting) + (waiting == 1 ? " party" : " parties") + " on waitlists", {format::CENTER}) + '\n';
+            }
+
+            for (const seatrs::Section& section : seatrs::data::sections) {
+                string summary = section.name + ": ";
+                if (seatrs::isSoldOut(section)) {
+                    summary += "sold out";
+                } else {
+                    summary += to_string(seatrs::freeSeats(section)) + " free";
+                }
+                if (section.held > 0) summary += ", " + to_string(section.held) + " held";
+                summary += ", " + to_string(section.occupied - section.held) + " reserved";
+                output += format::formatText(summary, {format::CENTER}) + '\n';
+            }
+
+            output += buildHeader('-');
+
+            return output;
+        }
+
+        struct GridParams {
+            const vector<uint64_t>* filter = nullptr;       // seats to show as O, others free are "."
+            const vector<uint64_t>* occupied = nullptr;     // reserved seats to draw instead of the current ones
+            bool spaced = true;                             // a space before every seat
+            const vector<string>* rowMargins = nullptr;     // text after each row, with the column counts below
+            size_t marginLength = 0;                        // the length the margins are padded to
+            int width = 0;                                  // the width the lines are centered in
+            int threads = 0;                                // 0 picks from the size of the layout and the cores
+        };
+
+        /**
+         * Gets the characters of 8 seats from a byte of occupancy bits, lowest bit
+         * first, as "XOOX..." or, spaced, as " X O O X...".
+         */
+        const char* seatCharacters(uint8_t occupied, bool spaced) {
+            static const auto tables = [] {
+                array<array<char, 16>, 256> spacedTable, plainTable;
+                for (int byte = 0; byte < 256; byte++) {
+                    for (int bit = 0; bit < 8; bit++) {
+                        char seat = ((byte >> bit) & 1) ? 'X' : 'O';
+                        plainTable[byte][bit] = seat;
+                        spacedTable[byte][bit * 2] = ' ';
+                        spacedTable[byte][bit * 2 + 1] = seat;
+                    }
+                }
+                return make_pair(spacedTable, plainTable);
+            }();
+            return spaced ? tables.first[occupied].data() : tables.second[occupied].data();
+        }
+
+        /**
+         * Renders the seat grid into one preallocated buffer of equal-width lines, so
+         * the offset of every row is known in advance and the rows can be filled by
+         * several threads at once. Seats are written 8 at a time from the occupancy
+         * bits through a lookup table; only the bytes with gaps or filtered seats are
+         * patched seat by seat.
+         *
+         * @param params The parameters of the grid.
+         *
+         * @returns The grid, starting with a newline, with each line centered in the
+         *          given width and no newline at the end.
+         */
+        string renderSeatGrid(const GridParams& params) {
+            int rows = seatrs::data::totalRows, columns = seatrs::data::totalColumns;
+            int wordsPerRow = seatrs::data::wordsPerRow;
+            int cellWidth = params.spaced ? 2 : 1;
+            int gridLength = 1 + columns * cellWidth;
+
+            int digits = 0;
+            if (params.rowMargins) {
+                int mostOccupied = *max_element(seatrs::data::columnOccupied.begin(), seatrs::data::columnOccupied.end());
+                digits = (int) to_string(mostOccupied).size();
+            }
+
+            int lineLength = gridLength + (int) (params.rowMargins ? params.marginLength : 0);
+            int width = max(params.width, lineLength);
+            int spaceLeft = (width - lineLength) / 2;
+            size_t stride = width + 1;
+            int lines = 1 + rows + digits;
+
+            string frame(1 + lines * stride, ' ');
+            frame[0] = '\n';
+            auto lineAt = [&](int iline) { return &frame[1 + iline * stride]; };
+            for (int iline = 0; iline < lines; iline++) lineAt(iline)[width] = '\n';
+
+            // The column numbers
+            char* header = lineAt(0) + spaceLeft + 1;
+            for (int icol = 0; icol < columns; icol++) {
+                header[icol * cellWidth + cellWidth - 1] = '0' + (icol + 1) % 10;
+            }
+
+            auto renderRows = [&](int firstRow, int lastRow) {
+                for (int irow = firstRow; irow < lastRow; irow++) {
+                    char* line = lineAt(1 + irow) + spaceLeft;
+                    line[0] = '0' + (irow + 1) % 10;
+
+                    char* cells = line + 1;
+                    for (int icol = 0; icol < columns; icol += 8) {
+                        size_t word = (size_t) irow * wordsPerRow + icol / 64;
+                        int shift = icol % 64;
+                        const vector<uint64_t>& occupancy = params.occupied ? *params.occupied : seatrs::data::occupancy;
+                        uint8_t reserved = (uint8_t) (occupancy[word] >> shift);
+                        uint8_t exists = (uint8_t) (seatrs::seatMask(irow, icol / 64) >> shift);
+                        uint8_t shown = params.filter ? (uint8_t) ((*params.filter)[word] >> shift) : 0xFF;
+
+                        int count = min(8, columns - icol);
+                        memcpy(cells + icol * cellWidth, seatCharacters(reserved, params.spaced), count * cellWidth);
+
+                        // Gaps are blank and free seats left out by the filter are "."
+                        uint8_t plain = exists & (reserved | shown);
+                        if (plain != 0xFF) {
+                            for (int bit = 0; bit < count; bit++) {
+                                if ((plain >> bit) & 1) continue;
+                                cells[(icol + bit) * cellWidth + cellWidth - 1] = ((exists >> bit) & 1) ? '.' : ' ';
+                            }
+                        }
+                    }
+
+                    if (params.rowMargins) {
+                        const string& margin = (*params.rowMargins)[irow];
+                        memcpy(line + gridLength, margin.data(), margin.size());
+                    }
+                }
+            };
+
+            int threads = params.threads;
+            if (threads <= 0) {
+                // a thread only pays off for a few tens of thousands of seats; the layout
+                // screen is never wider than the HUD, so only layouts of some hundreds of
+                // rows get here with more than one thread, and wider ones only come from
+                // --render-bench
+                threads = (int) min<size_t>(max(1u, thread::hardware_concurrency()), (size_t) rows * columns / 32768 + 1);
+            }
+            threads = max(1, min(threads, rows));
+
+            if (threads == 1) {
+                renderRows(0, rows);
+            } else {
+                vector<thread> workers;
+                for (int i = 0; i < threads; i++) {
+                    workers.emplace_back(renderRows, (int) ((long long) rows * i / threads), (int) ((long long) rows * (i + 1) / threads));
+                }
+                for (thread& worker : workers) worker.join();
+            }
+
+            // Seats taken per column, written downwards below each column
+            for (int idigit = 0; idigit < digits; idigit++) {
+                char* line = lineAt(1 + rows + idigit) + spaceLeft + 1;
+                for (int icol = 0; icol < columns; icol++) {
+                    string taken = to_string(seatrs::data::columnOccupied[icol]);
+                    int position = idigit - (digits - (int) taken.size());
+                    if (position >= 0) line[icol * cellWidth + cellWidth - 1] = taken[position];
+                }
+            }
+
+            frame.pop_back();
+            return frame;
+        }
+
+        /**
+         * Builds the seat layout grid, centered on the HUD, with reserved seats
+         * marked as X, available seats as O, and the gaps of the venue left blank.
+         *
+         * @param filter An optional bitmask (laid out like seatrs::data::occupancy) of
+         *               the seats to show; other available seats are marked as "."
+         * @param occupied An optional bitmask of the reserved seats to draw instead of
+         *                 the current ones, such as those of a showtime. The row and
+         *                 column counts are left out, as they are of the current seats.
+         *
+         * @returns A string representing the seat layout, or an empty string if the
+         *          columns of the seat layout do not fit the HUD length.
+         */
+        string buildSeatLayout(const vector<uint64_t>* filter = nullptr, const vector<uint64_t>* occupied = nullptr) {
+            GridParams params;
+            params.filter = filter;
+            params.occupied = occupied;
+            params.width = program::config::lengthHUD;
+
+            if ((seatrs::data::totalColumns*2) + 1 <= program::config::lengthHUD) {
+                params.spaced = true;
+            } else if (seatrs::data::totalColumns + 1 > program::config::lengthHUD) {
+                return "";
+            } else {
+                params.spaced = false;
+            }
+
+            // The margins come from the row and column aggregates, so they cost
+            // O(rows + columns) instead of another pass over the seats
+            int gridLength = 1 + seatrs::data::totalColumns * (params.spaced ? 2 : 1);
+            vector<string> rowMargins(seatrs::data::totalRows);
+            size_t marginLength = 0;
+            if (occupied == nullptr) {
+                for (int irow = 0; irow < seatrs::data::totalRows; irow++) {
+                    rowMargins[irow] = "  " + to_string(seatrs::data::rowOccupied[irow]) + " taken, " + (
+                        (seatrs::data::rowFirstFree[irow] < 0)
+                            ? string(seatrs::data::rowOccupied[irow] == 0 ? "no seats" : "full")
+                            : "free " + to_string(seatrs::data::rowFirstFree[irow] + 1) + "-" + to_string(seatrs::data::rowLastFree[irow] + 1)
+                    );
+                    marginLength = max(marginLength, rowMargins[irow].size());
+                }
+                if (gridLength + (int) marginLength <= program::config::lengthHUD) {
+                    params.rowMargins = &rowMargins;
+                    params.marginLength = marginLength;
+                }
+            }
+
+            return renderSeatGrid(params);
+        }
+
+        /**
+         * Builds the message explaining why an operation on a seat failed.
+         *
+         * @param result The result of the operation.
+         * @param irow The row of the seat.
+         * @param icol The column of the seat.
+         *
+         * @returns The message to show, or an empty string if the operation succeeded.
+         */
+        string buildResultMessage(seatrs::Result result, int irow, int icol) {
+            string seatText = "The seat [" + to_string(irow + 1) + ", " + to_string(icol + 1) + "]";
+
+            switch (result) {
+                case seatrs::INVALID_SEAT: return seatText + " does not exist.";
+                case seatrs::ALREADY_RESERVED: return seatText + " is already reserved.";
+                case seatrs::NOT_RESERVED: return seatText + " is not reserved.";
+                case seatrs::CONFLICT: return seatText + " was changed in another window. Check it and try again.";
+                default: return "";
+            }
+        }
+
+        /**
+         * The outcome of an operation, as shown on its post screen: the title, the
+         * details to show above the options, and the error if it failed. Shared by the
+         * screens and the operator sessions, so both carry out the same operation.
+         */
+        struct Outcome {
+            string titleText, bodyText, errorMessage;
+        };
+
+        /**
+         * Checks a seat before an operation on it, after catching up with the other
+         * windows sharing the layout.
+         *
+         * @param irow The row of the seat.
+         * @param icol The column of the seat.
+         * @param reserved Whether the operation needs the seat reserved (read, update,
+         *                 delete) or free (create, hold).
+         * @param holding Whether the operation is a hold. A held seat is free to create
+         *                a reservation in, which confirms the hold, but not to hold.
+         *
+         * @returns OK if the operation may go on, INVALID_SEAT, ALREADY_RESERVED or NOT_RESERVED otherwise.
+         */
+        seatrs::Result checkSeat(int irow, int icol, bool reserved, bool holding = false) {
+            shared::pull();
+            if (!seatrs::isValidSeat(irow, icol)) return seatrs::INVALID_SEAT;
+
+            const seatrs::Seat& seat = seatrs::data::seats[irow][icol];
+            if (seat.isReserved == reserved) return seatrs::OK;
+            if (!reserved && seat.isHeld && !holding) return seatrs::OK;
+            return reserved ? seatrs::NOT_RESERVED : seatrs::ALREADY_RESERVED;
+        }
+
+        /**
+         * Builds the outcome of an operation on one seat from its result.
+         */
+        Outcome seatOutcome(const string& titleText, seatrs::Result result, int irow, int icol, const string& doneText) {
+            Outcome outcome;
+            outcome.titleText = titleText + (result == seatrs::OK ? "\n" + doneText : "");
+            outcome.errorMessage = buildResultMessage(result, irow, icol);
+            return outcome;
+        }
+
+        Outcome createOutcome(int irow, int icol, const string& name, const string& description, const string& requestId) {
+            // another window or operator may have taken the seat while this one was typing
+            seatrs::Result result = seatrs::reserveSeat(irow, icol, name, description, requestId);
+            return seatOutcome("[Create Seat Reservation]", result, irow, icol, "Reservation created successfully.");
+        }
+
+        Outcome holdOutcome(int irow, int icol, const string& name, const string& description, const string& requestId) {
+            seatrs::Result result = seatrs::holdSeat(irow, icol, name, description, requestId);
+            return seatOutcome("[Hold Seat]", result, irow, icol, "Seat held until it is reserved or the hold is cancelled.");
+        }
+
+        Outcome updateOutcome(int irow, int icol, const string& name, const string& description, const string& requestId) {
+            seatrs::Result result = seatrs::updateSeat(irow, icol, name, description, requestId);
+            return seatOutcome("[Update Seat Reservation]", result, irow, icol, "Reservation updated successfully.");
+        }
+
+        /**
+         * Cancels a reservation, listing the parties seated from the waitlists in the
+         * seats it freed.
+         */
+        Outcome deleteOutcome(int irow, int icol, const string& requestId) {
+            waitlists::data::lastPromotions.clear();
+            seatrs::Result result = seatrs::cancelSeat(irow, icol, requestId);
+
+            Outcome outcome = seatOutcome("[Delete Seat Reservation]", result, irow, icol, "Reservation deleted successfully.");
+            for (const pair<waitlists::Party, waitlists::Seating>& promotion : waitlists::data::lastPromotions) {
+                const waitlists::Seating& seating = promotion.second;
+                outcome.titleText += 
+                    "\nSeated " + promotion.first.name + " (party of " + to_string(promotion.first.size) + ") from the waitlist"
+                    " in row " + to_string(seating.row + 1) + ", seats " + to_string(seating.firstColumn + 1) + "-" + to_string(seating.lastColumn + 1) + ".";
+            }
+            return outcome;
+        }
+
+        Outcome readOutcome(int irow, int icol) {
+            Outcome outcome;
+            outcome.titleText = "[View/Read Seat Reservation]";
+
+            seatrs::Result state = checkSeat(irow, icol, true);
+            if (state != seatrs::OK) {
+                outcome.errorMessage = buildResultMessage(state, irow, icol);
+                return outcome;
+            }
+
+            format::FormatParams detailsFormat;
+            detailsFormat.align = format::LEFT;
+            detailsFormat.padding = 2;
+
+            const seatrs::Seat& seat = seatrs::data::seats[irow][icol];
+            outcome.titleText += "\nSeat Reservation Details:";
+            outcome.bodyText = format::formatText(
+                "\n"
+                + string(seat.isHeld ? "This seat is held for:\n" : "This seat is reserved by:\n") +
+                " >> Name: " + seat.name + "\n"
+                " >> Description: " + seat.description,
+                detailsFormat
+            ) + "\n\n";
+            return outcome;
+        }
+
+        Outcome findSeatsOutcome(const seatrs::SeatQuery& query) {
+            Outcome outcome;
+            outcome.titleText = "[Find Seats by Attributes]";
+
+            vector<uint64_t> matches = seatrs::querySeats(query);
+            string layout = buildSeatLayout(&matches);
+            if (layout.empty()) {
+                outcome.errorMessage = "The columns of the seat layout exceeds the HUD length!";
+            } else {
+                outcome.titleText += 
+                    "\n" + to_string(seatrs::countBits(matches)) + " matching seats available."
+                    "\nMatching O | X Occupied | . Not Matching";
+                outcome.bodyText = layout + "\n\n";
+            }
+            return outcome;
+        }
+
+        Outcome nearestSeatsOutcome(const seatrs::NearestParams& params) {
+            Outcome outcome;
+            outcome.titleText = "[Find Nearest Free Seats]";
+
+            vector<seatrs::NearSeat> seats = seatrs::nearestFreeSeats(params);
+
+            vector<uint64_t> matches((size_t) seatrs::data::totalRows * seatrs::data::wordsPerRow, 0);
+            string list;
+            for (size_t i = 0; i < seats.size(); i++) {
+                matches[(size_t) seats[i].row * seatrs::data::wordsPerRow + seats[i].column / 64] |= (1ULL << (seats[i].column % 64));
+
+                ostringstream distance;
+                distance.precision(3);
+                distance << seats[i].distance;
+                list += " >> " + to_string(i + 1) + ". Seat [" + to_string(seats[i].row + 1) + ", " + to_string(seats[i].column + 1) + "], distance " + distance.str() + "\n";
+            }
+            string layout = buildSeatLayout(&matches);
+
+            if (seats.empty()) {
+                outcome.errorMessage = "There are no free seats.";
+            } else {
+                outcome.titleText += "\n" + to_string(seats.size()) + " nearest free seats, closest first.";
+                if (!layout.empty()) {
+                    outcome.titleText += "\nFound O | X Occupied | . Other Free Seats";
+                    outcome.bodyText = layout + "\n\n";
+                }
+                outcome.bodyText = format::formatText(list, {format::LEFT, -1, 2}) + "\n" + outcome.bodyText;
+            }
+            return outcome;
+        }
+
+        Outcome countFreeOutcome(int firstRow, int lastRow, int firstColumn, int lastColumn) {
+            Outcome outcome;
+            int freeSeats = seatrs::countFreeSeats(firstRow, lastRow, firstColumn, lastColumn);
+            outcome.titleText = 
+                "[Count Free Seats in an Area]\n" + to_string(freeSeats) + " free seats in rows " + to_string(firstRow + 1) + "-" + to_string(lastRow + 1) 
+                + ", columns " + to_string(firstColumn + 1) + "-" + to_string(lastColumn + 1) + ".";
+
+            // Mark the area on the layout
+            vector<uint64_t> area((size_t) seatrs::data::totalRows * seatrs::data::wordsPerRow, 0);
+            for (int irow = firstRow; irow <= lastRow; irow++) {
+                for (int icol = firstColumn; icol <= lastColumn; icol++) {
+                    area[(size_t) irow * seatrs::data::wordsPerRow + icol / 64] |= (1ULL << (icol % 64));
+                }
+            }
+            string layout = buildSeatLayout(&area);
+
+            if (!layout.empty()) {
+                outcome.titleText += "\nFree in Area O | X Occupied | . Free Outside";
+                outcome.bodyText = layout + "\n\n";
+            }
+            return outcome;
+        }
+
+        /**
+         * Lists the parties waiting in each waitlist, one waitlist per line.
+         */
+        string buildWaitlistSummary() {
+            string summary;
+            for (const waitlists::Waitlist& waitlist : waitlists::data::waitlists) {
+                if (waitlist.waiting == 0) continue;
+                summary += "Rows " + to_string(waitlist.firstRow + 1) + "-" + to_string(waitlist.lastRow + 1) + ": " 
+                    + to_string(waitlist.waiting) + " waiting\n";
+            }
+            return summary.empty() ? "No parties are waiting.\n" : summary;
+        }
+
+        Outcome joinWaitlistOutcome(int firstRow, int lastRow, int size, int priority, const string& name, const string& description) {
+            Outcome outcome;
+            waitlists::Seating seating = waitlists::join(firstRow, lastRow, size, priority, name, description);
+
+            outcome.titleText = "[Join Waitlist]\n";
+            if (seating.seated) {
+                outcome.titleText += 
+                    "Seats were free, so the party was seated in row " + to_string(seating.row + 1) + 
+                    ", seats " + to_string(seating.firstColumn + 1) + "-" + to_string(seating.lastColumn + 1) + ".";
+            } else {
+                outcome.titleText += 
+                    "No " + to_string(size) + " adjacent seats are free, so the party was added to the waitlist."
+                    "\nIt will be seated when a cancellation frees enough seats.";
+            }
+            return outcome;
+        }
+
+        /**
+         * Reads a tier letter, for getSeatAttributes() and the operator sessions.
+         *
+         * @returns An error message, or an empty string with tier set.
+         */
+        string parseTier(const string& value, int& tier) {
+            char letter = (char) toupper((unsigned char) value[0]);
+            if (value.length() != 1 || letter < 'A' || letter > 'Z') {
+                return "Invalid input! Please enter a single letter.";
+            }
+            tier = letter - 'A' + 1;
+            return "";
+        }
+
+        string parsePrice(const string& value, int& price) {
+            int parsed = 0;
+            auto result = from_chars(value.data(), value.data() + value.size(), parsed);
+            if (result.ec != errc() || result.ptr != value.data() + value.size() || parsed < 0) {
+                return "Invalid input! Please enter a whole, non-negative price.";
+            }
+            price = parsed;
+            return "";
+        }
+
+        string parseFeatures(const string& value, int& features) {
+            features = 0;
+            for (char c : value) {
+                switch (tolower((unsigned char) c)) {
+                    case 'a': features |= seatrs::AISLE; break;
+                    case 'w': features |= seatrs::ACCESSIBLE; break;
+                    case ' ': break;
+                    default: return "Invalid input! Please enter only the letters a and w.";
+                }
+            }
+            return "";
+        }
+    }
+
+    namespace templates {
+        using namespace utils;
+
+        /**
+         * Builds a whole screen: the HUD, the title, an optional error message, the
+         * body, and the text of the inputs previously entered on the same screen.
+         *
+         * @param titleText The title of the screen.
+         * @param errorMessage The error message to show, if any.
+         * @param bodyText The body of the screen, if any.
+         * @param prevInputText The previously entered inputs, if any.
+         *
+         * @returns A string representing the entire screen, up to the input prompt.
+         */
+        string buildScreen(const string& titleText, const string& errorMessage, const string& bodyText, const string& prevInputText = "") {
+            format::FormatParams titleFormat;
+            titleFormat.align = format::CENTER;
+            titleFormat.padding = 2;
+
+            screen::currentTitle.assign(titleText, 0, titleText.find('\n'));
+
+            return components::buildHUD() 
+                + format::formatText(titleText, titleFormat) + '\n'
+                + (errorMessage.empty() ? "" : format::formatText("## " + errorMessage + " ##", titleFormat) + '\n')
+                + (bodyText.empty() ? "" : bodyText + '\n')
+                + components::buildHeader('-')
+                + prevInputText;
+        }
+
+        struct HandleIntInputParams {
+            string titleText;
+            string bodyText;
+            string inputPrompt = "Enter your choice: ";
+            string errorMessageInvalidType = "Invalid input! Please enter an integer.";
+            string errorMessageOutOfRange = "Invalid input! Please enter a valid option.";
+            string prevInputText;
+            vector<int> abortInvokers = {0};
+            int minValue = 0, maxValue = 0;
+        };
+
+        struct HandleIntInput {
+            int value = 0;
+            bool error = false;
+            string errorMessage;
+            string inputText;
+        } defaultIntInput;
+
+        /**
+         * Handles integer input with validation and error handling, recursively prompting the user until valid input is received.
+         *
+         * @param params A structure containing parameters for input handling.
+         * @param result An optional parameter if a previous result is available.
+         *
+         * @returns A HandleIntInput structure containing the validated input value.
+         */
+        HandleIntInput handleInput(
+            const HandleIntInputParams params, 
+            HandleIntInput result = defaultIntInput
+        ) {
+            // draw only what changed since the previous screen
+            screen::render(buildScreen(params.titleText, (result.error ? result.errorMessage : ""), params.bodyText, params.prevInputText));
+
+            bool invalid = input::getInput(params.inputPrompt, result.value);
+
+            if (invalid) {
+                result.error = true;
+                result.errorMessage = params.errorMessageInvalidType;
+                return handleInput(params, result);
+            } else {
+                for (auto &invokerValue : params.abortInvokers) {
+                    if (result.error = result.value == invokerValue) {
+                        break;
+                    }
+                    if (!result.error) {
+                        if (result.error = result.value < params.minValue || result.value > params.maxValue) {
+                            result.errorMessage = params.errorMessageOutOfRange;
+                            return handleInput(params, result);
+                        }
+                    }
+                }
+            }
+
+            if (!result.error) {
+                result.errorMessage.clear();
+            }
+            result.inputText = 
+                params.prevInputText.empty()
+                    ? format::formatAsInput(params.inputPrompt, to_string(result.value))
+                    : params.prevInputText + "\n" + format::formatAsInput(params.inputPrompt, to_string(result.value));
+
+            return result;
+        }
+
+        struct HandleStringInputParams {
+            string titleText;
+            string bodyText;
+            string inputPrompt = "Enter input: ";
+            string errorMessageEmpty = "Invalid input! Please enter a non-empty string.";
+            string prevInputText;
+            vector<string> abortInvokers;
+        };
+
+        struct HandleStringInput {
+            string value;
+            bool error = false;
+            string errorMessage;
+            string inputText;
+        } defaultStringInput;
+
+        /**
+         * Handles string input from the user, displaying a formatted screen with instructions
+         * and error messages. Recursively prompts the user for input if validation fails.
+         *
+         * @param params A structure containing parameters for input handling.
+         * @param result An optional parameter if a previous result is available.
+         * @returns A HandleIntInput structure containing the validated input value.
+         */
+        HandleStringInput handleInput(const HandleStringInputParams params, HandleStringInput result = defaultStringInput) {
+            // draw only what changed since the previous screen
+            screen::render(buildScreen(params.titleText, (result.error ? result.errorMessage : ""), params.bodyText, params.prevInputText));
+
+            bool empty = input::getInput(params.inputPrompt, result.value);
+
+            result.error = false;
+            for (auto &invokerValue : params.abortInvokers) {
+                if (result.error = result.value == invokerValue) {
+                    break;
+                }
+            }
+
+            if ((!result.error) && empty && (!params.errorMessageEmpty.empty())) {
+                result.error = true;
+                result.errorMessage = params.errorMessageEmpty;
+                return handleInput(params, result);
+            }
+
+            result.inputText = 
+                params.prevInputText.empty()
+                    ? format::formatAsInput(params.inputPrompt, result.value)
+                    : params.prevInputText + "\n" + format::formatAsInput(params.inputPrompt, result.value);
+
+            return result;
+        }
+
+        struct PostScreenParams {
+            string titleText;
+            string bodyText;
+            string errorMessage;
+            string prompt = "Enter input: ";
+            vector<string> abortInvokers = {"0"};
+        };
+
+        /**
+         * Displays a formatted screen with instructions and error messages, and 
+         * prompts the user for input.
+         *
+         * @param params A structure containing parameters for input handling.
+         *
+         * @returns An integer indicating the status of the function.
+         *          SUCCESS if the user entered a valid input.
+         *          RETURN if the user chose to abort.
+         */
+        int postScreen(const PostScreenParams params) {
+            string value;
+
+            // draw only what changed since the previous screen
+            screen::render(buildScreen(params.titleText, params.errorMessage, params.bodyText));
+
+            input::getInput(params.prompt, value);
+
+            for (auto &invokerValue : params.abortInvokers) {
+                if (value == invokerValue) {
+                    return screen::Status::RETURN;
+                }
+            }
+
+            return screen::Status::SUCCESS;
+        }
+
+        struct RowColumnParams {
+            string titleText;
+            string bodyText;
+            string inputPromptRow = "Enter Row number: ";
+            string inputPromptColumn = "Enter Column number: ";
+            string errorMessageInvalidType = "Invalid input! Please enter an integer.";
+            string errorMessageRowOutOfRange = "Invalid input! Number of row must be between 1 and " + to_string(seatrs::data::totalRows) + ".";
+            string errorMessageColumnOutOfRange = "Invalid input! Number of column must be between 1 and " + to_string(seatrs::data::totalColumns) + ".";
+            int maxInputValueRow = seatrs::data::totalRows;
+            int maxInputValueColumn = seatrs::data::totalColumns;
+        };
+
+        struct RowColumn {
+            int row;
+            int column;
+            bool error = false;
+        } defaultRowColumn;
+
+
+        /**
+         * Prompts the user to enter row and column numbers, and returns their values 
+         * in a RowColumn structure.
+         *
+         * @param params A structure containing parameters for input handling.
+         *
+         * @returns A RowColumn structure, with the "error" field set to true if the 
+         * user entered invalid data or aborted , and the "row" and "column" fields 
+         * set to the entered values if the input was valid.
+         */
+        RowColumn getRowColumn(const RowColumnParams params, RowColumn result = defaultRowColumn) {
+            templates::HandleIntInputParams sharedParams, paramsRow, paramsColumn;
+            
+            sharedParams.titleText = params.titleText;
+            sharedParams.bodyText = params.bodyText;
+            sharedParams.errorMessageInvalidType = params.errorMessageInvalidType;
+            sharedParams.minValue = 1;
+            
+            paramsRow = paramsColumn = sharedParams;
+
+            paramsRow.errorMessageOutOfRange = params.errorMessageRowOutOfRange;
+            paramsRow.inputPrompt = params.inputPromptRow;
+            paramsRow.maxValue = params.maxInputValueRow;
+
+            paramsColumn.errorMessageOutOfRange = params.errorMessageColumnOutOfRange;
+            paramsColumn.inputPrompt = params.inputPromptColumn;
+            paramsColumn.maxValue = params.maxInputValueColumn;
+
+            templates::HandleIntInput resultRow, resultColumn;
+
+            do {
+                resultRow = templates::handleInput(paramsRow);
+
+                if (result.error = resultRow.error) {
+                    break;
+                }
+                
+                paramsColumn.prevInputText = resultRow.inputText;
+                
+                resultColumn = templates::handleInput(paramsColumn);
+
+                result.error = resultColumn.error;
+
+            } while (result.error);
+
+            if (!result.error) {
+                result.row = resultRow.value;
+                result.column = resultColumn.value;
+            }
+
+            return result;
+        }
+
+        struct NameDescriptionParams {
+            string titleText;
+            string bodyText;
+            string inputPromptName = "Enter Name: ";
+            string inputPromptDescription = "Enter Description: ";
+            string errorMessageEmptyName = "Invalid input! Please enter a non-emtpy string.";
+            string errorMessageEmptyDescription;
+        };
+
+        struct NameDescription {
+            string name;
+            string description;
+            bool error = false;
+        } defaultNameDescription;
+
+        /**
+         * Get the name and description from user input.
+         *
+         * @param params The parameters for the function.
+         *
+         * @param result The result of the function. If the result.error is true, the user aborted.
+         * Otherwise, the result.name and result.description contain the name and description entered by the
+         * user.
+         *
+         * @return The result of the function.
+         */
+        NameDescription getNameDescription(const NameDescriptionParams params, NameDescription result = defaultNameDescription) {
+            templates::HandleStringInputParams sharedParams, paramsName, paramsDescription;
+
+            sharedParams.titleText = params.titleText;
+            sharedParams.bodyText = params.bodyText;
+
+            paramsName = paramsDescription = sharedParams;
+
+            paramsName.inputPrompt = params.inputPromptName;
+            paramsName.errorMessageEmpty = params.errorMessageEmptyName;
+
+            paramsDescription.inputPrompt = params.inputPromptDescription;
+            paramsDescription.errorMessageEmpty = params.errorMessageEmptyDescription;
+
+            templates::HandleStringInput resultName, resultDescription;
+
+            do {
+                resultName = templates::handleInput(paramsName);
+
+                if (result.error = resultName.error) {
+                    break;
+                }
+
+                paramsDescription.prevInputText = resultName.inputText;
+
+                resultDescription = templates::handleInput(paramsDescription);
+
+                result.error = resultDescription.error;
+            } while (result.error);
+
+            if (!result.error) {
+                result.name = resultName.value;
+                result.description = resultDescription.value;
+            }
+
+            return result;
+        }
+    }
+
+    namespace templates {
+        struct SeatAttributesParams {
+            string titleText;
+            string bodyText;
+            string prevInputText;
+            string emptyMeaning = "any";    // what leaving an input empty stands for
+        };
+
+        struct SeatAttributes {
+            int tier = 0;           // 0 if left empty
+            int price = -1;         // -1 if left empty
+            int features = 0;
+            bool error = false;
+            string inputText;
+        } defaultSeatAttributes;
+
+        /**
+         * Prompts for one seat attribute until the entered value is valid, or empty.
+         *
+         * @param params The parameters of the input screen.
+         * @param parse A function that reads the entered value, returning an error 
+         *              message if it is invalid.
+         *
+         * @returns A HandleStringInput structure, with the "error" field set to true if
+         *          the user aborted.
+         */
+        HandleStringInput getAttributeInput(const HandleStringInputParams& params, const function<string(const string&)>& parse) {
+            HandleStringInput result;
+
+            while (true) {
+                result = handleInput(params, result);
+                if (result.error) {
+                    return result;
+                }
+
+                result.errorMessage = result.value.empty() ? "" : parse(result.value);
+                if (result.errorMessage.empty()) {
+                    return result;
+                }
+                result.error = true;
+            }
+        }
+
+        /**
+         * Get the tier, price and features of seats from user input. Leaving an input
+         * empty keeps its default value.
+         *
+         * @param params The parameters for the function.
+         *
+         * @param result The result of the function. If the result.error is true, the user aborted.
+         *
+         * @return The result of the function.
+         */
+        SeatAttributes getSeatAttributes(const SeatAttributesParams params, SeatAttributes result = defaultSeatAttributes) {
+            HandleStringInputParams inputParams;
+            inputParams.titleText = params.titleText;
+            inputParams.bodyText = params.bodyText;
+            inputParams.prevInputText = params.prevInputText;
+            inputParams.errorMessageEmpty.clear();
+            inputParams.abortInvokers = {"0"};
+
+            inputParams.inputPrompt = "Enter tier (A-Z, empty for " + params.emptyMeaning + "): ";
+            HandleStringInput tierResult = getAttributeInput(inputParams, [&](const string& value) {
+                return components::parseTier(value, result.tier);
+            });
+            result.error = tierResult.error;
+            if (result.error) {
+                return result;
+            }
+
+            inputParams.prevInputText = tierResult.inputText;
+            inputParams.inputPrompt = "Enter price (empty for " + params.emptyMeaning + "): ";
+            HandleStringInput priceResult = getAttributeInput(inputParams, [&](const string& value) {
+                return components::parsePrice(value, result.price);
+            });
+            result.error = priceResult.error;
+            if (result.error) {
+                return result;
+            }
+
+            inputParams.prevInputText = priceResult.inputText;
+            inputParams.inputPrompt = "Enter features (a = aisle, w = wheelchair access, empty for none): ";
+            HandleStringInput featuresResult = getAttributeInput(inputParams, [&](const string& value) {
+                return components::parseFeatures(value, result.features);
+            });
+            result.error = featuresResult.error;
+            if (result.error) {
+                return result;
+            }
+
+            result.inputText = featuresResult.inputText;
+            return result;
+        }
+    }
+
+    namespace screen {
+        using namespace utils;
+
+        /**
+         * Makes a request ID for one filled-in form of a screen, so a form that is
+         * carried out twice, such as by a double-sent Enter, reserves or cancels once.
+         */
+        string newRequestId() {
+            static const string prefix = "screen-" + to_string(chrono::steady_clock::now().time_since_epoch().count()) + "-";
+            static uint64_t forms = 0;
+            return prefix + to_string(++forms);
+        }
+
+        int optionsSetHUDLength() {
+            templates::HandleIntInputParams setHUDLengthParams;
+
+            setHUDLengthParams.titleText =
+                "[Edit HUD Length]\n"
+                "Enter new HUD length.";
+            
+            setHUDLengthParams.bodyText = string(components::generated<components::ReturnOptions>());
+
+            setHUDLengthParams.errorMessageOutOfRange = "Invalid input! Please enter an integer between " + to_string(program::control::minLengthHUD) + " and " + to_string(program::control::maxLengthHUD) + ".";
+            setHUDLengthParams.inputPrompt = "Enter new HUD length: ";
+            setHUDLengthParams.minValue = program::control::minLengthHUD;
+            setHUDLengthParams.maxValue = program::control::maxLengthHUD;
+
+            templates::HandleIntInput result = templates::handleInput(setHUDLengthParams);
+
+            if (result.error) {
+                return RETURN;
+            }
+
+            program::config::lengthHUD = result.value;
+
+            return SUCCESS;
+        }
+
+        int optionsSetDimensions() {
+            templates::RowColumnParams rowColumnParams;
+
+            rowColumnParams.titleText = 
+                "[Edit Seat Layout Dimensions]\n" 
+                "Enter new dimensions.";
+            
+            rowColumnParams.errorMessageRowOutOfRange = "Invalid input! Number of row must be between 1 and " + to_string(program::control::maxPossibleRows) + ".";
+            rowColumnParams.errorMessageColumnOutOfRange = "Invalid input! Number of column must be between 1 and " + to_string(program::control::maxPossibleColumns) + ".";
+
+            rowColumnParams.inputPromptRow = "Enter the number of rows: ";
+            rowColumnParams.inputPromptColumn = "Enter the number of columns: ";
+
+            rowColumnParams.maxInputValueRow = program::control::maxPossibleRows;
+            rowColumnParams.maxInputValueColumn = program::control::maxPossibleColumns;
+
+            templates::RowColumn result = getRowColumn(rowColumnParams);
+
+            if (result.error) {
+                return RETURN;
+            } 
+            
+            seatrs::setSize(result.row, result.column);
+            return SUCCESS;
+        }
+
+        int optionsImportReservations() {
+            templates::HandleStringInputParams pathParams;
+
+            pathParams.titleText = 
+                "[Import Reservations]\n"
+                "Enter the path of a CSV file of row, column, name and description.";
+            pathParams.bodyText = string(components::generated<components::ReturnOptions>());
+            pathParams.inputPrompt = "Enter file path: ";
+            pathParams.errorMessageEmpty = "Invalid input! Please enter a file path.";
+            pathParams.abortInvokers = {"0"};
+
+            templates::HandleStringInput pathResult = templates::handleInput(pathParams);
+
+            if (pathResult.error) {
+                return RETURN;
+            }
+
+            transfer::ImportReport report = transfer::importCSV(pathResult.value);
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Import Reservations]";
+            postParams.bodyText = string(components::generated<components::EnterReturnOptions>());
+
+            if (report.error) {
+                postParams.errorMessage = report.errorMessage;
+                templates::postScreen(postParams);
+                return SUCCESS;
+            }
+
+            format::FormatParams detailsFormat;
+            detailsFormat.align = format::LEFT;
+            detailsFormat.padding = 2;
+
+            string details = 
+                "\n"
+                " >> Records read: " + to_string(report.records) + "\n"
+                " >> Imported: " + to_string(report.imported) + "\n"
+                " >> Conflicts: " + to_string(report.conflicts) + "\n"
+                " >> Invalid: " + to_string(report.invalid) + "\n"
+                " >> Time: " + to_string(report.seconds) + " s (" + to_string((long long) (report.records / max(report.seconds, 1e-9))) + " records/s)";
+
+            for (auto &problem : report.problems) {
+                details += "\n - " + problem;
+            }
+
+            postParams.titleText += "\nImport finished.";
+            postParams.bodyText = format::formatText(details, detailsFormat) + "\n\n" + postParams.bodyText;
+            templates::postScreen(postParams);
+
+            return SUCCESS;
+        }
+
+        int optionsLoadVenueMap() {
+            templates::HandleStringInputParams pathParams;
+
+            pathParams.titleText = 
+                "[Load Venue Map]\n"
+                "Enter the path of a venue map: one line per row, O for a seat, and a space or . for a gap.";
+            pathParams.bodyText = string(components::generated<components::ReturnOptions>());
+            pathParams.inputPrompt = "Enter file path: ";
+            pathParams.errorMessageEmpty = "Invalid input! Please enter a file path.";
+            pathParams.abortInvokers = {"0"};
+
+            templates::HandleStringInput pathResult = templates::handleInput(pathParams);
+
+            if (pathResult.error) {
+                return RETURN;
+            }
+
+            transfer::VenueMap map = transfer::loadVenueMap(pathResult.value);
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Load Venue Map]";
+            postParams.bodyText = string(components::generated<components::EnterReturnOptions>());
+
+            if (map.error) {
+                postParams.errorMessage = map.errorMessage;
+            } else {
+                postParams.titleText += 
+                    "\nLoaded a venue of " + to_string(map.rows) + " rows and " + to_string(map.columns) + " columns"
+                    " with " + to_string(map.seats) + " seats.";
+            }
+            templates::postScreen(postParams);
+
+            return SUCCESS;
+        }
+
+        int optionsAllocateParties() {
+            templates::HandleStringInputParams pathParams;
+
+            pathParams.titleText = 
+                "[Allocate Parties]\n"
+                "Enter the path of a CSV file of name, size, rows (e.g. 5-10, empty for any) and description.";
+            pathParams.bodyText = string(components::generated<components::ReturnOptions>());
+            pathParams.inputPrompt = "Enter file path: ";
+            pathParams.errorMessageEmpty = "Invalid input! Please enter a file path.";
+            pathParams.abortInvokers = {"0"};
+
+            templates::HandleStringInput pathResult = templates::handleInput(pathParams);
+
+            if (pathResult.error) {
+                return RETURN;
+            }
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Allocate Parties]";
+            postParams.bodyText = string(components::generated<components::EnterReturnOptions>());
+
+            allocation::PartyFile file = allocation::readParties(pathResult.value);
+            if (file.error) {
+                postParams.errorMessage = file.errorMessage;
+                templates::postScreen(postParams);
+                return SUCCESS;
+            }
+
+            allocation::AllocationParams params;
+            params.parties = file.parties;
+            allocation::AllocationReport report = allocation::allocateParties(params);
+
+            format::FormatParams detailsFormat;
+            detailsFormat.align = format::LEFT;
+            detailsFormat.padding = 2;
+
+            string details = 
+                "\n"
+                " >> Parties: " + to_string(params.parties.size()) + "\n"
+                " >> Placed: " + to_string(report.placed) + "\n"
+                " >> Not placed: " + to_string(report.unplaced) + "\n"
+                " >> Single-seat gaps: " + to_string(report.singleGapsBefore) + " before, " + to_string(report.singleGapsAfter) + " after\n"
+                " >> Plans tried: " + to_string(report.attempts) + " in " + to_string(report.seconds) + " s";
+
+            // The first few placements, or the parties that did not fit
+            size_t shown = 0;
+            for (size_t iparty = 0; iparty < params.parties.size() && shown < 5; iparty++) {
+                const allocation::Placement& placement = report.placements[iparty];
+                const allocation::PartyRequest& party = params.parties[iparty];
+                if (report.committed && placement.row >= 0) {
+                    details += "\n - " + party.name + ": row " + to_string(placement.row + 1) + ", seats " 
+                        + to_string(placement.firstColumn + 1) + "-" + to_string(placement.firstColumn + party.size);
+                    shown++;
+                } else if (placement.row < 0) {
+                    details += "\n - " + party.name + " (" + to_string(party.size) + " seats) did not fit";
+                    shown++;
+                }
+            }
+
+            if (report.committed) {
+                postParams.titleText += "\nEvery party was seated.";
+            } else {
+                postParams.errorMessage = report.errorMessage;
+            }
+            postParams.bodyText = format::formatText(details, detailsFormat) + "\n\n" + postParams.bodyText;
+            templates::postScreen(postParams);
+
+            return SUCCESS;
+        }
+
+        int optionsExportReservations() {
+            string titleText = 
+                "[Export Reservations]\n"
+                "Choose the format and the rows to export.";
+
+            templates::HandleIntInputParams formatParams;
+            formatParams.titleText = titleText;
+            formatParams.bodyText = string(components::generated<components::ExportFormatOptions>());
+            formatParams.inputPrompt = "Enter the format: ";
+            formatParams.minValue = 1;
+            formatParams.maxValue = 2;
+
+            templates::HandleIntInputParams firstRowParams;
+            firstRowParams.titleText = titleText;
+            firstRowParams.bodyText = string(components::generated<components::ReturnSettingsOptions>());
+            firstRowParams.inputPrompt = "Enter the first row: ";
+            firstRowParams.errorMessageOutOfRange = "Invalid input! Number of row must be between 1 and " + to_string(seatrs::data::totalRows) + ".";
+            firstRowParams.minValue = 1;
+            firstRowParams.maxValue = seatrs::data::totalRows;
+
+            templates::HandleIntInputParams lastRowParams = firstRowParams;
+            lastRowParams.inputPrompt = "Enter the last row: ";
+
+            templates::HandleStringInputParams pathParams;
+            pathParams.titleText = titleText;
+            pathParams.bodyText = firstRowParams.bodyText;
+            pathParams.inputPrompt = "Enter file path: ";
+            pathParams.errorMessageEmpty = "Invalid input! Please enter a file path.";
+            pathParams.abortInvokers = {"0"};
+
+            templates::HandleIntInput formatResult = templates::handleInput(formatParams);
+            if (formatResult.error) {
+                return RETURN;
+            }
+
+            firstRowParams.prevInputText = formatResult.inputText;
+            templates::HandleIntInput firstRowResult = templates::handleInput(firstRowParams);
+            if (firstRowResult.error) {
+                return RETURN;
+            }
+
+            lastRowParams.prevInputText = firstRowResult.inputText;
+            lastRowParams.minValue = firstRowResult.value;
+            lastRowParams.errorMessageOutOfRange = "Invalid input! Number of row must be between " + to_string(firstRowResult.value) + " and " + to_string(seatrs::data::totalRows) + ".";
+            templates::HandleIntInput lastRowResult = templates::handleInput(lastRowParams);
+            if (lastRowResult.error) {
+                return RETURN;
+            }
+
+            pathParams.prevInputText = lastRowResult.inputText;
+            templates::HandleStringInput pathResult = templates::handleInput(pathParams);
+            if (pathResult.error) {
+                return RETURN;
+            }
+
+            transfer::ExportReport report = transfer::exportReservations(
+                pathResult.value, 
+                (transfer::ExportFormat) formatResult.value, 
+                firstRowResult.value, 
+                lastRowResult.value
+            );
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Export Reservations]";
+            postParams.bodyText = string(components::generated<components::EnterReturnOptions>());
+
+            if (report.error) {
+                postParams.errorMessage = report.errorMessage;
+                templates::postScreen(postParams);
+                return SUCCESS;
+            }
+
+            format::FormatParams detailsFormat;
+            detailsFormat.align = format::LEFT;
+            detailsFormat.padding = 2;
+
+            string details = 
+                "\n"
+                " >> Reservations exported: " + to_string(report.records) + "\n"
+                " >> Bytes written: " + to_string(report.bytes) + "\n"
+                " >> Time: " + to_string(report.seconds) + " s (" + to_string(report.bytes / max(report.seconds, 1e-9) / 1e6) + " MB/s)";
+
+            postParams.titleText += "\nExport finished.";
+            postParams.bodyText = format::formatText(details, detailsFormat) + "\n\n" + postParams.bodyText;
+            templates::postScreen(postParams);
+
+            return SUCCESS;
+        }
+
+        int optionsSetSeatAttributes() {
+            string titleText = 
+                "[Edit Seat Attributes]\n"
+                "Enter the first and last seat of the range, then its attributes.";
+            string bodyText = string(components::generated<components::ReturnSettingsOptions>());
+
+            templates::RowColumnParams firstParams;
+            firstParams.titleText = titleText;
+            firstParams.bodyText = bodyText;
+            firstParams.inputPromptRow = "Enter the first Row: ";
+            firstParams.inputPromptColumn = "Enter the first Column: ";
+
+            templates::RowColumnParams lastParams = firstParams;
+            lastParams.inputPromptRow = "Enter the last Row: ";
+            lastParams.inputPromptColumn = "Enter the last Column: ";
+
+            templates::RowColumn first = templates::getRowColumn(firstParams);
+            if (first.error) {
+                return RETURN;
+            }
+
+            templates::RowColumn last = templates::getRowColumn(lastParams);
+            if (last.error) {
+                return RETURN;
+            }
+
+            templates::SeatAttributesParams attributesParams;
+            attributesParams.titleText = titleText;
+            attributesParams.bodyText = bodyText;
+            attributesParams.emptyMeaning = "none";
+            attributesParams.prevInputText = 
+                format::formatAsInput("Seats: ", 
+                    "[" + to_string(first.row) + ", " + to_string(first.column) + "] to [" 
+                    + to_string(last.row) + ", " + to_string(last.column) + "]");
+
+            templates::SeatAttributes attributes = templates::getSeatAttributes(attributesParams);
+            if (attributes.error) {
+                return RETURN;
+            }
+
+            seatrs::Result result = seatrs::setAttributes(
+                first.row - 1, last.row - 1, first.column - 1, last.column - 1, 
+                attributes.tier, max(attributes.price, 0), attributes.features
+            );
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Edit Seat Attributes]";
+            postParams.bodyText = string(components::generated<components::EnterReturnOptions>());
+
+            if (result != seatrs::OK) {
+                postParams.errorMessage = "The first seat must come before the last seat.";
+            } else {
+                postParams.titleText += "\nSeat attributes updated successfully.";
+            }
+            templates::postScreen(postParams);
+
+            return SUCCESS;
+        }
+
+        int optionsMemoryStatistics() {
+            const utils::memory::ScratchArena& scratch = utils::memory::frameScratch;
+            size_t seats = (size_t) seatrs::data::totalRows * seatrs::data::totalColumns;
+            size_t seatBytes = seats * sizeof(seatrs::Seat) + seatrs::data::totalRows * sizeof(seatrs::Seat*);
+            size_t columnBytes = 
+                seatrs::data::tiers.capacity() * sizeof(uint8_t) + seatrs::data::prices.capacity() * sizeof(int32_t) + 
+                seatrs::data::features.capacity() * sizeof(uint8_t) + seatrs::data::occupancy.capacity() * sizeof(uint64_t) +
+                (seatrs::data::rowOccupied.capacity() * 3 + seatrs::data::columnOccupied.capacity() * 3) * sizeof(int);
+
+            string details = 
+                "\n"
+                " >> Seat arena: " + to_string(seats) + " seats in one block, " + to_string(seatBytes) + " bytes\n"
+                " >> Seat attributes, bits and counts: " + to_string(columnBytes) + " bytes\n"
+                " >> Frame scratch: " + to_string(scratch.peakUsed) + " of " + to_string(sizeof(scratch.buffer)) + " bytes at peak\n"
+                " >> Scratch allocations: " + to_string(scratch.allocations) + ", " + to_string(scratch.fallbacks) + " fell back to the heap\n"
+                " >> Frames reset: " + to_string(scratch.resets) + "\n"
+                " >> Resident set size: " + to_string(utils::memory::residentBytes() / 1024) + " KB";
+
+            format::FormatParams detailsFormat;
+            detailsFormat.align = format::LEFT;
+            detailsFormat.padding = 2;
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Memory Statistics]";
+            postParams.bodyText = format::formatText(details, detailsFormat) + "\n\n" + string(components::generated<components::EnterReturnOptions>());
+            templates::postScreen(postParams);
+
+            return SUCCESS;
+        }
+
+        int optionsEditSections() {
+            string titleText = 
+                "[Edit Sections]\n"
+                "Enter a section name and its rows. An existing section is replaced, or removed with row 0.";
+
+            // Lists the current sections above the options
+            string list;
+            for (const seatrs::Section& section : seatrs::data::sections) {
+                list += section.name + ": rows " + to_string(section.firstRow + 1) + "-" + to_string(section.lastRow + 1) 
+                    + ", " + to_string(section.seats) + " seats\n";
+            }
+            if (list.empty()) list = "No sections yet.\n";
+
+            format::FormatParams listFormat;
+            listFormat.align = format::LEFT;
+            listFormat.padding = 2;
+
+            templates::HandleStringInputParams nameParams;
+            nameParams.titleText = titleText;
+            nameParams.bodyText = format::formatText(list, listFormat) + "\n\n" + string(components::generated<components::ReturnSettingsOptions>());
+            nameParams.inputPrompt = "Enter the section name: ";
+            nameParams.errorMessageEmpty = "Invalid input! Please enter a section name.";
+            nameParams.abortInvokers = {"0"};
+
+            templates::HandleIntInputParams firstRowParams;
+            firstRowParams.titleText = titleText;
+            // 0 removes the section here, instead of returning
+            firstRowParams.bodyText = format::formatText(list, listFormat) + "\n";
+            firstRowParams.abortInvokers = {};
+            firstRowParams.inputPrompt = "Enter the first row: ";
+            firstRowParams.errorMessageOutOfRange = "Invalid input! Number of row must be between 0 and " + to_string(seatrs::data::totalRows) + ".";
+            firstRowParams.minValue = 0;
+            firstRowParams.maxValue = seatrs::data::totalRows;
+
+            templates::HandleIntInputParams lastRowParams = firstRowParams;
+            lastRowParams.inputPrompt = "Enter the last row: ";
+
+            templates::HandleStringInput nameResult = templates::handleInput(nameParams);
+            if (nameResult.error) {
+                return RETURN;
+            }
+
+            firstRowParams.prevInputText = nameResult.inputText;
+            templates::HandleIntInput firstRowResult = templates::handleInput(firstRowParams);
+            if (firstRowResult.error) {
+                return RETURN;
+            }
+
+            vector<seatrs::Section> sections = seatrs::data::sections;
+            int existing = seatrs::findSection(nameResult.value);
+            if (existing >= 0) {
+                sections.erase(sections.begin() + existing);
+            }
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Edit Sections]";
+            postParams.bodyText = string(components::generated<components::EnterReturnOptions>());
+
+            if (firstRowResult.value == 0) {
+                if (existing < 0) {
+                    postParams.errorMessage = "There is no section named \"" + nameResult.value + "\".";
+                } else {
+                    seatrs::setSections(sections);
+                    postParams.titleText += "\nRemoved the section " + nameResult.value + ".";
+                }
+                templates::postScreen(postParams);
+                return SUCCESS;
+            }
+
+            lastRowParams.prevInputText = firstRowResult.inputText;
+            lastRowParams.minValue = firstRowResult.value;
+            lastRowParams.errorMessageOutOfRange = "Invalid input! Number of row must be between " + to_string(firstRowResult.value) + " and " + to_string(seatrs::data::totalRows) + ".";
+            templates::HandleIntInput lastRowResult = templates::handleInput(lastRowParams);
+            if (lastRowResult.error) {
+                return RETURN;
+            }
+
+            seatrs::Section section;
+            section.name = nameResult.value;
+            section.firstRow = firstRowResult.value - 1;
+            section.lastRow = lastRowResult.value - 1;
+            sections.push_back(section);
+
+            if (seatrs::setSections(sections) == seatrs::OK) {
+                const seatrs::Section& added = seatrs::data::sections[seatrs::findSection(section.name)];
+                postParams.titleText += 
+                    "\nThe section " + added.name + " has rows " + to_string(added.firstRow + 1) + "-" + to_string(added.lastRow + 1) 
+                    + " and " + to_string(added.seats) + " seats.";
+            } else {
+                postParams.errorMessage = "The rows " + to_string(section.firstRow + 1) + "-" + to_string(section.lastRow + 1) + " are already in another section.";
+            }
+            templates::postScreen(postParams);
+
+            return SUCCESS;
+        }
+
+        int optionsMenu() {
+            int status;
+            templates::HandleIntInputParams choiceParams;
+
+            choiceParams.titleText = 
+                "[Settings]\n" 
+                "Choose an option.";
+            
+            choiceParams.bodyText = string(components::generated<components::SettingsOptions>());
+            choiceParams.minValue = 0;
+            choiceParams.maxValue = 10;
+
+            do {
+                templates::HandleIntInput result = templates::handleInput(choiceParams);
+
+                switch (result.value) {
+                    case 1: {
+                        status = FINISH;
+                        break;
+                    }
+                    case 2: {
+                        status = optionsSetDimensions();
+                        break;
+                    }
+                    case 3: {
+                        status = optionsSetHUDLength();
+                        break;
+                    }
+                    case 4: {
+                        status = optionsImportReservations();
+                        break;
+                    }
+                    case 5: {
+                        status = optionsExportReservations();
+                        break;
+                    }
+                    case 6: {
+                        status = optionsSetSeatAttributes();
+                        break;
+                    }
+                    case 7: {
+                        status = optionsMemoryStatistics();
+                        break;
+                    }
+                    case 8: {
+                        status = optionsLoadVenueMap();
+                        break;
+                    }
+                    case 9: {
+                        status = optionsAllocateParties();
+                        break;
+                    }
+                    case 10: {
+                        status = optionsEditSections();
+                        break;
+                    }
+                    case 0: {
+                        status = SUCCESS;
+                        break;
+                    }
+                }
+            } while (status == RETURN);
+
+            return status;
+        }
+
+        int showSeatLayout() {
+            templates::PostScreenParams seatLayoutParams;
+
+            seatLayoutParams.titleText = "[Show Seat Layout]";
+            string bodytextInstructions = string(components::generated<components::EnterReturnOptions>());
+
+            string bodyText = components::buildSeatLayout();
+
+            if (bodyText.empty()) {
+                seatLayoutParams.bodyText = bodytextInstructions;
+                seatLayoutParams.errorMessage = "The columns of the seat layout exceeds the HUD length!";
+                templates::postScreen(seatLayoutParams);
+                return RETURN;
+            }
+
+            seatLayoutParams.bodyText = bodyText + "\n\n" + bodytextInstructions;
+            seatLayoutParams.titleText += "\nNot Occupied O | X Occupied";
+
+            templates::postScreen(seatLayoutParams);
+
+            return SUCCESS;
+        }
+
+        int findSeats() {
+            int status;
+
+            templates::SeatAttributesParams attributesParams;
+            attributesParams.titleText = 
+                "[Find Seats by Attributes]\n"
+                "Enter the attributes the available seats must have.";
+            attributesParams.bodyText = string(components::generated<components::ReturnOptions>());
+
+            templates::PostScreenParams postParams;
+
+            do {
+                templates::SeatAttributes attributes = templates::getSeatAttributes(attributesParams);
+
+                if (attributes.error) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                seatrs::SeatQuery query;
+                query.tier = attributes.tier;
+                query.maxPrice = attributes.price;
+                query.features = attributes.features;
+
+                components::Outcome outcome = components::findSeatsOutcome(query);
+                postParams.titleText = outcome.titleText;
+                postParams.bodyText = outcome.bodyText + string(components::generated<components::FindSeatsPostOptions>());
+                postParams.errorMessage = outcome.errorMessage;
+
+                status = templates::postScreen(postParams);
+            } while (status == RETURN);
+
+            return status;
+        }
+
+        int findNearestSeats() {
+            int status;
+
+            string titleText = 
+                "[Find Nearest Free Seats]\n"
+                "Enter the preferred seat, how many seats to find, and how much rows count against seats.";
+            string bodyText = string(components::generated<components::ReturnOptions>());
+
+            templates::HandleIntInputParams inputParams;
+            inputParams.titleText = titleText;
+            inputParams.bodyText = bodyText;
+
+            templates::PostScreenParams postParams;
+
+            do {
+                inputParams.prevInputText.clear();
+                inputParams.bodyText = bodyText;
+
+                // The prompts, and the ranges of their values
+                struct Prompt { string text; int minValue, maxValue; };
+                vector<Prompt> prompts = {
+                    {"Enter Row number: ", 1, seatrs::data::totalRows},
+                    {"Enter Column number: ", 1, seatrs::data::totalColumns},
+                    {"Enter number of seats (1-20): ", 1, 20},
+                    {"Enter row weight (1-9): ", 1, 9},
+                    {"Enter seat weight (1-9): ", 1, 9},
+                    {"Choose the distance: ", 1, 2}
+                };
+                vector<int> values;
+
+                for (const Prompt& prompt : prompts) {
+                    inputParams.inputPrompt = prompt.text;
+                    inputParams.minValue = prompt.minValue;
+                    inputParams.maxValue = prompt.maxValue;
+                    inputParams.errorMessageOutOfRange = "Invalid input! Please enter a number from " + to_string(prompt.minValue) + " to " + to_string(prompt.maxValue) + ".";
+                    if (values.size() == prompts.size() - 1) {
+                        inputParams.bodyText = string(components::generated<components::MetricOptions>());
+                    }
+
+                    templates::HandleIntInput result = templates::handleInput(inputParams);
+                    if (result.error) break;
+
+                    values.push_back(result.value);
+                    inputParams.prevInputText = result.inputText;
+                }
+
+                if (values.size() < prompts.size()) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                seatrs::NearestParams params;
+                params.row = values[0] - 1;
+                params.column = values[1] - 1;
+                params.count = values[2];
+                params.rowWeight = values[3];
+                params.columnWeight = values[4];
+                params.metric = (seatrs::Metric) values[5];
+
+                components::Outcome outcome = components::nearestSeatsOutcome(params);
+                postParams.titleText = outcome.titleText;
+                postParams.bodyText = outcome.bodyText + string(components::generated<components::FindSeatsPostOptions>());
+                postParams.errorMessage = outcome.errorMessage;
+
+                status = templates::postScreen(postParams);
+            } while (status == RETURN);
+
+            return status;
+        }
+
+        int countFreeSeats() {
+            int status;
+
+            templates::HandleIntInputParams inputParams;
+            inputParams.titleText = 
+                "[Count Free Seats in an Area]\n"
+                "Enter the rows and columns of the area.";
+            inputParams.bodyText = string(components::generated<components::ReturnOptions>());
+
+            templates::PostScreenParams postParams;
+            postParams.bodyText = string(components::generated<components::CountPostOptions>());
+
+            do {
+                inputParams.prevInputText.clear();
+
+                struct Prompt { string text; int maxValue; };
+                vector<Prompt> prompts = {
+                    {"Enter first row: ", seatrs::data::totalRows},
+                    {"Enter last row: ", seatrs::data::totalRows},
+                    {"Enter first column: ", seatrs::data::totalColumns},
+                    {"Enter last column: ", seatrs::data::totalColumns}
+                };
+                vector<int> values;
+
+                for (size_t i = 0; i < prompts.size(); i++) {
+                    // the last row and column start from the first ones
+                    inputParams.minValue = (i % 2 == 1) ? values[i - 1] : 1;
+                    inputParams.maxValue = prompts[i].maxValue;
+                    inputParams.inputPrompt = prompts[i].text;
+                    inputParams.errorMessageOutOfRange = "Invalid input! Please enter a number from " + to_string(inputParams.minValue) + " to " + to_string(inputParams.maxValue) + ".";
+
+                    templates::HandleIntInput result = templates::handleInput(inputParams);
+                    if (result.error) break;
+
+                    values.push_back(result.value);
+                    inputParams.prevInputText = result.inputText;
+                }
+
+                if (values.size() < prompts.size()) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                int firstRow = values[0] - 1, lastRow = values[1] - 1;
+                int firstColumn = values[2] - 1, lastColumn = values[3] - 1;
+                components::Outcome outcome = components::countFreeOutcome(firstRow, lastRow, firstColumn, lastColumn);
+                postParams.titleText = outcome.titleText;
+                postParams.bodyText = outcome.bodyText + string(components::generated<components::CountPostOptions>());
+
+                status = templates::postScreen(postParams);
+            } while (status == RETURN);
+
+            return status;
+        }
+
+        /**
+         * Lists the showtimes, numbered from 1, with the seats booked for each.
+         */
+        string buildShowList() {
+            string list;
+            for (size_t ishow = 0; ishow < showtimes::data::shows.size(); ishow++) {
+                const showtimes::Show& show = showtimes::data::shows[ishow];
+                list += "[" + to_string(ishow + 1) + "] " + showtimes::formatTime(show.start) + "-" + showtimes::formatTime(show.end) 
+                    + " " + show.title + " (" + to_string(show.occupied) + "/" + to_string(seatrs::data::totalSeats) + " booked)\n";
+            }
+            return list.empty() ? "No showtimes yet.\n" : list;
+        }
+
+        /**
+         * Prompts for a time of day, written as HH:MM.
+         *
+         * @param params The parameters of the input screen.
+         * @param minutes Set to the minutes from midnight of the entered time.
+         *
+         * @returns A HandleStringInput structure, with the "error" field set to true if
+         *          the user aborted.
          */
-        string buildHeader(char lineChar = '=', int length = program::config::lengthHUD, bool newLine = true) {
-            return (newLine ? string(length, lineChar) + '\n' : string(length, lineChar));
+        templates::HandleStringInput getTime(const templates::HandleStringInputParams& params, int& minutes) {
+            return templates::getAttributeInput(params, [&](const string& value) {
+                minutes = showtimes::parseTime(value);
+                return (minutes < 0) ? string("Invalid input! Please enter a time from 00:00 to 24:00 as HH:MM.") : string();
+            });
+        }
+
+        int showtimesAdd() {
+            templates::HandleStringInputParams inputParams;
+            inputParams.titleText = 
+                "[Add Showtime]\n"
+                "Enter the start and end of the showing, and its title.";
+            inputParams.bodyText = buildShowList() + "\n" + string(components::generated<components::ReturnShowtimesOptions>());
+            inputParams.abortInvokers = {"0"};
+
+            int start = 0, end = 0;
+            inputParams.inputPrompt = "Enter start (HH:MM): ";
+            templates::HandleStringInput startResult = getTime(inputParams, start);
+            if (startResult.error) return RETURN;
+
+            inputParams.prevInputText = startResult.inputText;
+            inputParams.inputPrompt = "Enter end (HH:MM): ";
+            templates::HandleStringInput endResult = getTime(inputParams, end);
+            if (endResult.error) return RETURN;
+
+            inputParams.prevInputText = endResult.inputText;
+            inputParams.inputPrompt = "Enter title: ";
+            templates::HandleStringInput titleResult = templates::handleInput(inputParams);
+            if (titleResult.error) return RETURN;
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Add Showtime]";
+            postParams.bodyText = string(components::generated<components::EnterReturnShowtimesOptions>());
+
+            if (showtimes::addShow(start, end, titleResult.value) < 0) {
+                postParams.errorMessage = "The showing must end after it starts.";
+            } else {
+                postParams.titleText += "\nShowtime added.";
+                postParams.bodyText = buildShowList() + "\n" + postParams.bodyText;
+            }
+            templates::postScreen(postParams);
+
+            return RETURN;
+        }
+
+        int showtimesBook() {
+            string bodyText = buildShowList() + "\n" + string(components::generated<components::ReturnShowtimesOptions>());
+
+            templates::HandleStringInputParams timeParams;
+            timeParams.titleText = 
+                "[Book a Seat]\n"
+                "Enter the time window of the booking, such as the times of a showing.";
+            timeParams.bodyText = bodyText;
+            timeParams.abortInvokers = {"0"};
+
+            int start = 0, end = 0;
+            timeParams.inputPrompt = "Enter start (HH:MM): ";
+            templates::HandleStringInput startResult = getTime(timeParams, start);
+            if (startResult.error) return RETURN;
+
+            timeParams.prevInputText = startResult.inputText;
+            timeParams.inputPrompt = "Enter end (HH:MM): ";
+            templates::HandleStringInput endResult = getTime(timeParams, end);
+            if (endResult.error) return RETURN;
+
+            templates::RowColumnParams rcParams;
+            rcParams.titleText = 
+                "[Book a Seat]\n"
+                "Enter the row and column of the seat, booked " + showtimes::formatTime(start) + "-" + showtimes::formatTime(end) + ".";
+            rcParams.bodyText = bodyText;
+            templates::RowColumn rcResult = templates::getRowColumn(rcParams);
+            if (rcResult.error) return RETURN;
+
+            templates::NameDescriptionParams ndParams;
+            ndParams.titleText = rcParams.titleText;
+            ndParams.bodyText = bodyText;
+            templates::NameDescription ndResult = templates::getNameDescription(ndParams);
+            if (ndResult.error) return RETURN;
+
+            seatrs::Result result = showtimes::book(rcResult.row - 1, rcResult.column - 1, start, end, ndResult.name, ndResult.description, newRequestId());
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Book a Seat]";
+            postParams.bodyText = string(components::generated<components::EnterReturnShowtimesOptions>());
+            if (result == seatrs::OK) {
+                postParams.titleText += "\nBooked from " + showtimes::formatTime(start) + " to " + showtimes::formatTime(end) + ".";
+            } else if (end <= start) {
+                postParams.errorMessage = "The booking must end after it starts.";
+            } else {
+                postParams.errorMessage = components::buildResultMessage(result, rcResult.row - 1, rcResult.column - 1);
+                if (result == seatrs::ALREADY_RESERVED) postParams.errorMessage = "The seat is already booked during that time.";
+            }
+            templates::postScreen(postParams);
+
+            return RETURN;
+        }
+
+        int showtimesCancel() {
+            templates::RowColumnParams rcParams;
+            rcParams.titleText = 
+                "[Cancel a Booking]\n"
+                "Enter the row and column of the seat, and a time during the booking.";
+            rcParams.bodyText = string(components::generated<components::ReturnShowtimesOptions>());
+            templates::RowColumn rcResult = templates::getRowColumn(rcParams);
+            if (rcResult.error) return RETURN;
+
+            templates::HandleStringInputParams timeParams;
+            timeParams.titleText = rcParams.titleText;
+            timeParams.bodyText = rcParams.bodyText;
+            timeParams.abortInvokers = {"0"};
+            timeParams.inputPrompt = "Enter a time during the booking (HH:MM): ";
+
+            int time = 0;
+            templates::HandleStringInput timeResult = getTime(timeParams, time);
+            if (timeResult.error) return RETURN;
+
+            seatrs::Result result = showtimes::cancelBooking(rcResult.row - 1, rcResult.column - 1, time, newRequestId());
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Cancel a Booking]";
+            postParams.bodyText = string(components::generated<components::EnterReturnShowtimesOptions>());
+            if (result == seatrs::OK) {
+                postParams.titleText += "\nBooking cancelled.";
+            } else {
+                postParams.errorMessage = (result == seatrs::NOT_RESERVED) 
+                    ? "The seat is not booked at " + showtimes::formatTime(time) + "."
+                    : components::buildResultMessage(result, rcResult.row - 1, rcResult.column - 1);
+            }
+            templates::postScreen(postParams);
+
+            return RETURN;
+        }
+
+        int showtimesLayout() {
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Show Seat Layout of a Showtime]";
+            postParams.bodyText = string(components::generated<components::EnterReturnShowtimesOptions>());
+
+            if (showtimes::data::shows.empty()) {
+                postParams.errorMessage = "There are no showtimes yet.";
+                templates::postScreen(postParams);
+                return RETURN;
+            }
+
+            templates::HandleIntInputParams showParams;
+            showParams.titleText = 
+                "[Show Seat Layout of a Showtime]\n"
+                "Choose a showtime.";
+            showParams.bodyText = buildShowList() + "\n" + string(components::generated<components::ReturnShowtimesOptions>());
+            showParams.minValue = 1;
+            showParams.maxValue = (int) showtimes::data::shows.size();
+
+            templates::HandleIntInput choice = templates::handleInput(showParams);
+            if (choice.error) return RETURN;
+
+            // The occupancy of each show is kept up to date, so drawing it costs no more than the current layout
+            const showtimes::Show& show = showtimes::data::shows[choice.value - 1];
+            string layout = components::buildSeatLayout(nullptr, &show.occupancy);
+
+            postParams.titleText += 
+                "\n" + showtimes::formatTime(show.start) + "-" + showtimes::formatTime(show.end) + " " + show.title 
+                + ": " + to_string(show.occupied) + "/" + to_string(seatrs::data::totalSeats) + " seats booked.";
+            if (layout.empty()) {
+                postParams.errorMessage = "The columns of the seat layout exceeds the HUD length!";
+            } else {
+                postParams.bodyText = layout + "\n\n" + postParams.bodyText;
+            }
+            templates::postScreen(postParams);
+
+            return RETURN;
+        }
+
+        int showtimesFreeWindow() {
+            templates::HandleStringInputParams timeParams;
+            timeParams.titleText = 
+                "[Find Seats Free for a Time Window]\n"
+                "Enter the window the seats must be free for.";
+            timeParams.bodyText = buildShowList() + "\n" + string(components::generated<components::ReturnShowtimesOptions>());
+            timeParams.abortInvokers = {"0"};
+
+            int start = 0, end = 0;
+            timeParams.inputPrompt = "Enter start (HH:MM): ";
+            templates::HandleStringInput startResult = getTime(timeParams, start);
+            if (startResult.error) return RETURN;
+
+            timeParams.prevInputText = startResult.inputText;
+            timeParams.inputPrompt = "Enter end (HH:MM): ";
+            templates::HandleStringInput endResult = getTime(timeParams, end);
+            if (endResult.error) return RETURN;
+
+            templates::PostScreenParams postParams;
+            postParams.titleText = "[Find Seats Free for a Time Window]";
+            postParams.bodyText = string(components::generated<components::EnterReturnShowtimesOptions>());
+
+            if (end <= start) {
+                postParams.errorMessage = "The window must end after it starts.";
+                templates::postScreen(postParams);
+                return RETURN;
+            }
+
+            vector<uint64_t> free = showtimes::freeSeats(start, end);
+            vector<uint64_t> booked(free.size());
+            for (size_t word = 0; word < free.size(); word++) {
+                booked[word] = ~free[word] & seatrs::data::validity[word];
+            }
+            string layout = components::buildSeatLayout(nullptr, &booked);
+
+            postParams.titleText += 
+                "\n" + to_string(seatrs::countBits(free)) + " seats free for the whole of " 
+                + showtimes::formatTime(start) + "-" + showtimes::formatTime(end) + "."
+                "\nFree O | X Booked during the window";
+            if (!layout.empty()) {
+                postParams.bodyText = layout + "\n\n" + postParams.bodyText;
+            }
+            templates::postScreen(postParams);
+
+            return RETURN;
+        }
+
+        int showtimesMenu() {
+            int status;
+            templates::HandleIntInputParams choiceParams;
+
+            choiceParams.titleText = 
+                "[Showtimes]\n" 
+                "Choose an option.";
+            choiceParams.minValue = 0;
+            choiceParams.maxValue = 5;
+
+            do {
+                choiceParams.bodyText = buildShowList() + "\n" + string(components::generated<components::ShowtimesOptions>());
+                templates::HandleIntInput result = templates::handleInput(choiceParams);
+
+                switch (result.value) {
+                    case 1: {
+                        status = showtimesAdd();
+                        break;
+                    }
+                    case 2: {
+                        status = showtimesBook();
+                        break;
+                    }
+                    case 3: {
+                        status = showtimesCancel();
+                        break;
+                    }
+                    case 4: {
+                        status = showtimesLayout();
+                        break;
+                    }
+                    case 5: {
+                        status = showtimesFreeWindow();
+                        break;
+                    }
+                    case 0: {
+                        status = SUCCESS;
+                        break;
+                    }
+                }
+            } while (status == RETURN);
+
+            return status;
+        }
+
+        int createReservation() {
+            int status;
+
+            string bodyText = string(components::generated<components::ReturnOptions>());
+
+            templates::RowColumnParams rcParams;
+            rcParams.titleText = 
+                "[Create Seat Reservation]\n"
+                "Enter the row and column of the seat.";
+            rcParams.bodyText = bodyText;
+            templates::RowColumn rcResult;
+            
+            templates::NameDescriptionParams ndParams;
+            ndParams.titleText = 
+                "[Create Seat Reservation]\n"
+                "Enter the Name and Description for the reservation.";
+            ndParams.bodyText = bodyText;
+            templates::NameDescription ndResult;
+            
+            templates::PostScreenParams postParams;
+            postParams.bodyText = string(components::generated<components::CreatePostOptions>());
+            
+            do {
+                postParams.titleText = "[Create Seat Reservation]";
+                string requestId = newRequestId();
+
+                rcResult = templates::getRowColumn(rcParams);
+
+                if (rcResult.error) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                int irow = rcResult.row - 1;
+                int icolumn = rcResult.column - 1;
+
+                seatrs::Result state = components::checkSeat(irow, icolumn, false);
+                if (state != seatrs::OK) {
+                    postParams.errorMessage = components::buildResultMessage(state, irow, icolumn);
+                    status = templates::postScreen(postParams);
+                    continue;
+                }
+
+                ndResult = templates::getNameDescription(ndParams);
+
+                if (ndResult.error) {
+                    status == RETURN;
+                } else {
+                    components::Outcome outcome = components::createOutcome(irow, icolumn, ndResult.name, ndResult.description, requestId);
+                    postParams.titleText = outcome.titleText;
+                    postParams.errorMessage = outcome.errorMessage;
+                    status = templates::postScreen(postParams);
+                }
+
+            } while (status == RETURN);
+
+            return status;
+        }
+
+        int holdReservation() {
+            int status;
+
+            string bodyText = string(components::generated<components::ReturnOptions>());
+
+            templates::RowColumnParams rcParams;
+            rcParams.titleText = 
+                "[Hold Seat]\n"
+                "Enter the row and column of the seat.";
+            rcParams.bodyText = bodyText;
+            templates::RowColumn rcResult;
+            
+            templates::NameDescriptionParams ndParams;
+            ndParams.titleText = 
+                "[Hold Seat]\n"
+                "Enter the Name and Description for the hold.";
+            ndParams.bodyText = bodyText;
+            templates::NameDescription ndResult;
+            
+            templates::PostScreenParams postParams;
+            postParams.bodyText = string(components::generated<components::HoldPostOptions>());
+            
+            do {
+                postParams.titleText = "[Hold Seat]";
+                string requestId = newRequestId();
+
+                rcResult = templates::getRowColumn(rcParams);
+
+                if (rcResult.error) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                int irow = rcResult.row - 1;
+                int icolumn = rcResult.column - 1;
+
+                seatrs::Result state = components::checkSeat(irow, icolumn, false, true);
+                if (state != seatrs::OK) {
+                    postParams.errorMessage = components::buildResultMessage(state, irow, icolumn);
+                    status = templates::postScreen(postParams);
+                    continue;
+                }
+
+                ndResult = templates::getNameDescription(ndParams);
+
+                if (ndResult.error) {
+                    status = RETURN;
+                } else {
+                    components::Outcome outcome = components::holdOutcome(irow, icolumn, ndResult.name, ndResult.description, requestId);
+                    postParams.titleText = outcome.titleText;
+                    postParams.errorMessage = outcome.errorMessage;
+                    status = templates::postScreen(postParams);
+                }
+
+            } while (status == RETURN);
+
+            return status;
         }
 
-        /**
-         * Builds the entire HUD string, consisting of the name art, title, and information about the
-         * layout dimensions and the number of occupied seats.
-         *
-         * @returns A string representing the entire HUD.
-         */
-        string buildHUD() {
-            int length = program::config::lengthHUD;
+        int readReservation() {
+            int status;
 
-            vector<string> nameArtLines = {
-                "░██████╗░░█████╗░██████╗░░░░░░░░░░██████╗██████╗░░██████╗",
-                "██╔════╝░██╔══██╗██╔══██╗░░░░░░░░██╔════╝██╔══██╗██╔════╝",
-                "██║░░██╗░███████║██████╔╝░█████╗░╚█████╗░██████╔╝░╚████╗░",
-                "██║░░╚██╗██╔══██║██╔═══╝░░╚════╝░░╚═══██╗██╔══██╗░╚═══██╗",
-                "╚██████╔╝██║░░██║██║░░░░░░░░░░░░░██████╔╝██║░░██║██████╔╝",
-                "░╚═════╝░╚═╝░░╚═╝╚═╝░░░░░░░░░░░░░╚═════╝░╚═╝░░╚═╝╚═════╝░" 
-            };
+            templates::RowColumnParams rcParams;
+            rcParams.titleText = 
+                "[View/Read Seat Reservation]\n"
+                "Enter the row and column of the seat reservation to read.";
+            rcParams.bodyText = string(components::generated<components::ReturnOptions>());
+            templates::RowColumn rcResult;
+            
+            templates::PostScreenParams postParams;
+            
+            do {
+                rcResult = templates::getRowColumn(rcParams);
 
-            format::FormatParams nameArtFormat;
+                if (rcResult.error) {
+                    status = SUCCESS;
+                    break;
+                }
 
-            nameArtFormat.align = format::CENTER;
-            nameArtFormat.limitLength = length;
-            nameArtFormat.space = "░";
-            nameArtFormat.explicitTextLength = 57;
+                components::Outcome outcome = components::readOutcome(rcResult.row - 1, rcResult.column - 1);
+                postParams.titleText = outcome.titleText;
+                postParams.bodyText = outcome.bodyText + string(components::generated<components::ReadPostOptions>());
+                postParams.errorMessage = outcome.errorMessage;
+                status = templates::postScreen(postParams);
 
-            string nameArt = format::formatText(nameArtLines, nameArtFormat) + '\n';
+            } while (status == RETURN);
 
-            format::FormatParams titleNameFormat = {format::CENTER, length - 20};
-            format::FormatParams titleInfoFormat = {format::RIGHT, 19};
+            return status;
+        }
 
-            string title = buildHeader() 
-                + format::formatText("Geevoi A. Plaza's", titleNameFormat) + "|" + format::formatText("CS-1105", titleInfoFormat) + "\n"
-                + format::formatText("Seat Reservation System", titleNameFormat) + "|" + format::formatText("CS 111", titleInfoFormat) + "\n"
-                + buildHeader();
+        int updateReservation() {
+            int status;
 
-            format::FormatParams hudDimensionsFormat = {format::LEFT, length/2};
-            format::FormatParams hudOccupiedFormat = {format::RIGHT, (length % 2 == 0 ? length/2 : (length/2) + 1)};
+            string bodyText = string(components::generated<components::ReturnOptions>());
 
-            string output = nameArt + title
-                + format::formatText(
-                    (to_string(seatrs::data::totalRows) + " Rows x " + to_string(seatrs::data::totalColumns) + " Cols"),
-                    hudDimensionsFormat
-                ) 
-                + format::formatText(
-                    (to_string(seatrs::data::totalOccupiedSeats) + "/" + to_string(seatrs::data::totalRows * seatrs::data::totalColumns) + " seats occupied"),
-                    hudOccupiedFormat
-                ) + '\n'
-                + buildHeader('-');
+            templates::RowColumnParams rcParams;
+            rcParams.titleText = 
+                "[Update Seat Reservation]\n"
+                "Enter the row and column of the seat.";
+            rcParams.bodyText = bodyText;
+            templates::RowColumn rcResult;
+            
+            templates::NameDescriptionParams ndParams;
+            ndParams.titleText = 
+                "[Update Seat Reservation]\n"
+                "Enter the Name and Description for the reservation.";
+            ndParams.bodyText = bodyText;
+            templates::NameDescription ndResult;
+            
+            templates::PostScreenParams postParams;
+            postParams.bodyText = string(components::generated<components::UpdatePostOptions>());
+            
+            do {
+                postParams.titleText = "[Update Seat Reservation]";
+                string requestId = newRequestId();
 
-            return output;
+                rcResult = templates::getRowColumn(rcParams);
+
+                if (rcResult.error) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                int irow = rcResult.row - 1;
+                int icolumn = rcResult.column - 1;
+
+                seatrs::Result state = components::checkSeat(irow, icolumn, true);
+                if (state != seatrs::OK) {
+                    postParams.errorMessage = components::buildResultMessage(state, irow, icolumn);
+                    status = templates::postScreen(postParams);
+                    continue;
+                }
+
+                ndResult = templates::getNameDescription(ndParams);
+
+                if (ndResult.error) {
+                    status == RETURN;
+                } else {
+                    components::Outcome outcome = components::updateOutcome(irow, icolumn, ndResult.name, ndResult.description, requestId);
+                    postParams.titleText = outcome.titleText;
+                    postParams.errorMessage = outcome.errorMessage;
+                    status = templates::postScreen(postParams);
+                }
+
+            } while (status == RETURN);
+
+            return status;
         }
-    }
 
-    namespace templates {
-        using namespace utils;
+        int deleteReservation() {
+            int status;
 
-        struct HandleIntInputParams {
-            string titleText;
-            string bodyText;
-            string inputPrompt = "Enter your choice: ";
-            string errorMessageInvalidType = "Invalid input! Please enter an integer.";
-            string errorMessageOutOfRange = "Invalid input! Please enter a valid option.";
-            string prevInputText;
-            vector<int> abortInvokers = {0};
-            int minValue = 0, maxValue = 0;
-        };
+            templates::RowColumnParams rcParams;
+            rcParams.titleText = 
+                "[Delete Seat Reservation]\n"
+                "Enter the row and column of the seat reservation to cancel.";
+            rcParams.bodyText = string(components::generated<components::ReturnOptions>());
+            templates::RowColumn rcResult;
+            
+            templates::PostScreenParams postParams;
+            postParams.bodyText = string(components::generated<components::DeletePostOptions>());
+            
+            do {
+                postParams.titleText = "[Delete Seat Reservation]";
+                string requestId = newRequestId();
 
-        struct HandleIntInput {
-            int value = 0;
-            bool error = false;
-            string errorMessage;
-            string inputText;
-        } defaultIntInput;
+                rcResult = templates::getRowColumn(rcParams);
+
+                if (!rcResult.error) {
+                    int irow = rcResult.row - 1;
+                    int icolumn = rcResult.column - 1;
+
+                    seatrs::Result state = components::checkSeat(irow, icolumn, true);
+                    if (state != seatrs::OK) {
+                        postParams.errorMessage = components::buildResultMessage(state, irow, icolumn);
+                        status = templates::postScreen(postParams);
+                        continue;
+                    }
+
+                    components::Outcome outcome = components::deleteOutcome(irow, icolumn, requestId);
+                    postParams.titleText = outcome.titleText;
+                    postParams.errorMessage = outcome.errorMessage;
+                    status = templates::postScreen(postParams);
+                }
+
+                status = SUCCESS;
+
+            } while (status == RETURN);
+
+            return status;
+        }
+
+        int joinWaitlist() {
+            int status;
+
+            templates::HandleIntInputParams rowParams, partyParams;
+            rowParams.minValue = 1;
+            rowParams.maxValue = seatrs::data::totalRows;
+            rowParams.errorMessageOutOfRange = "Invalid input! Please enter a row in the seat layout.";
+            
+            templates::NameDescriptionParams ndParams;
+            ndParams.titleText = 
+                "[Join Waitlist]\n"
+                "Enter the Name and Description for the party.";
+            ndParams.bodyText = string(components::generated<components::ReturnOptions>());
+            templates::NameDescription ndResult;
+
+            templates::PostScreenParams postParams;
+            postParams.bodyText = string(components::generated<components::WaitlistPostOptions>());
+
+            do {
+                rowParams.titleText = partyParams.titleText = 
+                    "[Join Waitlist]\n"
+                    "Enter the rows the party can sit in, its size, and its priority.";
+                rowParams.bodyText = partyParams.bodyText = 
+                    components::buildWaitlistSummary() + "\n" + string(components::generated<components::ReturnOptions>());
+
+                rowParams.prevInputText.clear();
+                rowParams.minValue = 1;
+                rowParams.inputPrompt = "Enter first row: ";
+                templates::HandleIntInput firstRow = templates::handleInput(rowParams);
+                if (firstRow.error) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                rowParams.prevInputText = firstRow.inputText;
+                rowParams.minValue = firstRow.value;
+                rowParams.inputPrompt = "Enter last row: ";
+                templates::HandleIntInput lastRow = templates::handleInput(rowParams);
+                if (lastRow.error) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                partyParams.prevInputText = lastRow.inputText;
+                partyParams.minValue = 1;
+                partyParams.maxValue = waitlists::maxPartySize;
+                partyParams.inputPrompt = "Enter party size (1-" + to_string(waitlists::maxPartySize) + "): ";
+                partyParams.errorMessageOutOfRange = "Invalid input! Please enter a party size from 1 to " + to_string(waitlists::maxPartySize) + ".";
+                templates::HandleIntInput size = templates::handleInput(partyParams);
+                if (size.error) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                partyParams.prevInputText = size.inputText;
+                partyParams.maxValue = 9;
+                partyParams.inputPrompt = "Enter priority (1-9, higher is seated first): ";
+                partyParams.errorMessageOutOfRange = "Invalid input! Please enter a priority from 1 to 9.";
+                templates::HandleIntInput priority = templates::handleInput(partyParams);
+                if (priority.error) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                ndResult = templates::getNameDescription(ndParams);
+                if (ndResult.error) {
+                    status = SUCCESS;
+                    break;
+                }
+
+                components::Outcome outcome = components::joinWaitlistOutcome(
+                    firstRow.value - 1, lastRow.value - 1, size.value, priority.value, ndResult.name, ndResult.description);
+                postParams.titleText = outcome.titleText;
+                status = templates::postScreen(postParams);
+            } while (status == RETURN);
+
+            return status;
+        }
+
+        int mainMenu() {
+            int status;
+            templates::HandleIntInputParams choiceParams;
+
+            choiceParams.titleText = 
+                "[Main Menu]\n" 
+                "Choose an option.";
+            
+            choiceParams.bodyText = string(components::generated<components::MainMenuOptions>());
+            choiceParams.minValue = 0;
+            choiceParams.maxValue = 11;
+
+            do {
+                templates::HandleIntInput result = templates::handleInput(choiceParams);
+
+                switch (result.value) {
+                    case 1: {
+                        status = showSeatLayout();
+                        break;
+                    }
+                    case 2: {
+                        status = createReservation();
+                        break;
+                    }
+                    case 3: {
+                        status = readReservation();
+                        break;
+                    }
+                    case 4: {
+                        status = updateReservation();
+                        break;
+                    }
+                    case 5: {
+                        status = deleteReservation();
+                        break;
+                    }
+                    case 6: {
+                        status = findSeats();
+                        break;
+                    }
+                    case 7: {
+                        status = joinWaitlist();
+                        break;
+                    }
+                    case 8: {
+                        status = findNearestSeats();
+                        break;
+                    }
+                    case 9: {
+                        status = countFreeSeats();
+                        break;
+                    }
+                    case 10: {
+                        status = showtimesMenu();
+                        break;
+                    }
+                    case 11: {
+                        status = holdReservation();
+                        break;
+                    }
+                    case 0: {
+                        status = optionsMenu();
+                        break;
+                    }
+                    
+                }
+            } while (status != 0);
+        
+            return 0;
+        }
 
         /**
-         * Handles integer input with validation and error handling, recursively prompting the user until valid input is received.
+         * An output that throws away everything written to it, only counting the bytes.
+         */
+        struct CountingSink : streambuf {
+            long long bytes = 0;
+
+            int overflow(int character) override {
+                bytes++;
+                return character;
+            }
+
+            streamsize xsputn(const char*, streamsize count) override {
+                bytes += count;
+                return count;
+            }
+        };
+
+        /**
+         * Replays a recorded session through the real screens as fast as possible, with
+         * the output sent to a sink, and reports the total time and the time spent on
+         * each screen: from reading one input line until prompting for the next.
          *
-         * @param params A structure containing parameters for input handling.
-         * @param result An optional parameter if a previous result is available.
+         * @param path The path of the recording, made with --record.
          *
-         * @returns A HandleIntInput structure containing the validated input value.
+         * @returns The exit code of the program.
          */
-        HandleIntInput handleInput(
-            const HandleIntInputParams params, 
-            HandleIntInput result = defaultIntInput
-        ) {
-            // clear screen
-            screen::clear();
-
-            format::FormatParams titleFormat;
-            titleFormat.align = format::CENTER;
-            titleFormat.padding = 2;
+        int replaySession(const string& path) {
+            double recordedSeconds;
+            if (input::loadReplay(path, recordedSeconds)) {
+                cerr << "Unable to read the recording \"" << path << "\"." << endl;
+                return 1;
+            }
 
-            cout << components::buildHUD() 
-                << (format::formatText(params.titleText, titleFormat)) << endl
-                << (result.error ? format::formatText("## " + result.errorMessage + " ##", titleFormat) + '\n' : "")
-                << (params.bodyText.empty() ? "" : params.bodyText + '\n')
-                << components::buildHeader('-');
+            struct ScreenTime {
+                string title;
+                long long visits = 0;
+                double seconds = 0, longest = 0;
+            };
+            vector<ScreenTime> screens;
+
+            auto started = chrono::steady_clock::now();
+            auto lastRead = started;
+
+            input::inputLog.onRead = [&] {
+                auto now = chrono::steady_clock::now();
+                double seconds = chrono::duration<double>(now - lastRead).count();
+                lastRead = now;
+
+                auto found = find_if(screens.begin(), screens.end(), [](const ScreenTime& screen) {
+                    return screen.title == currentTitle;
+                });
+                if (found == screens.end()) {
+                    screens.push_back({currentTitle});
+                    found = screens.end() - 1;
+                }
+                found->visits++;
+                found->seconds += seconds;
+                found->longest = max(found->longest, seconds);
+            };
 
-            if (!params.prevInputText.empty()) {
-                cout << params.prevInputText;
+            CountingSink sink;
+            streambuf* console = cout.rdbuf(&sink);
+            try {
+                mainMenu();
+            } catch (const input::ReplayFinished&) {}
+            cout.rdbuf(console);
+
+            double totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+            input::inputLog.replaying = false;
+            input::inputLog.onRead = nullptr;
+
+            sort(screens.begin(), screens.end(), [](const ScreenTime& a, const ScreenTime& b) {
+                return a.seconds > b.seconds;
+            });
+
+            ostringstream report;
+            report.setf(ios::fixed);
+            report.precision(2);
+            report << "Replayed " << input::inputLog.next << " input lines in " << totalSeconds * 1000 << " ms ("
+                << "recorded session: " << recordedSeconds << " s), " << sink.bytes << " bytes of output\n\n"
+                << format::formatText("Screen", {format::LEFT, 40})
+                << format::formatText("Visits", {format::RIGHT, 8})
+                << format::formatText("Total ms", {format::RIGHT, 11})
+                << format::formatText("Mean us", {format::RIGHT, 10})
+                << format::formatText("Max us", {format::RIGHT, 10}) << '\n';
+
+            for (const ScreenTime& screen : screens) {
+                ostringstream total, mean, longest;
+                total.setf(ios::fixed);
+                total.precision(3);
+                total << screen.seconds * 1000;
+                mean.setf(ios::fixed);
+                mean.precision(1);
+                mean << screen.seconds * 1e6 / screen.visits;
+                longest.setf(ios::fixed);
+                longest.precision(1);
+                longest << screen.longest * 1e6;
+
+                report << format::formatText(screen.title.empty() ? "(no title)" : screen.title, {format::LEFT, 40})
+                    << format::formatText(to_string(screen.visits), {format::RIGHT, 8})
+                    << format::formatText(total.str(), {format::RIGHT, 11})
+                    << format::formatText(mean.str(), {format::RIGHT, 10})
+                    << format::formatText(longest.str(), {format::RIGHT, 10}) << '\n';
             }
 
-            bool invalid = input::getInput(params.inputPrompt, result.value);
+            cout << report.str();
+            return 0;
+        }
 
-            if (invalid) {
-                result.error = true;
-                result.errorMessage = params.errorMessageInvalidType;
-                return handleInput(params, result);
-            } else {
-                for (auto &invokerValue : params.abortInvokers) {
-                    if (result.error = result.value == invokerValue) {
-                        break;
-                    }
-                    if (!result.error) {
-                        if (result.error = result.value < params.minValue || result.value > params.maxValue) {
-                            result.errorMessage = params.errorMessageOutOfRange;
-                            return handleInput(params, result);
-                        }
+        /**
+         * Runs a long simulated kiosk session to watch memory over time: seats are
+         * reserved and cancelled under names of random lengths, the layout is resized
+         * now and then, and the layout and menu screens are rendered to a sink. The
+         * resident set size is reported at regular points.
+         *
+         * @param frames The number of frames to render.
+         *
+         * @returns The exit code of the program.
+         */
+        int soakMemory(int frames) {
+            mt19937 random(12345);
+            CountingSink sink;
+            const int reports = 20;
+
+            cout << format::formatText("Frame", {format::RIGHT, 10})
+                << format::formatText("RSS KB", {format::RIGHT, 12})
+                << format::formatText("Scratch peak", {format::RIGHT, 14})
+                << format::formatText("Fallbacks", {format::RIGHT, 11}) << endl;
+
+            streambuf* console = cout.rdbuf(&sink);
+            for (int frame = 1; frame <= frames; frame++) {
+                if (frame % 5000 == 0) {
+                    seatrs::setSize(10 + random() % 20, 10 + random() % 25);
+                }
+
+                for (int i = 0; i < 4; i++) {
+                    int irow = random() % seatrs::data::totalRows, icol = random() % seatrs::data::totalColumns;
+                    if (seatrs::reserveSeat(irow, icol, string(1 + random() % 60, 'n'), string(random() % 120, 'd')) != seatrs::OK) {
+                        seatrs::cancelSeat(irow, icol);
                     }
                 }
-            }
 
-            if (!result.error) {
-                result.errorMessage.clear();
+                render(templates::buildScreen("[Show Seat Layout]", "", components::buildSeatLayout()));
+                render(templates::buildScreen("[Main Menu]\nChoose an option.", "", string(components::generated<components::MainMenuOptions>())));
+
+                if (frame % max(1, frames / reports) == 0) {
+                    cout.rdbuf(console);
+                    cout << format::formatText(to_string(frame), {format::RIGHT, 10})
+                        << format::formatText(to_string(utils::memory::residentBytes() / 1024), {format::RIGHT, 12})
+                        << format::formatText(to_string(utils::memory::frameScratch.peakUsed), {format::RIGHT, 14})
+                        << format::formatText(to_string(utils::memory::frameScratch.fallbacks), {format::RIGHT, 11}) << endl;
+                    cout.rdbuf(&sink);
+                }
             }
-            result.inputText = 
-                params.prevInputText.empty()
-                    ? format::formatAsInput(params.inputPrompt, to_string(result.value))
-                    : params.prevInputText + "\n" + format::formatAsInput(params.inputPrompt, to_string(result.value));
+            cout.rdbuf(console);
 
-            return result;
+            return 0;
         }
+    }
+}
 
-        struct HandleStringInputParams {
-            string titleText;
-            string bodyText;
-            string inputPrompt = "Enter input: ";
-            string errorMessageEmpty = "Invalid input! Please enter a non-empty string.";
-            string prevInputText;
-            vector<string> abortInvokers;
-        };
+namespace sessions {
+    using namespace utils;
+    using namespace display;
+
+    enum Step {
+        MENU,
+        ROW,
+        COLUMN,
+        NAME,
+        DESCRIPTION,
+        FORM,
+        POST
+    };
 
-        struct HandleStringInput {
-            string value;
-            bool error = false;
-            string errorMessage;
-            string inputText;
-        } defaultStringInput;
+    // Output a session may have waiting before it stops getting every frame. Once the
+    // client reads it, the session gets the latest frame, so a stalled client only
+    // ever holds this much plus one frame.
+    const size_t maxPendingOutput = 64 * 1024;
 
-        /**
-         * Handles string input from the user, displaying a formatted screen with instructions
-         * and error messages. Recursively prompts the user for input if validation fails.
-         *
-         * @param params A structure containing parameters for input handling.
-         * @param result An optional parameter if a previous result is available.
-         * @returns A HandleIntInput structure containing the validated input value.
-         */
-        HandleStringInput handleInput(const HandleStringInputParams params, HandleStringInput result = defaultStringInput) {
-            // clear screen
-            screen::clear();
+    /**
+     * The state of one operator's screen flow. Instead of blocking on input like the
+     * screens in display::screen, a session stores where it is in the flow so it can 
+     * be resumed whenever its next input line arrives.
+     */
+    struct Session {
+        int inputFd = -1;
+        int outputFd = -1;
+        string pendingInput;        // bytes received that do not form a full line yet
+        string pendingOutput;       // bytes not yet accepted by the output
+        bool frameSkipped = false;  // a frame was left out while the output was backed up
+        screen::FrameBuffer frame;
+        Step step = MENU;
+        int option = 0;             // main menu option being carried out
+        int row = 0, column = 0;
+        string name;
+        vector<string> answers;     // the lines entered so far on a FORM step
+        string errorMessage;
+        string postTitle, postBody;
+        string lastRequestId;       // of the last tagged line carried out
+        bool closed = false;
+    };
 
-            format::FormatParams titleFormat;
-            titleFormat.align = format::CENTER;
-            titleFormat.padding = 2;
+    const string optionTitles[] = {
+        "",
+        "[Show Seat Layout]",
+        "[Create Seat Reservation]",
+        "[View/Read Seat Reservation]",
+        "[Update Seat Reservation]",
+        "[Delete Seat Reservation]",
+        "[Find Seats by Attributes]",
+        "[Join Waitlist]",
+        "[Find Nearest Free Seats]",
+        "[Count Free Seats in an Area]",
+        "",
+        "[Hold Seat]"
+    };
+
+    string_view (* const postOptions[])(int) = {
+        nullptr,
+        components::generated<components::EnterReturnOptions>,
+        components::generated<components::CreatePostOptions>,
+        components::generated<components::ReadPostOptions>,
+        components::generated<components::UpdatePostOptions>,
+        components::generated<components::DeletePostOptions>,
+        components::generated<components::FindSeatsPostOptions>,
+        components::generated<components::WaitlistPostOptions>,
+        components::generated<components::FindSeatsPostOptions>,
+        components::generated<components::CountPostOptions>,
+        nullptr,
+        components::generated<components::HoldPostOptions>
+    };
+
+    /**
+     * A prompt of a FORM step. A number must be from minValue, or from the answer to
+     * the prompt minAnswer if set, up to maxValue, and 0 returns to the menu. Text is
+     * checked by check if given, and must not be empty otherwise; 0 only returns to
+     * the menu from the attributes of a seat, where it cannot be a valid answer.
+     */
+    struct Prompt {
+        string text;
+        int minValue = 0, maxValue = 0;
+        int minAnswer = -1;
+        bool isText = false;
+        string (*check)(const string&) = nullptr;
+    };
+
+    /**
+     * Gets the prompts of the options carried out as a FORM step, the same ones the
+     * screens of display::screen ask.
+     */
+    vector<Prompt> formPrompts(int option) {
+        int rows = seatrs::data::totalRows, columns = seatrs::data::totalColumns;
+
+        switch (option) {
+            case 6: return {
+                {"Enter tier (A-Z, empty for any): ", 0, 0, -1, true, [](const string& value) {
+                    int tier;
+                    return value.empty() ? string() : components::parseTier(value, tier);
+                }},
+                {"Enter price (empty for any): ", 0, 0, -1, true, [](const string& value) {
+                    int price;
+                    return value.empty() ? string() : components::parsePrice(value, price);
+                }},
+                {"Enter features (a = aisle, w = wheelchair access, empty for none): ", 0, 0, -1, true, [](const string& value) {
+                    int features;
+                    return components::parseFeatures(value, features);
+                }}
+            };
+            case 7: return {
+                {"Enter first row: ", 1, rows},
+                {"Enter last row: ", 1, rows, 0},
+                {"Enter party size (1-" + to_string(waitlists::maxPartySize) + "): ", 1, waitlists::maxPartySize},
+                {"Enter priority (1-9, higher is seated first): ", 1, 9},
+                {"Enter Name: ", 0, 0, -1, true},
+                {"Enter Description: ", 0, 0, -1, true, [](const string&) { return string(); }}
+            };
+            case 8: return {
+                {"Enter Row number: ", 1, rows},
+                {"Enter Column number: ", 1, columns},
+                {"Enter number of seats (1-20): ", 1, 20},
+                {"Enter row weight (1-9): ", 1, 9},
+                {"Enter seat weight (1-9): ", 1, 9},
+                {"Choose the distance: ", 1, 2}
+            };
+            case 9: return {
+                {"Enter first row: ", 1, rows},
+                {"Enter last row: ", 1, rows, 0},
+                {"Enter first column: ", 1, columns},
+                {"Enter last column: ", 1, columns, 2}
+            };
+        }
+        return {};
+    }
+
+    const string formInstructions[] = {
+        "Enter the attributes the available seats must have.",
+        "Enter the rows the party can sit in, its size, and its priority.",
+        "Enter the preferred seat, how many seats to find, and how much rows count against seats.",
+        "Enter the rows and columns of the area."
+    };
+
+    /**
+     * Moves a session to its post screen, shown after an operation is carried out.
+     *
+     * @param session The session to update.
+     * @param titleText The title of the post screen.
+     * @param bodyText Any details to show above the options.
+     */
+    void post(Session& session, const string& titleText, const string& bodyText = "") {
+        session.step = POST;
+        session.postTitle = titleText;
+        session.postBody = bodyText + string(postOptions[session.option](program::config::lengthHUD));
+    }
 
-            cout << components::buildHUD() 
-                << (format::formatText(params.titleText, titleFormat)) << endl
-                << (result.error ? format::formatText("## " + result.errorMessage + " ##", titleFormat) + '\n' : "")
-                << (params.bodyText.empty() ? "" : params.bodyText + '\n')
-                << components::buildHeader('-');
+    /**
+     * Moves a session to the post screen of an operation carried out by the helpers
+     * shared with the screens.
+     */
+    void post(Session& session, const components::Outcome& outcome) {
+        post(session, outcome.titleText, outcome.bodyText);
+        session.errorMessage = outcome.errorMessage;
+    }
 
-            if (!params.prevInputText.empty()) {
-                cout << params.prevInputText;
+    /**
+     * Carries out the option of a FORM step once every prompt is answered.
+     */
+    void finishForm(Session& session) {
+        const vector<string>& answers = session.answers;
+        auto number = [&](size_t index) { return stoi(answers[index]); };
+
+        switch (session.option) {
+            case 6: {
+                seatrs::SeatQuery query;
+                if (!answers[0].empty()) components::parseTier(answers[0], query.tier);
+                if (!answers[1].empty()) components::parsePrice(answers[1], query.maxPrice);
+                components::parseFeatures(answers[2], query.features);
+                post(session, components::findSeatsOutcome(query));
+                break;
+            }
+            case 7:
+                post(session, components::joinWaitlistOutcome(number(0) - 1, number(1) - 1, number(2), number(3), answers[4], answers[5]));
+                break;
+            case 8: {
+                seatrs::NearestParams params;
+                params.row = number(0) - 1;
+                params.column = number(1) - 1;
+                params.count = number(2);
+                params.rowWeight = number(3);
+                params.columnWeight = number(4);
+                params.metric = (seatrs::Metric) number(5);
+                post(session, components::nearestSeatsOutcome(params));
+                break;
             }
+            case 9:
+                post(session, components::countFreeOutcome(number(0) - 1, number(1) - 1, number(2) - 1, number(3) - 1));
+                break;
+        }
+    }
 
-            bool empty = input::getInput(params.inputPrompt, result.value);
+    /**
+     * Builds the screen a session is currently waiting on, including its input prompt.
+     *
+     * @param session The session to draw.
+     *
+     * @returns A string representing the entire screen.
+     */
+    string draw(const Session& session) {
+        string returnText = string(components::generated<components::ReturnOptions>());
+        string rowInputText = format::formatAsInput("Enter Row number: ", to_string(session.row));
+
+        switch (session.step) {
+            case MENU:
+                return templates::buildScreen(
+                    "[Main Menu]\n"
+                    "Choose an option.",
+                    session.errorMessage,
+                    string(components::generated<components::SessionMenuOptions>())
+                ) + " >> Enter your choice: ";
+            case ROW:
+                return templates::buildScreen(
+                    optionTitles[session.option] + "\nEnter the row and column of the seat.",
+                    session.errorMessage, returnText
+                ) + " >> Enter Row number: ";
+            case COLUMN:
+                return templates::buildScreen(
+                    optionTitles[session.option] + "\nEnter the row and column of the seat.",
+                    session.errorMessage, returnText, rowInputText
+                ) + " >> Enter Column number: ";
+            case NAME:
+                return templates::buildScreen(
+                    optionTitles[session.option] + "\nEnter the Name and Description for the " + (session.option == 11 ? "hold." : "reservation."),
+                    session.errorMessage, returnText
+                ) + " >> Enter Name: ";
+            case DESCRIPTION:
+                return templates::buildScreen(
+                    optionTitles[session.option] + "\nEnter the Name and Description for the " + (session.option == 11 ? "hold." : "reservation."),
+                    session.errorMessage, returnText, format::formatAsInput("Enter Name: ", session.name)
+                ) + " >> Enter Description: ";
+            case FORM: {
+                vector<Prompt> prompts = formPrompts(session.option);
+                string instructions = formInstructions[session.option - 6];
+                string bodyText = returnText;
+
+                // the Name and Description of a party are asked on a screen of their own
+                size_t firstShown = 0;
+                if (session.option == 7 && session.answers.size() >= 4) {
+                    instructions = "Enter the Name and Description for the party.";
+                    firstShown = 4;
+                } else if (session.option == 7) {
+                    bodyText = components::buildWaitlistSummary() + "\n" + returnText;
+                } else if (session.option == 8 && session.answers.size() == prompts.size() - 1) {
+                    bodyText = string(components::generated<components::MetricOptions>());
+                }
 
-            for (auto &invokerValue : params.abortInvokers) {
-                if (result.error = result.value == invokerValue) {
-                    break;
+                string inputText;
+                for (size_t i = firstShown; i < session.answers.size(); i++) {
+                    inputText += format::formatAsInput(prompts[i].text, session.answers[i]);
                 }
-            }
 
-            if (result.error = ((!result.error) && empty && (!params.errorMessageEmpty.empty()))) {
-                result.errorMessage = params.errorMessageEmpty;
-                return handleInput(params, result);
+                return templates::buildScreen(
+                    optionTitles[session.option] + "\n" + instructions,
+                    session.errorMessage, bodyText, inputText
+                ) + " >> " + prompts[session.answers.size()].text;
             }
+            case POST:
+                return templates::buildScreen(session.postTitle, session.errorMessage, session.postBody) + " >> Enter input: ";
+        }
+        return "";
+    }
 
-            result.inputText = 
-                params.prevInputText.empty()
-                    ? format::formatAsInput(params.inputPrompt, result.value)
-                    : params.prevInputText + "\n" + format::formatAsInput(params.inputPrompt, result.value);
-
-            return result;
+    /**
+     * Resumes a session's flow with the next line entered by its operator, carrying
+     * out the chosen operation once all of its inputs have been entered. The
+     * operations themselves are the ones the screens carry out, from display::components.
+     *
+     * A kiosk may tag every line as "@@<request id> <line>". A line sent again with
+     * the ID of the last one is ignored, and the ID goes with the operation it
+     * completes, so a command is not carried out twice even from a new session.
+     *
+     * @param session The session to resume.
+     * @param taggedLine The line entered by the operator.
+     */
+    void resume(Session& session, const string& taggedLine) {
+        string requestId, line = taggedLine;
+        if (line.compare(0, 2, "@@") == 0) {
+            size_t space = line.find(' ');
+            requestId = line.substr(2, (space == string::npos ? line.size() : space) - 2);
+            line = (space == string::npos) ? "" : line.substr(space + 1);
+            if (!requestId.empty() && requestId == session.lastRequestId) return;
+            session.lastRequestId = requestId;
         }
 
-        struct PostScreenParams {
-            string titleText;
-            string bodyText;
-            string errorMessage;
-            string prompt = "Enter input: ";
-            vector<string> abortInvokers = {"0"};
-        };
+        int value = 0;
+        bool invalid = input::parseInt(line, value);
+        int irow = session.row - 1;
+        int icol = session.column - 1;
+
+        session.errorMessage.clear();
+
+        switch (session.step) {
+            case MENU: {
+                if (invalid) {
+                    session.errorMessage = "Invalid input! Please enter an integer.";
+                } else if (value < 0 || value > 11 || value == 10) {
+                    session.errorMessage = "Invalid input! Please enter a valid option.";
+                } else if (value == 0) {
+                    session.closed = true;
+                } else if (value == 1) {
+                    session.option = value;
+                    string layout = components::buildSeatLayout();
+                    if (layout.empty()) {
+                        post(session, optionTitles[1]);
+                        session.errorMessage = "The columns of the seat layout exceeds the HUD length!";
+                    } else {
+                        post(session, optionTitles[1] + "\nNot Occupied O | X Occupied", layout + "\n\n");
+                    }
+                } else {
+                    session.option = value;
+                    session.answers.clear();
+                    session.step = (value >= 6 && value <= 9) ? FORM : ROW;
+                }
+                break;
+            }
+            case ROW: {
+                if (invalid) {
+                    session.errorMessage = "Invalid input! Please enter an integer.";
+                } else if (value == 0) {
+                    session.step = MENU;
+                } else if (value < 1 || value > seatrs::data::totalRows) {
+                    session.errorMessage = "Invalid input! Number of row must be between 1 and " + to_string(seatrs::data::totalRows) + ".";
+                } else {
+                    session.row = value;
+                    session.step = COLUMN;
+                }
+                break;
+            }
+            case COLUMN: {
+                if (invalid) {
+                    session.errorMessage = "Invalid input! Please enter an integer.";
+                    break;
+                } else if (value == 0) {
+                    session.step = ROW;
+                    break;
+                } else if (value < 1 || value > seatrs::data::totalColumns) {
+                    session.errorMessage = "Invalid input! Number of column must be between 1 and " + to_string(seatrs::data::totalColumns) + ".";
+                    break;
+                }
 
-        /**
-         * Displays a formatted screen with instructions and error messages, and 
-         * prompts the user for input.
-         *
-         * @param params A structure containing parameters for input handling.
-         *
-         * @returns An integer indicating the status of the function.
-         *          SUCCESS if the user entered a valid input.
-         *          RETURN if the user chose to abort.
-         */
-        int postScreen(const PostScreenParams params) {
-            // clear screen
-            screen::clear();
-            string value;
+                session.column = value;
+                icol = value - 1;
 
-            format::FormatParams titleFormat;
-            titleFormat.align = format::CENTER;
-            titleFormat.padding = 2;
+                if (session.option == 3) {
+                    post(session, components::readOutcome(irow, icol));
+                    break;
+                }
 
-            cout << components::buildHUD() 
-                << (format::formatText(params.titleText, titleFormat)) << endl
-                << (params.errorMessage.empty() ? "" : format::formatText("## " + 
-                    params.errorMessage + " ##", titleFormat) + '\n')
-                << (params.bodyText.empty() ? "" : params.bodyText + '\n')
-                << components::buildHeader('-');
+                bool taking = session.option == 2 || session.option == 11;
+                seatrs::Result state = components::checkSeat(irow, icol, !taking, session.option == 11);
 
-            input::getInput(params.prompt, value);
+                // A tagged create, hold or delete may be a repeat of one already carried
+                // out, which only the operation with its request ID can tell
+                bool repeatable = (taking && state == seatrs::ALREADY_RESERVED) || (session.option == 5 && state == seatrs::NOT_RESERVED);
+                if (!requestId.empty() && repeatable) {
+                    state = seatrs::OK;
+                }
 
-            for (auto &invokerValue : params.abortInvokers) {
-                if (value == invokerValue) {
-                    return screen::Status::RETURN;
+                if (state != seatrs::OK) {
+                    post(session, optionTitles[session.option]);
+                    session.errorMessage = components::buildResultMessage(state, irow, icol);
+                } else if (session.option == 5) {
+                    post(session, components::deleteOutcome(irow, icol, requestId));
+                } else {
+                    session.step = NAME;
                 }
+                break;
             }
+            case NAME: {
+                if (line.empty()) {
+                    session.errorMessage = "Invalid input! Please enter a non-emtpy string.";
+                } else {
+                    session.name = line;
+                    session.step = DESCRIPTION;
+                }
+                break;
+            }
+            case DESCRIPTION: {
+                if (session.option == 2) {
+                    post(session, components::createOutcome(irow, icol, session.name, line, requestId));
+                } else if (session.option == 11) {
+                    post(session, components::holdOutcome(irow, icol, session.name, line, requestId));
+                } else {
+                    post(session, components::updateOutcome(irow, icol, session.name, line, requestId));
+                }
+                break;
+            }
+            case FORM: {
+                vector<Prompt> prompts = formPrompts(session.option);
+                const Prompt& prompt = prompts[session.answers.size()];
+
+                if (prompt.isText) {
+                    string errorMessage = prompt.check ? prompt.check(line) : (line.empty() ? "Invalid input! Please enter a non-emtpy string." : "");
+                    if (line == "0" && session.option == 6) {
+                        session.step = MENU;
+                        break;
+                    } else if (!errorMessage.empty()) {
+                        session.errorMessage = errorMessage;
+                        break;
+                    }
+                } else {
+                    int minValue = (prompt.minAnswer >= 0) ? stoi(session.answers[prompt.minAnswer]) : prompt.minValue;
+                    if (invalid) {
+                        session.errorMessage = "Invalid input! Please enter an integer.";
+                        break;
+                    } else if (value == 0) {
+                        session.step = MENU;
+                        break;
+                    } else if (value < minValue || value > prompt.maxValue) {
+                        session.errorMessage = "Invalid input! Please enter a number from " + to_string(minValue) + " to " + to_string(prompt.maxValue) + ".";
+                        break;
+                    }
+                    line = to_string(value);
+                }
 
-            return screen::Status::SUCCESS;
+                session.answers.push_back(line);
+                if (session.answers.size() == prompts.size()) {
+                    finishForm(session);
+                }
+                break;
+            }
+            case POST: {
+                if (line == "0" && session.option != 1) {
+                    session.answers.clear();
+                    session.step = (session.option >= 6 && session.option <= 9) ? FORM : ROW;
+                } else {
+                    session.step = MENU;
+                }
+                break;
+            }
         }
+    }
 
-        struct RowColumnParams {
-            string titleText;
-            string bodyText;
-            string inputPromptRow = "Enter Row number: ";
-            string inputPromptColumn = "Enter Column number: ";
-            string errorMessageInvalidType = "Invalid input! Please enter an integer.";
-            string errorMessageRowOutOfRange = "Invalid input! Number of row must be between 1 and " + to_string(seatrs::data::totalRows) + ".";
-            string errorMessageColumnOutOfRange = "Invalid input! Number of column must be between 1 and " + to_string(seatrs::data::totalColumns) + ".";
-            int maxInputValueRow = seatrs::data::totalRows;
-            int maxInputValueColumn = seatrs::data::totalColumns;
-        };
-
-        struct RowColumn {
-            int row;
-            int column;
-            bool error = false;
-        } defaultRowColumn;
+    /**
+     * Queues the screen a session is waiting on for output, or leaves it out while
+     * the output is backed up. Frames are only built when they are queued, so the
+     * next one is still drawn against what the client was last sent.
+     *
+     * @param session The session to refresh.
+     */
+    void refresh(Session& session) {
+        if (session.pendingOutput.size() >= maxPendingOutput) {
+            session.frameSkipped = true;
+            return;
+        }
+        int height = screen::terminalHeight(session.outputFd), width = screen::terminalWidth(session.outputFd);
+        session.pendingOutput += screen::buildFrameUpdate(session.frame, draw(session), height, width);
+        session.frameSkipped = false;
+    }
 
+    /**
+     * Serves several operator sessions at once from a single thread. Each endpoint is
+     * either one path used for both input and output (such as a pty), or an 
+     * "input:output" pair of paths (such as two named pipes). The scheduler waits on
+     * all inputs at once and resumes whichever sessions received a full line, so no
+     * session ever blocks another.
+     *
+     * @param endpoints The input/output paths of each session.
+     *
+     * @returns The exit code of the program.
+     */
+    int serve(const vector<string>& endpoints) {
+        #ifdef UNIX_LIKE
+            vector<Session> sessions(endpoints.size());
+
+            for (size_t i = 0; i < endpoints.size(); i++) {
+                size_t colon = endpoints[i].find(':');
+                string inputPath = endpoints[i].substr(0, colon);
+                string outputPath = (colon == string::npos) ? inputPath : endpoints[i].substr(colon + 1);
+
+                // opened for both reading and writing so a named pipe never reports end of file
+                sessions[i].inputFd = open(inputPath.c_str(), O_RDWR | O_NONBLOCK | O_NOCTTY);
+                sessions[i].outputFd = 
+                    (outputPath == inputPath)
+                        ? sessions[i].inputFd
+                        : open(outputPath.c_str(), O_RDWR | O_NONBLOCK | O_NOCTTY);
+
+                if (sessions[i].inputFd < 0 || sessions[i].outputFd < 0) {
+                    cerr << "Unable to open session endpoint: " << endpoints[i] << endl;
+                    return 1;
+                }
 
-        /**
-         * Prompts the user to enter row and column numbers, and returns their values 
-         * in a RowColumn structure.
-         *
-         * @param params A structure containing parameters for input handling.
-         *
-         * @returns A RowColumn structure, with the "error" field set to true if the 
-         * user entered invalid data or aborted , and the "row" and "column" fields 
-         * set to the entered values if the input was valid.
-         */
-        RowColumn getRowColumn(const RowColumnParams params, RowColumn result = defaultRowColumn) {
-            templates::HandleIntInputParams sharedParams, paramsRow, paramsColumn;
-            
-            sharedParams.titleText = params.titleText;
-            sharedParams.bodyText = params.bodyText;
-            sharedParams.errorMessageInvalidType = params.errorMessageInvalidType;
-            sharedParams.minValue = 1;
-            
-            paramsRow = paramsColumn = sharedParams;
+                refresh(sessions[i]);
+            }
 
-            paramsRow.errorMessageOutOfRange = params.errorMessageRowOutOfRange;
-            paramsRow.inputPrompt = params.inputPromptRow;
-            paramsRow.maxValue = params.maxInputValueRow;
+            size_t openSessions = sessions.size();
+            char buffer[4096];
 
-            paramsColumn.errorMessageOutOfRange = params.errorMessageColumnOutOfRange;
-            paramsColumn.inputPrompt = params.inputPromptColumn;
-            paramsColumn.maxValue = params.maxInputValueColumn;
+            while (openSessions > 0) {
+                vector<pollfd> polls;
+                vector<size_t> owners;
 
-            templates::HandleIntInput resultRow, resultColumn;
+                for (size_t i = 0; i < sessions.size(); i++) {
+                    Session &session = sessions[i];
+                    if (session.closed) continue;
 
-            do {
-                resultRow = templates::handleInput(paramsRow);
+                    if (session.outputFd == session.inputFd) {
+                        polls.push_back({session.inputFd, (short) (POLLIN | (session.pendingOutput.empty() ? 0 : POLLOUT)), 0});
+                        owners.push_back(i);
+                    } else {
+                        polls.push_back({session.inputFd, POLLIN, 0});
+                        owners.push_back(i);
+                        if (!session.pendingOutput.empty()) {
+                            polls.push_back({session.outputFd, POLLOUT, 0});
+                            owners.push_back(i);
+                        }
+                    }
+                }
 
-                if (result.error = resultRow.error) {
+                if (poll(polls.data(), polls.size(), -1) < 0) {
+                    if (errno == EINTR) continue;
                     break;
                 }
-                
-                paramsColumn.prevInputText = resultRow.inputText;
-                
-                resultColumn = templates::handleInput(paramsColumn);
 
-                result.error = resultColumn.error;
+                for (size_t p = 0; p < polls.size(); p++) {
+                    Session &session = sessions[owners[p]];
+                    if (session.closed) continue;
+
+                    if ((polls[p].revents & (POLLIN | POLLHUP | POLLERR)) && polls[p].fd == session.inputFd) {
+                        ssize_t count = read(session.inputFd, buffer, sizeof(buffer));
+
+                        if (count > 0) {
+                            session.pendingInput.append(buffer, count);
+
+                            size_t end;
+                            while (!session.closed && (end = session.pendingInput.find('\n')) != string::npos) {
+                                string line = session.pendingInput.substr(0, end);
+                                session.pendingInput.erase(0, end + 1);
+                                if (!line.empty() && line.back() == '\r') line.pop_back();
+                                resume(session, line);
+                            }
+
+                            if (!session.closed) {
+                                refresh(session);
+                            }
+                        } else if (count == 0 || (errno != EAGAIN && errno != EINTR)) {
+                            session.closed = true;
+                        }
+                    }
+
+                    if ((polls[p].revents & POLLOUT) || session.closed) {
+                        ssize_t count = session.pendingOutput.empty() ? 0 : write(session.outputFd, session.pendingOutput.data(), session.pendingOutput.size());
+                        if (count > 0) {
+                            session.pendingOutput.erase(0, count);
+                            if (session.frameSkipped && !session.closed) refresh(session);
+                        }
+                    }
+
+                    if (session.closed) {
+                        if (session.outputFd != session.inputFd) close(session.outputFd);
+                        close(session.inputFd);
+                        openSessions--;
+                    }
+                }
+            }
+
+            return 0;
+        #else
+            cerr << "Serving operator sessions requires a Unix-like system." << endl;
+            return 1;
+        #endif
+    }
+}
+
+namespace workload {
+    using namespace utils;
 
-            } while (result.error);
+    enum Operation {
+        RESERVE = 0,
+        CANCEL,
+        LOOKUP,
+        LAYOUT
+    };
 
-            if (!result.error) {
-                result.row = resultRow.value;
-                result.column = resultColumn.value;
-            }
+    struct WorkloadParams {
+        int weights[4] = {50, 20, 25, 5};   // relative share of each Operation
+        double hotspot = 0;                 // share of seat operations aimed at the hot rows
+        int hotRows = 1;                    // the front rows that are contended
+        double arrivalRate = 0;             // operations per second for an open loop, 0 for a closed loop
+        int concurrency = 1;                // operations in flight at once in a closed loop
+        int shards = 0;                     // 0 to drive the core in this process, otherwise the local shards
+        int operations = 100000;
+        int rows = 20, columns = 30;
+        unsigned seed = 12345;
+    };
 
-            return result;
+    struct WorkloadReport {
+        long long counts[4] = {};
+        long long reserveConflicts = 0;     // reservations of seats that were already reserved
+        long long cancelConflicts = 0;      // cancellations of seats that were not reserved
+        double seconds = 0;
+        vector<int64_t> latencies;          // nanoseconds, from each operation's arrival to its completion
+        bool error = false;
+        string errorMessage;
+    };
+
+    /**
+     * Picks the operations and seats of a workload, aiming the hot share of the seat
+     * operations at the front rows.
+     */
+    struct Generator {
+        mt19937 random;
+        discrete_distribution<int> operations;
+        const WorkloadParams& params;
+
+        Generator(const WorkloadParams& params) : 
+            random(params.seed), 
+            operations(params.weights, params.weights + 4), 
+            params(params) {}
+
+        seatrs::Change next(Operation& operation) {
+            operation = (Operation) operations(random);
+
+            seatrs::Change change;
+            change.kind = (operation == RESERVE) ? seatrs::RESERVE : seatrs::CANCEL;
+            bool hot = uniform_real_distribution<double>(0, 1)(random) < params.hotspot;
+            change.row = random() % (hot ? min(params.hotRows, params.rows) : params.rows);
+            change.column = random() % params.columns;
+            change.name = "Load";
+            return change;
         }
+    };
 
-        struct NameDescriptionParams {
-            string titleText;
-            string bodyText;
-            string inputPromptName = "Enter Name: ";
-            string inputPromptDescription = "Enter Description: ";
-            string errorMessageEmptyName = "Invalid input! Please enter a non-emtpy string.";
-            string errorMessageEmptyDescription;
-        };
+    /**
+     * Counts the result of a finished operation in a report.
+     */
+    void countResult(WorkloadReport& report, Operation operation, int result) {
+        report.counts[operation]++;
+        if (operation == RESERVE && result == seatrs::ALREADY_RESERVED) report.reserveConflicts++;
+        if (operation == CANCEL && result == seatrs::NOT_RESERVED) report.cancelConflicts++;
+    }
 
-        struct NameDescription {
-            string name;
-            string description;
-            bool error = false;
-        } defaultNameDescription;
+    /**
+     * Waits until the arrival time of the next operation of an open loop, sleeping
+     * when it is far away and spinning when it is close.
+     */
+    void waitUntil(chrono::steady_clock::time_point arrival) {
+        auto remaining = arrival - chrono::steady_clock::now();
+        if (remaining > chrono::milliseconds(1)) {
+            this_thread::sleep_for(remaining - chrono::microseconds(500));
+        }
+        while (chrono::steady_clock::now() < arrival) {}
+    }
 
-        /**
-         * Get the name and description from user input.
-         *
-         * @param params The parameters for the function.
-         *
-         * @param result The result of the function. If the result.error is true, the user aborted.
-         * Otherwise, the result.name and result.description contain the name and description entered by the
-         * user.
-         *
-         * @return The result of the function.
-         */
-        NameDescription getNameDescription(const NameDescriptionParams params, NameDescription result = defaultNameDescription) {
-            templates::HandleStringInputParams sharedParams, paramsName, paramsDescription;
+    /**
+     * Drives the reservation core of this process directly, one operation at a time.
+     * In an open loop each latency is measured from the operation's scheduled arrival,
+     * so time spent queued behind a slow operation is counted.
+     */
+    void runInProcess(const WorkloadParams& params, WorkloadReport& report) {
+        Generator generator(params);
+        chrono::duration<double> interval(params.arrivalRate > 0 ? 1.0 / params.arrivalRate : 0);
+
+        auto started = chrono::steady_clock::now();
+        for (int i = 0; i < params.operations; i++) {
+            Operation operation;
+            seatrs::Change change = generator.next(operation);
+
+            auto arrival = chrono::steady_clock::now();
+            if (params.arrivalRate > 0) {
+                arrival = started + chrono::duration_cast<chrono::steady_clock::duration>(interval * i);
+                waitUntil(arrival);
+            }
 
-            sharedParams.titleText = params.titleText;
-            sharedParams.bodyText = params.bodyText;
+            int result = seatrs::OK;
+            switch (operation) {
+                case RESERVE: result = seatrs::reserveSeat(change.row, change.column, change.name, change.description); break;
+                case CANCEL: result = seatrs::cancelSeat(change.row, change.column); break;
+                case LOOKUP: {
+                    const seatrs::Seat& seat = seatrs::data::seats[change.row][change.column];
+                    result = seat.isReserved ? seatrs::OK : seatrs::NOT_RESERVED;
+                    break;
+                }
+                case LAYOUT: {
+                    string layout = display::components::buildSeatLayout();
+                    result = layout.empty() ? seatrs::INVALID_SEAT : seatrs::OK;
+                    break;
+                }
+            }
 
-            paramsName = paramsDescription = sharedParams;
+            report.latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - arrival).count());
+            countResult(report, operation, result);
+        }
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    }
 
-            paramsName.inputPrompt = params.inputPromptName;
-            paramsName.errorMessageEmpty = params.errorMessageEmptyName;
+    /**
+     * Drives the local shards through a router. A closed loop keeps up to the
+     * concurrency of operations in flight and sends them together; an open loop sends
+     * whatever has arrived by the time the previous round finished. Layout operations
+     * gather the occupancy of every shard once the operations sent with them finish.
+     */
+    void runAgainstShards(const WorkloadParams& params, WorkloadReport& report) {
+        seatrs::resetLayout(params.rows, params.columns);
+
+        sharding::Router router;
+        string errorMessage = sharding::startShards(router, params.shards);
+        if (!errorMessage.empty()) {
+            sharding::stopShards(router);
+            report.error = true;
+            report.errorMessage = errorMessage;
+            return;
+        }
 
-            paramsDescription.inputPrompt = params.inputPromptDescription;
-            paramsDescription.errorMessageEmpty = params.errorMessageEmptyDescription;
+        Generator generator(params);
+        chrono::duration<double> interval(params.arrivalRate > 0 ? 1.0 / params.arrivalRate : 0);
 
-            templates::HandleStringInput resultName, resultDescription;
+        struct InFlight {
+            Operation operation;
+            chrono::steady_clock::time_point arrival;
+        };
+        vector<InFlight> inFlight;
 
-            do {
-                resultName = templates::handleInput(paramsName);
+        auto started = chrono::steady_clock::now();
+        int issued = 0;
+        while (issued < params.operations) {
+            uint64_t firstSequence = router.nextSequence + 1;
+            vector<chrono::steady_clock::time_point> layouts;
+            inFlight.clear();
 
-                if (result.error = resultName.error) {
+            if (params.arrivalRate > 0) {
+                waitUntil(started + chrono::duration_cast<chrono::steady_clock::duration>(interval * issued));
+            }
+
+            while (issued < params.operations) {
+                auto arrival = chrono::steady_clock::now();
+                if (params.arrivalRate > 0) {
+                    arrival = started + chrono::duration_cast<chrono::steady_clock::duration>(interval * issued);
+                    if (arrival > chrono::steady_clock::now()) break;
+                } else if ((int) (inFlight.size() + layouts.size()) >= params.concurrency) {
                     break;
                 }
 
-                paramsDescription.prevInputText = resultName.inputText;
-
-                resultDescription = templates::handleInput(paramsDescription);
+                Operation operation;
+                seatrs::Change change = generator.next(operation);
+                issued++;
 
-                result.error = resultDescription.error;
-            } while (result.error);
+                if (operation == LAYOUT) {
+                    layouts.push_back(arrival);
+                    continue;
+                }
+                if (operation == LOOKUP) {
+                    change.kind = (seatrs::ChangeKind) sharding::LOOKUP_REQUEST;
+                }
+                sharding::submit(router, change);
+                inFlight.push_back({operation, arrival});
+            }
 
-            if (!result.error) {
-                result.name = resultName.value;
-                result.description = resultDescription.value;
+            bool exchanged = sharding::exchange(router, [&](int, uint64_t sequence, int result, const string&) {
+                const InFlight& operation = inFlight[sequence - firstSequence];
+                report.latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - operation.arrival).count());
+                countResult(report, operation.operation, result);
+            });
+
+            for (auto arrival : layouts) {
+                vector<uint64_t> occupancy;
+                exchanged = exchanged && sharding::gatherOccupancy(router, occupancy) >= 0;
+                report.latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - arrival).count());
+                countResult(report, LAYOUT, seatrs::OK);
             }
 
-            return result;
+            if (!exchanged) {
+                report.error = true;
+                report.errorMessage = "A shard was lost.";
+                break;
+            }
         }
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+        sharding::stopShards(router);
     }
 
-    namespace screen {
-        using namespace utils;
+    /**
+     * Runs a workload against the reservation core, in this process or against the
+     * local shards.
+     *
+     * @param params The mix, distribution, and loop of the workload.
+     *
+     * @returns The counts, conflicts, and latencies of the operations.
+     */
+    WorkloadReport runWorkload(const WorkloadParams& params) {
+        WorkloadReport report;
+        report.latencies.reserve(params.operations);
+
+        if (params.shards > 0) {
+            runAgainstShards(params, report);
+        } else {
+            seatrs::resetLayout(params.rows, params.columns);
+            runInProcess(params, report);
+        }
 
-        int optionsSetHUDLength() {
-            templates::HandleIntInputParams setHUDLengthParams;
+        return report;
+    }
 
-            setHUDLengthParams.titleText =
-                "[Edit HUD Length]\n"
-                "Enter new HUD length.";
-            
-            setHUDLengthParams.bodyText = format::formatText(
-                "[0] Return to Main Menu\n", 
-                format::optionsFormat
-            );
+    /**
+     * Gets a latency percentile, in microseconds, of latencies sorted in ascending order.
+     */
+    double percentile(const vector<int64_t>& sorted, double fraction) {
+        if (sorted.empty()) return 0;
+        size_t index = min(sorted.size() - 1, (size_t) (fraction * sorted.size()));
+        return sorted[index] / 1000.0;
+    }
 
-            setHUDLengthParams.errorMessageOutOfRange = "Invalid input! Please enter an integer between " + to_string(program::control::minLengthHUD) + " and " + to_string(program::control::maxLengthHUD) + ".";
-            setHUDLengthParams.inputPrompt = "Enter new HUD length: ";
-            setHUDLengthParams.minValue = program::control::minLengthHUD;
-            setHUDLengthParams.maxValue = program::control::maxLengthHUD;
+    /**
+     * Builds the summary of a workload: throughput, operations of each kind, conflict
+     * rates, and latency percentiles.
+     */
+    string buildReport(WorkloadReport& report) {
+        sort(report.latencies.begin(), report.latencies.end());
+
+        long long total = report.counts[RESERVE] + report.counts[CANCEL] + report.counts[LOOKUP] + report.counts[LAYOUT];
+        long long writes = report.counts[RESERVE] + report.counts[CANCEL];
+
+        ostringstream text;
+        text.setf(ios::fixed);
+        text.precision(2);
+        text << "Operations: " << total << " in " << report.seconds << " s, " 
+            << (long long) (total / max(report.seconds, 1e-9)) << " operations/s\n"
+            << "Mix: " << report.counts[RESERVE] << " reserve, " << report.counts[CANCEL] << " cancel, "
+            << report.counts[LOOKUP] << " lookup, " << report.counts[LAYOUT] << " layout\n"
+            << "Conflicts: " << (report.reserveConflicts + report.cancelConflicts) << " ("
+            << (writes ? 100.0 * (report.reserveConflicts + report.cancelConflicts) / writes : 0) << "% of writes), "
+            << report.reserveConflicts << " reserve, " << report.cancelConflicts << " cancel\n"
+            << "Latency (us): p50 " << percentile(report.latencies, 0.50)
+            << ", p90 " << percentile(report.latencies, 0.90)
+            << ", p99 " << percentile(report.latencies, 0.99)
+            << ", p99.9 " << percentile(report.latencies, 0.999)
+            << ", max " << percentile(report.latencies, 1.0) << '\n';
+        return text.str();
+    }
 
-            templates::HandleIntInput result = templates::handleInput(setHUDLengthParams);
+    /**
+     * Measures the throughput of a writer reserving and cancelling random seats, with
+     * versions off, with versions on, and with versions on while reader threads
+     * continuously pin versions to render the whole map and export it to /dev/null.
+     * Every render checks that its occupied count matches the version's.
+     *
+     * @param readers The number of reader threads for the last run.
+     * @param seconds How long each run lasts.
+     * @param rows The number of rows of the layout.
+     * @param columns The number of columns of the layout.
+     *
+     * @returns The exit code of the program.
+     */
+    int benchSnapshots(int readers, double seconds, int rows, int columns) {
+        cout << format::formatText("Versions", {format::LEFT, 10})
+            << format::formatText("Readers", {format::RIGHT, 8})
+            << format::formatText("Writes/s", {format::RIGHT, 12})
+            << format::formatText("Scans/s", {format::RIGHT, 10})
+            << format::formatText("Exports", {format::RIGHT, 9})
+            << format::formatText("Torn", {format::RIGHT, 6})
+            << format::formatText("Kept", {format::RIGHT, 6}) << endl;
+
+        struct Run { bool versioned; int readers; };
+        for (Run run : {Run{false, 0}, Run{true, 0}, Run{true, readers}}) {
+            seatrs::resetLayout(rows, columns);
+            if (run.versioned) versions::enable();
+            versions::data::mostRetained = 0;
+
+            atomic<bool> stopping{false};
+            atomic<long long> scans{0}, exports{0}, torn{0};
+            vector<thread> threads;
+
+            for (int ireader = 0; ireader < run.readers; ireader++) {
+                threads.emplace_back([&] {
+                    string grid;
+                    while (!stopping) {
+                        versions::Pin pinned = versions::pin();
+                        const versions::Version* version = pinned.version;
+
+                        grid.clear();
+                        int counted = 0;
+                        for (int irow = 0; irow < version->totalRows; irow++) {
+                            for (int icol = 0; icol < version->totalColumns; icol++) {
+                                bool reserved = version->isReserved(irow, icol);
+                                grid += reserved ? 'X' : 'O';
+                                counted += reserved;
+                            }
+                            grid += '\n';
+                        }
+                        if (counted != version->occupiedSeats) torn++;
+                        versions::unpin(pinned);
 
-            if (result.error) {
-                return RETURN;
+                        if (++scans % 8 == 0) {
+                            transfer::exportReservations("/dev/null", transfer::CSV, 1, INT_MAX);
+                            exports++;
+                        }
+                    }
+                });
             }
 
-            program::config::lengthHUD = result.value;
-
-            return SUCCESS;
+            mt19937 random(12345);
+            long long writes = 0;
+            auto started = chrono::steady_clock::now();
+            auto deadline = started + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+            while (chrono::steady_clock::now() < deadline) {
+                for (int i = 0; i < 256; i++) {
+                    int irow = random() % rows, icol = random() % columns;
+                    if (seatrs::reserveSeat(irow, icol, "Reader Test", "") != seatrs::OK) {
+                        seatrs::cancelSeat(irow, icol);
+                    }
+                }
+                writes += 256;
+            }
+            double elapsed = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+            stopping = true;
+            for (thread& reader : threads) reader.join();
+            versions::disable();
+
+            cout << format::formatText(run.versioned ? "on" : "off", {format::LEFT, 10})
+                << format::formatText(to_string(run.readers), {format::RIGHT, 8})
+                << format::formatText(to_string((long long) (writes / elapsed)), {format::RIGHT, 12})
+                << format::formatText(to_string((long long) (scans / elapsed)), {format::RIGHT, 10})
+                << format::formatText(to_string(exports.load()), {format::RIGHT, 9})
+                << format::formatText(to_string(torn.load()), {format::RIGHT, 6})
+                << format::formatText(to_string(versions::data::mostRetained), {format::RIGHT, 6}) << endl;
         }
 
-        int optionsSetDimensions() {
-            templates::RowColumnParams rowColumnParams;
+        return 0;
+    }
 
-            rowColumnParams.titleText = 
-                "[Edit Seat Layout Dimensions]\n" 
-                "Enter new dimensions.";
-            
-            rowColumnParams.errorMessageRowOutOfRange = "Invalid input! Number of row must be between 1 and " + to_string(program::control::maxPossibleRows) + ".";
-            rowColumnParams.errorMessageColumnOutOfRange = "Invalid input! Number of column must be between 1 and " + to_string(program::control::maxPossibleColumns) + ".";
+    /**
+     * Measures the batch allocator on a venue that is partly sold in small blocks.
+     * Each time budget starts from the same venue and the same parties, of 2 to 12
+     * seats with a fifth of them wanting a range of 10 rows, so the runs show what
+     * the extra plans buy over the first greedy plan.
+     *
+     * @param rows The number of rows of the layout.
+     * @param columns The number of columns of the layout.
+     * @param parties The number of parties.
+     * @param sold The share of seats sold before the batch.
+     *
+     * @returns The exit code of the program.
+     */
+    int benchAllocation(int rows, int columns, int parties, double sold) {
+        cout << format::formatText("Budget", {format::LEFT, 10})
+            << format::formatText("Plans", {format::RIGHT, 8})
+            << format::formatText("Placed", {format::RIGHT, 8})
+            << format::formatText("Left", {format::RIGHT, 6})
+            << format::formatText("Singles", {format::RIGHT, 9})
+            << format::formatText("Before", {format::RIGHT, 8})
+            << format::formatText("Time", {format::RIGHT, 10}) << endl;
+
+        for (double budget : {0.0, 0.05, 0.5}) {
+            mt19937 random(777);
+            seatrs::resetLayout(rows, columns);
+
+            // Sell blocks of 1 to 6 seats at random until the share is sold
+            while (seatrs::data::totalOccupiedSeats < sold * rows * columns) {
+                int irow = random() % rows, icol = random() % columns, length = 1 + random() % 6;
+                for (int i = icol; i < min(columns, icol + length); i++) seatrs::reserveSeat(irow, i, "Sold", "");
+            }
 
-            rowColumnParams.inputPromptRow = "Enter the number of rows: ";
-            rowColumnParams.inputPromptColumn = "Enter the number of columns: ";
+            allocation::AllocationParams params;
+            params.timeBudget = budget;
+            params.requireAll = false;
+            for (int iparty = 0; iparty < parties; iparty++) {
+                allocation::PartyRequest party;
+                party.name = "Party " + to_string(iparty + 1);
+                party.size = 2 + random() % 11;
+                if (random() % 5 == 0) {
+                    party.firstRow = random() % max(1, rows - 10);
+                    party.lastRow = min(rows - 1, party.firstRow + 9);
+                }
+                params.parties.push_back(party);
+            }
 
-            rowColumnParams.maxInputValueRow = program::control::maxPossibleRows;
-            rowColumnParams.maxInputValueColumn = program::control::maxPossibleColumns;
+            allocation::AllocationReport report = allocation::allocateParties(params);
 
-            templates::RowColumn result = getRowColumn(rowColumnParams);
+            ostringstream time;
+            time.setf(ios::fixed);
+            time.precision(1);
+            time << report.seconds * 1000 << " ms";
 
-            if (result.error) {
-                return RETURN;
-            } 
-            
-            seatrs::setSize(result.row, result.column);
-            return SUCCESS;
+            cout << format::formatText(to_string((int) (budget * 1000)) + " ms", {format::LEFT, 10})
+                << format::formatText(to_string(report.attempts), {format::RIGHT, 8})
+                << format::formatText(to_string(report.placed), {format::RIGHT, 8})
+                << format::formatText(to_string(report.unplaced), {format::RIGHT, 6})
+                << format::formatText(to_string(report.singleGapsAfter), {format::RIGHT, 9})
+                << format::formatText(to_string(report.singleGapsBefore), {format::RIGHT, 8})
+                << format::formatText(time.str(), {format::RIGHT, 10}) << endl;
         }
 
-        int optionsMenu() {
-            int status;
-            templates::HandleIntInputParams choiceParams;
-
-            choiceParams.titleText = 
-                "[Settings]\n" 
-                "Choose an option.";
-            
-            choiceParams.bodyText = format::formatText(
-                "[1] Exit\n"
-                "[2] Edit Seat Layout Dimensions\n"
-                "[3] Edit HUD Length\n"
-                "[0] Return to Main Menu\n", 
-                format::optionsFormat
-            );
-            choiceParams.minValue = 0;
-            choiceParams.maxValue = 3;
+        return 0;
+    }
 
-            do {
-                templates::HandleIntInput result = templates::handleInput(choiceParams);
+    /**
+     * Measures a shared seat map under 1, 2, 4, ... processes at once, each reserving
+     * and cancelling random seats. Every process maps the segment again by its name,
+     * so at a different address, and at the end the occupied count kept in the header
+     * is checked against the bits of the occupancy words. Last, a process dies holding
+     * a row lock, to check that the next process takes the lock over.
+     *
+     * @param maxProcesses The largest number of processes to try.
+     * @param rows The number of rows of the layout.
+     * @param columns The number of columns of the layout.
+     * @param operations The number of operations of each process.
+     *
+     * @returns The exit code of the program.
+     */
+    int benchShared(int maxProcesses, int rows, int columns, int operations) {
+        #ifdef UNIX_LIKE
+            string name = "/seatrs-bench-" + to_string(getpid());
+
+            cout << "processes  operations/s  conflicts  occupied  consistent" << endl;
+
+            for (int count = 1; count <= maxProcesses; count *= 2) {
+                bool created = false;
+                string errorMessage;
+                shared::Header* header = shared::mapSegment(name, rows, columns, created, errorMessage);
+                if (header == nullptr) {
+                    cerr << errorMessage << endl;
+                    return 1;
+                }
 
-                switch (result.value) {
-                    case 1: {
-                        status = FINISH;
-                        break;
-                    }
-                    case 2: {
-                        status = optionsSetDimensions();
-                        break;
-                    }
-                    case 3: {
-                        status = optionsSetHUDLength();
-                        break;
-                    }
-                    case 0: {
-                        status = SUCCESS;
-                        break;
+                // each process reports its conflicts through a pipe
+                int fds[2];
+                if (pipe(fds) != 0) {
+                    shared::unmapSegment(header, name, true);
+                    cerr << "Unable to create a pipe." << endl;
+                    return 1;
+                }
+                cout.flush();
+
+                auto started = chrono::steady_clock::now();
+                for (int iprocess = 0; iprocess < count; iprocess++) {
+                    if (fork() == 0) {
+                        close(fds[0]);
+                        bool childCreated = false;
+                        string childError;
+                        shared::Header* mapped = shared::mapSegment(name, rows, columns, childCreated, childError);
+                        if (mapped == nullptr) _exit(1);
+
+                        mt19937 random(1000 + iprocess);
+                        uint64_t conflicts = 0;
+                        for (int i = 0; i < operations; i++) {
+                            int irow = random() % rows, icol = random() % columns;
+                            if (random() % 2) {
+                                if (shared::claim(mapped, irow, icol)) shared::storeSeat(mapped, irow, icol, false, "Bench", "");
+                                else conflicts++;
+                            } else {
+                                shared::release(mapped, irow, icol);
+                            }
+                        }
+                        write(fds[1], &conflicts, sizeof(conflicts));
+                        _exit(0);
                     }
                 }
-            } while (status == RETURN);
-
-            return status;
-        }
+                close(fds[1]);
 
-        int showSeatLayout() {
-            templates::PostScreenParams seatLayoutParams;
-
-            seatLayoutParams.titleText = "[Show Seat Layout]";
-            string bodytextInstructions = format::formatText(
-                "[Enter] Return to Main Menu\n", 
-                format::optionsFormat
-            );
+                uint64_t conflicts = 0, processConflicts;
+                while (read(fds[0], &processConflicts, sizeof(processConflicts)) == sizeof(processConflicts)) {
+                    conflicts += processConflicts;
+                }
+                close(fds[0]);
+                while (wait(nullptr) > 0) {}
+                double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+                long long counted = 0;
+                atomic<uint64_t>* words = shared::occupancyWords(header);
+                for (size_t i = 0; i < (size_t) rows * header->wordsPerRow; i++) {
+                    counted += __builtin_popcountll(words[i].load());
+                }
+                int occupied = header->occupiedSeats.load();
 
-            string bodyText;
-            string separator;
+                cout << format::formatText(to_string(count), {format::LEFT, 11})
+                    << format::formatText(to_string((long long) ((double) count * operations / seconds)), {format::LEFT, 14})
+                    << format::formatText(to_string(conflicts), {format::LEFT, 11})
+                    << format::formatText(to_string(occupied), {format::LEFT, 10})
+                    << (occupied == counted ? "yes" : "NO") << endl;
 
-            if ((seatrs::data::totalColumns*2) + 1 <= program::config::lengthHUD) {
-                separator = " ";
-            } else if (seatrs::data::totalColumns + 1 > program::config::lengthHUD) {
-                seatLayoutParams.bodyText = bodytextInstructions;
-                seatLayoutParams.errorMessage = "The columns of the seat layout exceeds the HUD length!";
-                templates::postScreen(seatLayoutParams);
-                return RETURN;
+                shared::unmapSegment(header, name, true);
             }
 
-            bodyText = " ";
+            // a process that dies holding a lock must not block the others
+            bool created = false;
+            string errorMessage;
+            shared::Header* header = shared::mapSegment(name, rows, columns, created, errorMessage);
+            if (header == nullptr) {
+                cerr << errorMessage << endl;
+                return 1;
+            }
+            if (fork() == 0) {
+                shared::lockStripe(header, 0);
+                _exit(0);
+            }
+            wait(nullptr);
+            uint32_t stamp = shared::storeSeat(header, 0, 0, false, "After", "");
+            cout << "Lock of a dead process taken over: " << (stamp == 1 ? "yes" : "NO") << endl;
+            shared::unmapSegment(header, name, true);
 
-            int count = 1;
+            return 0;
+        #else
+            cerr << "Shared seat maps need a Unix-like system." << endl;
+            return 1;
+        #endif
+    }
 
-            for (int icol = 0; icol < seatrs::data::totalColumns; icol++) {
-                bodyText += (
-                    separator.empty() 
-                        ? to_string(count)
-                        : separator + to_string(count)
-                );
-                count++;
-                if (count % 10 == 0) count = 0;
+    /**
+     * Measures the frame time of rendering a large seat grid with 1, 2, 4, ... threads,
+     * with half of the seats reserved at random, and checks that every thread count
+     * renders the same frame.
+     *
+     * @param maxThreads The largest number of threads to try.
+     * @param rows The number of rows of the layout.
+     * @param columns The number of columns of the layout.
+     * @param frames The number of frames to render for each thread count.
+     *
+     * @returns The exit code of the program.
+     */
+    int benchRendering(int maxThreads, int rows, int columns, int frames) {
+        seatrs::setSize(rows, columns);
+        mt19937 random(99);
+        for (int irow = 0; irow < rows; irow++) {
+            for (int icol = 0; icol < columns; icol++) {
+                if (random() % 2) seatrs::reserveSeat(irow, icol, "Bench", "");
             }
-            bodyText += '\n';
+        }
 
-            count = 1;
-            for (int irow = 0; irow < seatrs::data::totalRows; irow++) {
-                bodyText += to_string(count);
-                for (int icol = 0; icol < seatrs::data::totalColumns; icol++) {
-                    bodyText += (separator + (
-                        seatrs::data::seats[irow][icol].isReserved
-                            ? "X"
-                            : "O"
-                    ));
-                }
-                bodyText += '\n';
-                count++;
-                if (count % 10 == 0) count = 0;
-            }
+        cout << "threads  ms/frame  speedup  identical" << endl;
 
-            seatLayoutParams.bodyText = '\n' + format::formatText(bodyText, {format::CENTER}) + "\n\n" + bodytextInstructions;
-            seatLayoutParams.titleText += "\nNot Occupied O | X Occupied";
+        string first;
+        double serialSeconds = 0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            display::components::GridParams params;
+            params.threads = threads;
 
-            templates::postScreen(seatLayoutParams);
+            string frame;
+            auto started = chrono::steady_clock::now();
+            for (int i = 0; i < frames; i++) {
+                frame = display::components::renderSeatGrid(params);
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count() / frames;
+            if (threads == 1) {
+                first = frame;
+                serialSeconds = seconds;
+            }
 
-            return SUCCESS;
+            ostringstream time, speedup;
+            time.setf(ios::fixed);
+            time.precision(2);
+            time << seconds * 1000;
+            speedup.setf(ios::fixed);
+            speedup.precision(2);
+            speedup << serialSeconds / seconds;
+
+            cout << format::formatText(to_string(threads), {format::LEFT, 9})
+                << format::formatText(time.str(), {format::LEFT, 10})
+                << format::formatText(speedup.str(), {format::LEFT, 9})
+                << (frame == first ? "yes" : "NO") << endl;
         }
 
-        int createReservation() {
-            int status;
-
-            string bodyText = format::formatText(
-                "[0] Return to Main Menu\n", 
-                format::optionsFormat
-            );
+        return 0;
+    }
 
-            templates::RowColumnParams rcParams;
-            rcParams.titleText = 
-                "[Create Seat Reservation]\n"
-                "Enter the row and column of the seat.";
-            rcParams.bodyText = bodyText;
-            templates::RowColumn rcResult;
-            
-            templates::NameDescriptionParams ndParams;
-            ndParams.titleText = 
-                "[Create Seat Reservation]\n"
-                "Enter the Name and Description for the reservation.";
-            ndParams.bodyText = bodyText;
-            templates::NameDescription ndResult;
-            
-            templates::PostScreenParams postParams;
-            postParams.bodyText = format::formatText(
-                "[0] Create another Seat Reservation\n"
-                "[Enter] Return to Main Menu\n", 
-                format::optionsFormat
-            );
-            
-            do {
-                postParams.titleText = "[Create Seat Reservation]";
+    /**
+     * Measures what request IDs add to the booking path: reserving and cancelling
+     * seats without IDs, with a new ID each time, and repeating IDs already seen,
+     * which only looks them up. Then times the lookup alone, around an operation that
+     * does nothing, for new and for repeated IDs.
+     *
+     * @param operations The number of operations of each run.
+     *
+     * @returns The exit code of the program.
+     */
+    int benchRequestIds(int operations) {
+        seatrs::setSize(1000, 1000);
 
-                rcResult = templates::getRowColumn(rcParams);
+        vector<string> ids(operations), lookupIds(operations);
+        for (int i = 0; i < operations; i++) {
+            ids[i] = "kiosk-7-" + to_string(1000000000 + i);
+            lookupIds[i] = "kiosk-8-" + to_string(1000000000 + i);
+        }
 
-                if (rcResult.error) {
-                    status = SUCCESS;
-                    break;
-                }
+        cout << "run              ns/op  repeats" << endl;
 
-                int irow = rcResult.row - 1;
-                int icolumn = rcResult.column - 1;
+        for (int run = 0; run < 5; run++) {
+            if (run == 3) {
+                // start the lookups from empty tables, so every lookup ID is still remembered when repeated
+                seatrs::rotateRequests();
+                seatrs::rotateRequests();
+            }
 
-                if (seatrs::isValidSeat(irow, icolumn)) {
-                    if (seatrs::data::seats[irow][icolumn].isReserved) {
-                        postParams.errorMessage = "The seat [" + to_string(irow + 1) + ", " + to_string(icolumn + 1) + "] is already reserved.";
-                        status = templates::postScreen(postParams);
-                        continue;
-                    }
-                } else {
-                    postParams.errorMessage = "The seat [" + to_string(irow + 1) + ", " + to_string(icolumn + 1) + "] does not exist.";
-                    status = templates::postScreen(postParams);
+            uint64_t repeatsBefore = seatrs::data::repeatedRequests;
+            auto started = chrono::steady_clock::now();
+            for (int i = 0; i < operations; i++) {
+                if (run >= 3) {
+                    seatrs::once(lookupIds[i], [] { return seatrs::OK; });
                     continue;
                 }
+                int irow = (i / 2) % 1000, icol = (i / 2000) % 1000;
+                string none;
+                const string& id = (run == 0) ? none : ids[i];
+                if (i % 2 == 0) seatrs::reserveSeat(irow, icol, "Bench", "", id);
+                else seatrs::cancelSeat(irow, icol, id);
+            }
+            double nanos = chrono::duration<double, nano>(chrono::steady_clock::now() - started).count() / operations;
 
-                ndResult = templates::getNameDescription(ndParams);
+            ostringstream time;
+            time.setf(ios::fixed);
+            time.precision(1);
+            time << nanos;
 
-                if (ndResult.error) {
-                    status == RETURN;
-                } else {
-                    seatrs::Seat &seat = seatrs::data::seats[irow][icolumn];
-                    seat.name = ndResult.name;
-                    seat.description = ndResult.description;
-                    seat.isReserved = true;
-
-                    postParams.titleText = 
-                        "[Create Seat Reservation]\n"
-                        "Reservation created successfully.";
-                    postParams.errorMessage.clear();
-                    status = templates::postScreen(postParams);
-                }
+            const char* names[] = {"no IDs", "new IDs", "repeated IDs", "lookup, new", "lookup, repeated"};
+            cout << format::formatText(names[run], {format::LEFT, 17})
+                << format::formatText(time.str(), {format::LEFT, 7})
+                << (seatrs::data::repeatedRequests - repeatsBefore) << endl;
+        }
 
-            } while (status == RETURN);
+        return 0;
+    }
 
-            return status;
+    /**
+     * Reads the parameters of a workload from "key=value" arguments.
+     *
+     * @param arguments The arguments, each one of mix=reserve,cancel,lookup,layout,
+     *                  hotspot=share, hot-rows=n, rate=n, concurrency=n, shards=n,
+     *                  operations=n, rows=n, columns=n, or seed=n.
+     * @param params The parameters to fill in.
+     *
+     * @returns An error message, or an empty string if every argument was understood.
+     */
+    string parseWorkloadParams(const vector<string>& arguments, WorkloadParams& params) {
+        for (const string& argument : arguments) {
+            size_t equals = argument.find('=');
+            string key = argument.substr(0, equals);
+            string value = (equals == string::npos) ? "" : argument.substr(equals + 1);
+
+            try {
+                if (key == "mix") {
+                    istringstream weights(value);
+                    string weight;
+                    for (int i = 0; i < 4; i++) {
+                        if (!getline(weights, weight, ',')) return "The mix needs 4 weights: reserve,cancel,lookup,layout.";
+                        params.weights[i] = max(0, stoi(weight));
+                    }
+                } 
+                else if (key == "hotspot") params.hotspot = stod(value);
+                else if (key == "hot-rows") params.hotRows = max(1, stoi(value));
+                else if (key == "rate") params.arrivalRate = stod(value);
+                else if (key == "concurrency") params.concurrency = max(1, stoi(value));
+                else if (key == "shards") params.shards = max(0, stoi(value));
+                else if (key == "operations") params.operations = max(0, stoi(value));
+                else if (key == "rows") params.rows = max(1, stoi(value));
+                else if (key == "columns") params.columns = max(1, stoi(value));
+                else if (key == "seed") params.seed = (unsigned) stoul(value);
+                else return "Unknown workload setting \"" + key + "\".";
+            } catch (const exception&) {
+                return "Invalid value for \"" + key + "\".";
+            }
         }
 
-        int readReservation() {
-            int status;
+        if (params.weights[RESERVE] + params.weights[CANCEL] + params.weights[LOOKUP] + params.weights[LAYOUT] == 0) {
+            return "The mix needs at least one weight above 0.";
+        }
+        return "";
+    }
+}
 
-            templates::RowColumnParams rcParams;
-            rcParams.titleText = 
-                "[View/Read Seat Reservation]\n"
-                "Enter the row and column of the seat reservation to read.";
-            rcParams.bodyText = format::formatText(
-                "[0] Return to Main Menu\n", 
-                format::optionsFormat
-            );
-            templates::RowColumn rcResult;
+namespace replication {
+    using namespace utils;
+    using namespace display;
 
-            format::FormatParams detailsFormat;
-            detailsFormat.align = format::LEFT;
-            detailsFormat.padding = 2;
-            
-            templates::PostScreenParams postParams;
-            postParams.bodyText = format::formatText(
-                "[0] Read/View another Seat Reservation\n"
-                "[Enter] Return to Main Menu\n", 
-                format::optionsFormat
-            );
-            
-            do {
-                postParams.titleText = "[Read/View Seat Reservation]";
+    /**
+     * Builds the screen a standby shows while it follows the primary.
+     */
+    string buildStandbyScreen(const string& path, bool attached, uint64_t applied, uint64_t batches, int64_t lastLag, int64_t maxLag, double averageLag, const string& errorMessage) {
+        ostringstream body;
+        body.setf(ios::fixed);
+        body.precision(2);
+
+        if (!attached) {
+            body << "Waiting for a primary on \"" << path << "\"...\n";
+        } else {
+            body << "Applied " << applied << " changes in " << batches << " batches\n"
+                << "Lag: last " << (lastLag / 1000.0) << " ms, average " << averageLag / 1000.0
+                << " ms, max " << (maxLag / 1000.0) << " ms\n";
+        }
+        body << "\n[Enter] Promote to primary";
 
-                rcResult = templates::getRowColumn(rcParams);
+        return templates::buildScreen("[Standby]\nFollowing the primary's changes.", errorMessage, format::formatText(body.str(), {format::CENTER}));
+    }
 
-                if (rcResult.error) {
-                    status = SUCCESS;
+    /**
+     * Runs this process as a warm standby: listens on a local socket for a primary,
+     * applies every change it ships, and acknowledges each batch with the sequence
+     * number applied and its lag. The standby is promoted, returning so the caller can
+     * serve operators from the replicated layout, when the primary disconnects or the
+     * operator presses Enter. Enter is refused while the primary is connected and has
+     * been heard from within heartbeatTimeout, so two primaries never run at once
+     * unless the old one is stuck.
+     *
+     * @param path The path of the socket to listen on.
+     *
+     * @returns The exit code of the program if the standby could not start, 0 once promoted.
+     */
+    int runStandby(const string& path) {
+        #ifdef UNIX_LIKE
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(address.sun_path)) {
+                cerr << "The socket path \"" << path << "\" is too long." << endl;
+                return 1;
+            }
+            strcpy(address.sun_path, path.c_str());
+
+            int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+            unlink(path.c_str());
+            if (listenFd < 0 || bind(listenFd, (sockaddr*) &address, sizeof(address)) != 0 || listen(listenFd, 1) != 0) {
+                cerr << "Unable to listen on \"" << path << "\"." << endl;
+                return 1;
+            }
+            signal(SIGPIPE, SIG_IGN);
+
+            int primaryFd = -1, inputFd = STDIN_FILENO;
+            string received, acknowledgement;
+            uint64_t applied = 0, records = 0, batches = 0;
+            int64_t lastLag = 0, maxLag = 0, totalLag = 0;
+            bool promoted = false;
+            string errorMessage;
+            auto lastDrawn = chrono::steady_clock::time_point();
+            auto lastHeard = chrono::steady_clock::time_point();
+            char buffer[65536];
+
+            while (!promoted) {
+                if (chrono::steady_clock::now() - lastDrawn >= chrono::milliseconds(250)) {
+                    screen::render(buildStandbyScreen(path, primaryFd >= 0, applied, batches, lastLag, maxLag, records ? (double) totalLag / records : 0, errorMessage));
+                    lastDrawn = chrono::steady_clock::now();
+                }
+
+                pollfd polls[2] = {{inputFd, POLLIN, 0}, {primaryFd >= 0 ? primaryFd : listenFd, POLLIN, 0}};
+                if (poll(polls, 2, 250) < 0) {
+                    if (errno == EINTR) continue;
                     break;
-                } else {
-                    int irow = rcResult.row - 1;
-                    int icolumn = rcResult.column - 1;
+                }
 
-                    if (seatrs::isValidSeat(irow, icolumn)) {
-                        if (!seatrs::data::seats[irow][icolumn].isReserved) {
-                            postParams.errorMessage = "The seat [" + to_string(irow + 1) + ", " + to_string(icolumn + 1) + "] is not reserved.";
-                            status = templates::postScreen(postParams);
-                            continue;
-                        }
+                if (polls[0].revents & (POLLIN | POLLHUP)) {
+                    // a line from the operator asks to take over, while a closed input is ignored
+                    if (read(inputFd, buffer, sizeof(buffer)) <= 0) {
+                        inputFd = -1;
+                    } else if (primaryFd >= 0 && chrono::steady_clock::now() - lastHeard < heartbeatTimeout) {
+                        errorMessage = "The primary is still running. Stop it first.";
+                        lastDrawn = chrono::steady_clock::time_point();
                     } else {
-                        postParams.errorMessage = "The seat [" + to_string(irow + 1) + ", " + to_string(icolumn + 1) + "] does not exist.";
-                        status = templates::postScreen(postParams);
-                        continue;
+                        promoted = true;
                     }
+                }
 
-                    seatrs::Seat &seat = seatrs::data::seats[irow][icolumn];
-
-                    postParams.bodyText = format::formatText(
-                        (
-                            "\n"
-                            "This seat is reserved by:\n"
-                            " >> Name: " + seat.name + "\n"
-                            " >> Description: " + seat.description
-                        ),
-                        detailsFormat
-                    ) + "\n\n" + postParams.bodyText;
-                    postParams.titleText = 
-                        "[View/Read Seat Reservation]\n"
-                        "Seat Reservation Details:";
-                    postParams.errorMessage.clear();
-                    status = templates::postScreen(postParams);
+                if (!(polls[1].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+                if (primaryFd < 0) {
+                    primaryFd = accept(listenFd, nullptr, nullptr);
+                    lastHeard = chrono::steady_clock::now();
+                    continue;
                 }
-                
 
-            } while (status == RETURN);
+                ssize_t count = read(primaryFd, buffer, sizeof(buffer));
+                if (count <= 0) {
+                    if (count < 0 && errno == EINTR) continue;
+                    // the primary is gone, so this process takes over
+                    promoted = true;
+                    break;
+                }
+                received.append(buffer, count);
+                lastHeard = chrono::steady_clock::now();
+
+                size_t offset = 0;
+                uint64_t sequence = 0;
+                int64_t committedAt = 0;
+                seatrs::Change change;
+                bool appliedAny = false;
+
+                while (decodeChange(received, offset, sequence, committedAt, change)) {
+                    if (sequence == 0) continue;    // a heartbeat
+                    applyChange(change);
+                    int64_t lag = nowMicros() - committedAt;
+                    applied = sequence;
+                    records++;
+                    lastLag = lag;
+                    maxLag = max(maxLag, lag);
+                    totalLag += lag;
+                    appliedAny = true;
+                }
+                received.erase(0, offset);
 
-            return status;
-        }
+                if (appliedAny) {
+                    batches++;
+                    acknowledgement = to_string(applied) + ' ' + to_string(lastLag) + '\n';
+                    send(primaryFd, acknowledgement.data(), acknowledgement.size(), 0);
+                }
+            }
 
-        int updateReservation() {
-            int status;
+            if (primaryFd >= 0) close(primaryFd);
+            close(listenFd);
+            unlink(path.c_str());
+            return 0;
+        #else
+            cerr << "Replication requires a Unix-like system." << endl;
+            return 1;
+        #endif
+    }
 
-            string bodyText = format::formatText(
-                "[0] Return to Main Menu\n", 
-                format::optionsFormat
-            );
+    /**
+     * Carries out the operation of a failover test picked by a random number, the
+     * same way on the primary and when checking the standby.
+     *
+     * @returns Whether the operation changed the layout.
+     */
+    bool testOperation(mt19937& random, int index) {
+        int irow = random() % seatrs::data::totalRows, icol = random() % seatrs::data::totalColumns;
+        string name = "Guest " + to_string(index);
+        switch (random() % 4) {
+            case 0: return seatrs::reserveSeat(irow, icol, name, "failover test") == seatrs::OK;
+            case 1: return seatrs::holdSeat(irow, icol, name, "failover test") == seatrs::OK;
+            case 2: return seatrs::updateSeat(irow, icol, name, "updated") == seatrs::OK;
+            default: return seatrs::cancelSeat(irow, icol) == seatrs::OK;
+        }
+    }
 
-            templates::RowColumnParams rcParams;
-            rcParams.titleText = 
-                "[Update Seat Reservation]\n"
-                "Enter the row and column of the seat.";
-            rcParams.bodyText = bodyText;
-            templates::RowColumn rcResult;
-            
-            templates::NameDescriptionParams ndParams;
-            ndParams.titleText = 
-                "[Update Seat Reservation]\n"
-                "Enter the Name and Description for the reservation.";
-            ndParams.bodyText = bodyText;
-            templates::NameDescription ndResult;
-            
-            templates::PostScreenParams postParams;
-            postParams.bodyText = format::formatText(
-                "[0] Update another Seat Reservation\n"
-                "[Enter] Return to Main Menu\n", 
-                format::optionsFormat
-            );
-            
-            do {
-                postParams.titleText = "[Update Seat Reservation]";
+    /**
+     * Describes every seat, to compare two layouts.
+     */
+    string describeLayout() {
+        string layout;
+        for (int irow = 0; irow < seatrs::data::totalRows; irow++) {
+            for (int icol = 0; icol < seatrs::data::totalColumns; icol++) {
+                const seatrs::Seat& seat = seatrs::data::seats[irow][icol];
+                layout += seat.isReserved ? (seat.isHeld ? 'H' : 'R') : '.';
+                if (seat.isReserved) layout += seat.name + '|' + seat.description + '|';
+            }
+        }
+        return layout;
+    }
 
-                rcResult = templates::getRowColumn(rcParams);
+    /**
+     * Tests failover: a primary in a child process makes random changes and is killed
+     * without warning part way, and this process, its standby, then checks that it
+     * holds every change the primary had acknowledged. The standby must match the
+     * primary as it was after some change at or after the last acknowledged one,
+     * found by replaying the same changes.
+     *
+     * @param operations The number of operations the primary carries out before it is killed.
+     * @param seed The seed of the operations.
+     *
+     * @returns 0 if the standby holds every acknowledged change, 1 otherwise.
+     */
+    int testFailover(int operations, unsigned seed) {
+        #ifdef UNIX_LIKE
+            const int rows = 10, columns = 20;
+            string path = "/tmp/seatrs-failover-" + to_string(getpid()) + ".sock";
+
+            // what the standby has acknowledged, as last seen by the primary
+            void* mapped = mmap(nullptr, sizeof(atomic<uint64_t>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            if (mapped == MAP_FAILED) {
+                cerr << "Unable to map shared memory." << endl;
+                return 1;
+            }
+            atomic<uint64_t>* acknowledged = new (mapped) atomic<uint64_t>(0);
+
+            pid_t child = fork();
+            if (child == 0) {
+                // the primary
+                seatrs::setSize(rows, columns);
+                if (!startPrimary(path).empty()) _exit(2);
+
+                mt19937 random(seed);
+                for (int i = 0; i < operations; i++) {
+                    testOperation(random, i);
+                    if (i % 50 == 0) this_thread::sleep_for(chrono::milliseconds(1));
+                    acknowledged->store(primary.acknowledged);
+                }
+                raise(SIGKILL);
+            }
 
-                if (rcResult.error) {
-                    status = SUCCESS;
-                    break;
+            // the standby: keeps its screen and the operator's input out of the test
+            screen::CountingSink sink;
+            streambuf* console = cout.rdbuf(&sink);
+            int input = dup(STDIN_FILENO);
+            int devNull = open("/dev/null", O_RDONLY);
+            dup2(devNull, STDIN_FILENO);
+            close(devNull);
+
+            int status = runStandby(path);
+
+            dup2(input, STDIN_FILENO);
+            close(input);
+            cout.rdbuf(console);
+            waitpid(child, nullptr, 0);
+
+            uint64_t lastAcknowledged = acknowledged->load();
+            munmap(mapped, sizeof(atomic<uint64_t>));
+            if (status != 0) return status;
+
+            // replays the primary's changes on an empty layout, the first record being its size
+            string standbyLayout = describeLayout();
+            seatrs::setSize(rows, columns);
+            for (int irow = 0; irow < rows; irow++) {
+                for (int icol = 0; icol < columns; icol++) {
+                    if (seatrs::data::seats[irow][icol].isReserved) seatrs::cancelSeat(irow, icol);
                 }
+            }
+            mt19937 random(seed);
+            uint64_t sequence = 1;
+            long long matchedAt = (lastAcknowledged <= 1 && describeLayout() == standbyLayout) ? 1 : -1;
+
+            for (int i = 0; i < operations; i++) {
+                if (!testOperation(random, i)) continue;
+                sequence++;
+                if (matchedAt < 0 && sequence >= lastAcknowledged && describeLayout() == standbyLayout) {
+                    matchedAt = (long long) sequence;
+                }
+            }
 
-                int irow = rcResult.row - 1;
-                int icolumn = rcResult.column - 1;
+            cout << "Primary killed after " << operations << " operations, " << sequence << " changes" << endl;
+            cout << "Acknowledged by the standby before the kill: " << lastAcknowledged << endl;
+            if (matchedAt < 0) {
+                cout << "FAILED: the standby does not match the primary after any acknowledged change." << endl;
+                return 1;
+            }
+            cout << "Standby matches the primary after change " << matchedAt << ": every acknowledged change survived." << endl;
+            return 0;
+        #else
+            cerr << "Replication requires a Unix-like system." << endl;
+            return 1;
+        #endif
+    }
+}
 
-                if (seatrs::isValidSeat(irow, icolumn)) {
-                    if (!seatrs::data::seats[irow][icolumn].isReserved) {
-                        postParams.errorMessage = "The seat [" + to_string(irow + 1) + ", " + to_string(icolumn + 1) + "] is not reserved.";
-                        status = templates::postScreen(postParams);
-                        continue;
-                    }
-                } else {
-                    postParams.errorMessage = "The seat [" + to_string(irow + 1) + ", " + to_string(icolumn + 1) + "] does not exist.";
-                    status = templates::postScreen(postParams);
-                    continue;
-                }
 
-                ndResult = templates::getNameDescription(ndParams);
+int main(int argc, char* argv[]) {
+    seatrs::setSize();
 
-                if (ndResult.error) {
-                    status == RETURN;
-                } else {
-                    seatrs::Seat &seat = seatrs::data::seats[irow][icolumn];
-                    seat.name = ndResult.name;
-                    seat.description = ndResult.description;
-                    seat.isReserved = true;
-
-                    postParams.titleText = 
-                        "[Update Seat Reservation]\n"
-                        "Reservation updated successfully.";
-                    postParams.errorMessage.clear();
-                    status = templates::postScreen(postParams);
-                }
+    vector<string> arguments(argv + 1, argv + argc);
 
-            } while (status == RETURN);
+    if (!arguments.empty() && arguments[0] == "--replication-test") {
+        return replication::testFailover(
+            arguments.size() > 1 ? stoi(arguments[1]) : 5000,
+            arguments.size() > 2 ? stoul(arguments[2]) : 12345
+        );
+    }
 
-            return status;
+    if (arguments.size() >= 2 && arguments[0] == "--standby") {
+        int status = replication::runStandby(arguments[1]);
+        if (status != 0) return status;
+        arguments.erase(arguments.begin(), arguments.begin() + 2);
+    } else if (arguments.size() >= 2 && arguments[0] == "--primary") {
+        string errorMessage = replication::startPrimary(arguments[1]);
+        if (!errorMessage.empty()) {
+            cerr << errorMessage << endl;
+            return 1;
         }
+        arguments.erase(arguments.begin(), arguments.begin() + 2);
+    }
 
-        int deleteReservation() {
-            int status;
+    if (arguments.size() >= 2 && arguments[0] == "--subscribe") {
+        return feed::subscribe(
+            arguments[1],
+            arguments.size() > 2 ? stoull(arguments[2]) : 0,
+            arguments.size() > 3 ? stoull(arguments[3]) : 0
+        );
+    }
 
-            templates::RowColumnParams rcParams;
-            rcParams.titleText = 
-                "[Delete Seat Reservation]\n"
-                "Enter the row and column of the seat reservation to cancel.";
-            rcParams.bodyText = format::formatText(
-                "[0] Return to Main Menu\n", 
-                format::optionsFormat
-            );
-            templates::RowColumn rcResult;
-            
-            templates::PostScreenParams postParams;
-            postParams.bodyText = format::formatText(
-                "[0] Delete another Seat Reservation\n"
-                "[Enter] Return to Main Menu\n", 
-                format::optionsFormat
-            );
-            
-            do {
-                postParams.titleText = "[Update Seat Reservation]";
+    if (arguments.size() >= 2 && arguments[0] == "--feed") {
+        string errorMessage = feed::startFeed(arguments[1]);
+        if (!errorMessage.empty()) {
+            cerr << errorMessage << endl;
+            return 1;
+        }
+        arguments.erase(arguments.begin(), arguments.begin() + 2);
+    }
 
-                rcResult = templates::getRowColumn(rcParams);
+    if (arguments.size() >= 2 && arguments[0] == "--shared") {
+        // the size only matters to the first window, which creates the segment
+        bool sized = arguments.size() >= 4 && isdigit((unsigned char) arguments[2][0]) && isdigit((unsigned char) arguments[3][0]);
+        if (sized) {
+            seatrs::setSize(stoi(arguments[2]), stoi(arguments[3]));
+        }
+        string errorMessage = shared::attach(arguments[1]);
+        if (!errorMessage.empty()) {
+            cerr << errorMessage << endl;
+            return 1;
+        }
+        arguments.erase(arguments.begin(), arguments.begin() + (sized ? 4 : 2));
+    }
 
-                if (!rcResult.error) {
-                    int irow = rcResult.row - 1;
-                    int icolumn = rcResult.column - 1;
+    if (arguments.size() >= 2 && arguments[0] == "--shm-bench") {
+        return workload::benchShared(
+            stoi(arguments[1]),
+            arguments.size() > 2 ? stoi(arguments[2]) : 1000,
+            arguments.size() > 3 ? stoi(arguments[3]) : 1000,
+            arguments.size() > 4 ? stoi(arguments[4]) : 200000
+        );
+    }
 
-                    if (seatrs::isValidSeat(irow, icolumn)) {
-                        if (!seatrs::data::seats[irow][icolumn].isReserved) {
-                            postParams.errorMessage = "The seat [" + to_string(irow + 1) + ", " + to_string(icolumn + 1) + "] is not reserved.";
-                            status = templates::postScreen(postParams);
-                            continue;
-                        }
-                    } else {
-                        postParams.errorMessage = "The seat [" + to_string(irow + 1) + ", " + to_string(icolumn + 1) + "] does not exist.";
-                        status = templates::postScreen(postParams);
-                        continue;
-                    }
-                    
-                    seatrs::Seat &seat = seatrs::data::seats[irow][icolumn];
-                    seat.description.clear();
-                    seat.name.clear();
-                    seat.isReserved = false;
-
-                    postParams.titleText = 
-                        "[Delete Seat Reservation]\n"
-                        "Reservation deleted successfully.";
-                    postParams.errorMessage.clear();
-                    status = templates::postScreen(postParams);
-                }
+    if (!arguments.empty() && arguments[0] == "--workload") {
+        workload::WorkloadParams params;
+        string errorMessage = workload::parseWorkloadParams(vector<string>(arguments.begin() + 1, arguments.end()), params);
+        if (!errorMessage.empty()) {
+            cerr << errorMessage << endl;
+            return 1;
+        }
 
-                status = SUCCESS;
+        workload::WorkloadReport report = workload::runWorkload(params);
+        if (report.error) {
+            cerr << report.errorMessage << endl;
+            return 1;
+        }
+        cout << workload::buildReport(report);
+        return 0;
+    }
 
-            } while (status == RETURN);
+    if (!arguments.empty() && arguments[0] == "--snapshot-bench") {
+        return workload::benchSnapshots(
+            arguments.size() > 1 ? stoi(arguments[1]) : 2,
+            arguments.size() > 2 ? stod(arguments[2]) : 2,
+            arguments.size() > 3 ? stoi(arguments[3]) : 1000,
+            arguments.size() > 4 ? stoi(arguments[4]) : 100
+        );
+    }
 
-            return status;
-        }
+    if (!arguments.empty() && arguments[0] == "--request-bench") {
+        return workload::benchRequestIds(arguments.size() > 1 ? stoi(arguments[1]) : 60000);
+    }
 
-        int mainMenu() {
-            int status;
-            templates::HandleIntInputParams choiceParams;
+    if (arguments.size() >= 2 && arguments[0] == "--render-bench") {
+        return workload::benchRendering(
+            stoi(arguments[1]),
+            arguments.size() > 2 ? stoi(arguments[2]) : 1000,
+            arguments.size() > 3 ? stoi(arguments[3]) : 1000,
+            arguments.size() > 4 ? stoi(arguments[4]) : 50
+        );
+    }
 
-            choiceParams.titleText = 
-                "[Main Menu]\n" 
-                "Choose an option.";
-            
-            choiceParams.bodyText = format::formatText(
-                "[1] Display Seat Layout\n"
-                "[2] Create Seat Reservation\n"
-                "[3] Read/Display Seat Reservation\n"
-                "[4] Update Seat Reservation\n"
-                "[5] Delete/Cancel Seat Reservation\n"
-                "[0] Settings (-> Exit)\n", 
-                format::optionsFormat
-            );
-            choiceParams.minValue = 0;
-            choiceParams.maxValue = 5;
+    if (!arguments.empty() && arguments[0] == "--allocate-bench") {
+        return workload::benchAllocation(
+            arguments.size() > 1 ? stoi(arguments[1]) : 200,
+            arguments.size() > 2 ? stoi(arguments[2]) : 250,
+            arguments.size() > 3 ? stoi(arguments[3]) : 500,
+            arguments.size() > 4 ? stod(arguments[4]) : 0.4
+        );
+    }
 
-            do {
-                templates::HandleIntInput result = templates::handleInput(choiceParams);
+    if (arguments.size() >= 2 && arguments[0] == "--shard-bench") {
+        int values[4] = {1, 1000, 1000, 1000000};
+        for (size_t i = 1; i < arguments.size() && i <= 4; i++) {
+            const string& argument = arguments[i];
+            auto parsed = from_chars(argument.data(), argument.data() + argument.size(), values[i - 1]);
+            if (parsed.ec != errc() || parsed.ptr != argument.data() + argument.size() || values[i - 1] < 1) {
+                cerr << "Usage: main --shard-bench <shards> [rows] [columns] [operations], each a whole number above 0." << endl;
+                return 1;
+            }
+        }
+        return sharding::benchShards(values[0], values[1], values[2], values[3]);
+    }
 
-                switch (result.value) {
-                    case 1: {
-                        status = showSeatLayout();
-                        break;
-                    }
-                    case 2: {
-                        status = createReservation();
-                        break;
-                    }
-                    case 3: {
-                        status = readReservation();
-                        break;
-                    }
-                    case 4: {
-                        status = updateReservation();
-                        break;
-                    }
-                    case 5: {
-                        status = deleteReservation();
-                        break;
-                    }
-                    case 0: {
-                        status = optionsMenu();
-                        break;
-                    }
-                    
-                }
-            } while (status != 0);
-        
-            return 0;
+    if (!arguments.empty() && arguments[0] == "--soak") {
+        return display::screen::soakMemory(arguments.size() > 1 ? stoi(arguments[1]) : 200000);
+    }
+
+    if (arguments.size() >= 2 && arguments[0] == "--replay") {
+        return display::screen::replaySession(arguments[1]);
+    }
+
+    if (arguments.size() >= 2 && arguments[0] == "--record") {
+        if (utils::input::startRecording(arguments[1])) {
+            cerr << "Unable to write the recording \"" << arguments[1] << "\"." << endl;
+            return 1;
         }
+        arguments.erase(arguments.begin(), arguments.begin() + 2);
     }
-}
 
+    int status = 
+        (arguments.size() >= 2 && arguments[0] == "--serve")
+            ? sessions::serve(vector<string>(arguments.begin() + 1, arguments.end()))
+            : display::screen::mainMenu();
 
-int main() {
-    seatrs::setSize();
-    return display::screen::mainMenu();
+    replication::stopPrimary();
+    feed::stopFeed();
+    return status;
 }
\ No newline at end of file